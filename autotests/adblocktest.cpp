@@ -18,6 +18,9 @@
 #include "adblocktest.h"
 #include "adblockrule.h"
 #include "adblocksubscription.h"
+#include "adblocksearchtree.h"
+#include "adblocktokenindex.h"
+#include "adblockrequest.h"
 
 #include <QtTest/QtTest>
 
@@ -109,6 +112,179 @@ void AdBlockTest::parseRegExpFilterTest()
     QCOMPARE(rule_test.parseRegExpFilter(parsedFilter), result);
 }
 
+void AdBlockTest::ruleTokensTest_data()
+{
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<QStringList>("result");
+
+    QTest::newRow("domain") << QSL("||ads.example.com^")
+                            << (QStringList() << QSL("ads") << QSL("example") << QSL("com"));
+    QTest::newRow("endsMatch") << QSL("banner/ad.gif|")
+                               << (QStringList() << QSL("ad") << QSL("gif"));
+    QTest::newRow("wildcard") << QSL("||doubleclick.net/pfadx/*.mtvi")
+                              << (QStringList() << QSL("doubleclick") << QSL("net") << QSL("pfadx"));
+    QTest::newRow("unanchored") << QSL("adbanner/")
+                                << (QStringList());
+    QTest::newRow("lowercase") << QSL("/Ads/Banner.$match-case")
+                               << (QStringList() << QSL("ads") << QSL("banner"));
+    QTest::newRow("exception") << QSL("@@||example.com/ads/$script")
+                               << (QStringList() << QSL("example") << QSL("com") << QSL("ads"));
+    QTest::newRow("regexp") << QSL("/banner\\d+/")
+                            << (QStringList());
+}
+
+void AdBlockTest::ruleTokensTest()
+{
+    QFETCH(QString, filter);
+    QFETCH(QStringList, result);
+
+    AdBlockRule rule(filter);
+    QCOMPARE(AdBlockTokenIndex::ruleTokens(&rule), result);
+}
+
+void AdBlockTest::matchDomainTest_data()
+{
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<QString>("domain");
+    QTest::addColumn<bool>("result");
+
+    QTest::newRow("allowed") << QSL("ads$domain=example.com") << QSL("example.com") << true;
+    QTest::newRow("allowedSubdomain") << QSL("ads$domain=example.com") << QSL("www.example.com") << true;
+    QTest::newRow("allowedOther") << QSL("ads$domain=example.com") << QSL("anotherexample.com") << false;
+    QTest::newRow("allowedParent") << QSL("ads$domain=www.example.com") << QSL("example.com") << false;
+    QTest::newRow("allowedList") << QSL("ads$domain=foo.com|example.com") << QSL("a.b.example.com") << true;
+    QTest::newRow("blocked") << QSL("ads$domain=~example.com") << QSL("www.example.com") << false;
+    QTest::newRow("blockedOther") << QSL("ads$domain=~example.com") << QSL("example.org") << true;
+    QTest::newRow("mixedBlocked") << QSL("ads$domain=example.com|~foo.example.com") << QSL("foo.example.com") << false;
+    QTest::newRow("mixedAllowed") << QSL("ads$domain=example.com|~foo.example.com") << QSL("bar.example.com") << true;
+    QTest::newRow("mixedOther") << QSL("ads$domain=example.com|~foo.example.com") << QSL("example.org") << false;
+    QTest::newRow("css") << QSL("example.com,~foo.example.com##.ad") << QSL("www.example.com") << true;
+    QTest::newRow("unrestricted") << QSL("ads") << QSL("example.com") << true;
+}
+
+void AdBlockTest::matchDomainTest()
+{
+    QFETCH(QString, filter);
+    QFETCH(QString, domain);
+    QFETCH(bool, result);
+
+    AdBlockRule rule(filter);
+    QCOMPARE(rule.matchDomain(domain), result);
+}
+
+void AdBlockTest::registrableDomainTest_data()
+{
+    QTest::addColumn<QUrl>("url");
+    QTest::addColumn<QString>("result");
+
+    QTest::newRow("domain") << QUrl(QSL("https://example.com/")) << QSL("example.com");
+    QTest::newRow("subdomain") << QUrl(QSL("https://a.b.example.com/")) << QSL("example.com");
+    QTest::newRow("multiLabelSuffix") << QUrl(QSL("http://www.example.co.uk/")) << QSL("example.co.uk");
+    QTest::newRow("noHost") << QUrl(QSL("data:text/html,test")) << QString();
+}
+
+void AdBlockTest::registrableDomainTest()
+{
+    QFETCH(QUrl, url);
+    QFETCH(QString, result);
+
+    QCOMPARE(AdBlockRequest::registrableDomain(url), result);
+}
+
+void AdBlockTest::searchTreeTest_data()
+{
+    QTest::addColumn<QUrl>("url");
+    QTest::addColumn<bool>("result");
+
+    QTest::newRow("overlapping") << QUrl(QSL("http://example.com/banners/big.png")) << true;
+    QTest::newRow("overlappingSuffix") << QUrl(QSL("http://example.com/inner/box.png")) << true;
+    QTest::newRow("optionsFailed") << QUrl(QSL("http://example.com/banner.png")) << false;
+    QTest::newRow("caseInsensitive") << QUrl(QSL("http://example.com/TRACKING/pixel.png")) << true;
+    QTest::newRow("matchCase") << QUrl(QSL("http://example.com/Counter.js")) << true;
+    QTest::newRow("matchCaseFailed") << QUrl(QSL("http://example.com/counter.js")) << false;
+    QTest::newRow("startAnchor") << QUrl(QSL("http://ads.example.com/a.png")) << true;
+    QTest::newRow("startAnchorFailed") << QUrl(QSL("https://ads.example.com/a.png")) << false;
+    QTest::newRow("domainAnchor") << QUrl(QSL("http://sub.adserver.com/a.png")) << true;
+    QTest::newRow("domainAnchorFailed") << QUrl(QSL("http://notadserver.com/a.png")) << false;
+    QTest::newRow("endAnchor") << QUrl(QSL("http://example.com/img/spacer.gif")) << true;
+    QTest::newRow("endAnchorFailed") << QUrl(QSL("http://example.com/img/spacer.gif?x")) << false;
+    QTest::newRow("regExp") << QUrl(QSL("http://example.com/ad123/a.png")) << true;
+    QTest::newRow("clean") << QUrl(QSL("http://example.com/index.html")) << false;
+}
+
+void AdBlockTest::searchTreeTest()
+{
+    QFETCH(QUrl, url);
+    QFETCH(bool, result);
+
+    const QStringList filters = {
+        QSL("banner$script"),
+        QSL("banners/big"),
+        QSL("ner/b"),
+        QSL("*tracking*"),
+        QSL("Counter$match-case"),
+        QSL("|http://ads."),
+        QSL("||adserver.com^"),
+        QSL("spacer.gif|"),
+        QSL("/ad[0-9]+/")
+    };
+
+    QVector<AdBlockRule*> rules;
+    for (const QString &filter : filters) {
+        rules.append(new AdBlockRule(filter));
+    }
+
+    AdBlockSearchTree tree;
+    AdBlockTokenIndex index;
+    QVector<const AdBlockRule*> treeRules;
+
+    for (const AdBlockRule* rule : qAsConst(rules)) {
+        if (tree.add(rule)) {
+            treeRules.append(rule);
+        } else {
+            index.add(rule);
+        }
+    }
+
+    tree.build();
+    index.build();
+
+    const AdBlockRequest request(url, QUrl(QSL("http://example.com/")), QWebEngineUrlRequestInfo::ResourceTypeImage);
+    const QString domain = url.host().toLower();
+    // Not lowercased to also exercise case folding of the tree
+    const QString urlString = QString::fromUtf8(url.toEncoded());
+
+    // Compare with matching each rule on its own
+    const AdBlockRule* expected = nullptr;
+    for (const AdBlockRule* rule : qAsConst(rules)) {
+        if (rule->networkMatch(request, domain, urlString)) {
+            expected = rule;
+            break;
+        }
+    }
+
+    bool treeExpected = false;
+    for (const AdBlockRule* rule : qAsConst(treeRules)) {
+        treeExpected |= rule->networkMatch(request, domain, urlString);
+    }
+
+    const AdBlockRule* treeRule = tree.find(request, domain, urlString);
+    QCOMPARE(treeRule != nullptr, treeExpected);
+    if (treeRule) {
+        QVERIFY(treeRules.contains(treeRule));
+        QVERIFY(treeRule->networkMatch(request, domain, urlString));
+    }
+
+    const AdBlockRule* rule = treeRule ? treeRule : index.find(request, domain, urlString);
+    QCOMPARE(rule != nullptr, expected != nullptr);
+    if (rule) {
+        QVERIFY(rule->networkMatch(request, domain, urlString));
+    }
+    QCOMPARE(rule != nullptr, result);
+
+    qDeleteAll(rules);
+}
+
 void AdBlockTest::ignoreEmptyLinesInSubscriptionTest()
 {
     AdBlockSubscription subscription(QSL("test-subscription"));
@@ -121,4 +297,62 @@ void AdBlockTest::ignoreEmptyLinesInSubscriptionTest()
     QCOMPARE(subscription.allRules().at(2)->isComment(), true);
 }
 
+void AdBlockTest::subscriptionCacheTest()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString filePath = tempDir.filePath(QSL("test.txt"));
+    QFile file(filePath);
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write("Title: test\nUrl: test\n[Adblock Plus 2.0]\n"
+               "! comment\n"
+               "||ads.example.com^$third-party\n"
+               "@@||example.com/ads/$script,domain=example.com|~foo.example.com\n"
+               "/banner\\d+/$match-case\n"
+               "||doubleclick.net/pfadx/*.mtvi\n"
+               "example.com##.ad\n");
+    file.close();
+
+    AdBlockSubscription parsed(QSL("test"));
+    parsed.setFilePath(filePath);
+    parsed.loadSubscription({});
+    QVERIFY(QFile::exists(parsed.cacheFilePath()));
+
+    AdBlockSubscription cached(QSL("test"));
+    cached.setFilePath(filePath);
+    cached.loadSubscription({QSL("||doubleclick.net/pfadx/*.mtvi")});
+
+    QCOMPARE(cached.allRules().count(), parsed.allRules().count());
+
+    for (int i = 0; i < parsed.allRules().count(); ++i) {
+        const AdBlockRule* a = parsed.allRules().at(i);
+        const AdBlockRule* b = cached.allRules().at(i);
+        QCOMPARE(b->filter(), a->filter());
+        QCOMPARE(b->subscription(), &cached);
+        QCOMPARE(b->isCssRule(), a->isCssRule());
+        QCOMPARE(b->cssSelector(), a->cssSelector());
+        QCOMPARE(b->isException(), a->isException());
+        QCOMPARE(b->isDomainRestricted(), a->isDomainRestricted());
+        QCOMPARE(b->isComment(), a->isComment());
+        QCOMPARE(b->isSlow(), a->isSlow());
+        QCOMPARE(b->isInternalDisabled(), a->isInternalDisabled());
+        QCOMPARE(b->matchDomain(QSL("example.com")), a->matchDomain(QSL("example.com")));
+        QCOMPARE(b->matchDomain(QSL("foo.example.com")), a->matchDomain(QSL("foo.example.com")));
+    }
+
+    // Disabled rules are applied after loading from cache
+    QCOMPARE(cached.allRules().at(4)->isEnabled(), false);
+    QCOMPARE(parsed.allRules().at(4)->isEnabled(), true);
+
+    // Changed subscription file invalidates the cache
+    QVERIFY(file.open(QFile::Append));
+    file.write("newrule\n");
+    file.close();
+
+    cached.loadSubscription({});
+    QCOMPARE(cached.allRules().count(), parsed.allRules().count() + 1);
+    QCOMPARE(cached.allRules().last()->filter(), QSL("newrule"));
+}
+
 QTEST_GUILESS_MAIN(AdBlockTest)
@@ -29,8 +29,17 @@ private Q_SLOTS:
     void isMatchingCookieTest();
     void parseRegExpFilterTest_data();
     void parseRegExpFilterTest();
+    void ruleTokensTest_data();
+    void ruleTokensTest();
+    void matchDomainTest_data();
+    void matchDomainTest();
+    void registrableDomainTest_data();
+    void registrableDomainTest();
+    void searchTreeTest_data();
+    void searchTreeTest();
 
     void ignoreEmptyLinesInSubscriptionTest();
+    void subscriptionCacheTest();
 };
 
 #endif // ADBLOCKTEST_H
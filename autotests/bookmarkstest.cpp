@@ -0,0 +1,249 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "autotests.h"
+#include "bookmarkstest.h"
+#include "bookmarks.h"
+#include "bookmarkitem.h"
+#include "datapaths.h"
+
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <functional>
+
+// Lookups as they were done before bookmarks were indexed
+static void walkTree(BookmarkItem* parent, const std::function<void(BookmarkItem*)> &func)
+{
+    const auto children = parent->children();
+    for (BookmarkItem* child : children) {
+        if (child->isUrl()) {
+            func(child);
+        }
+        walkTree(child, func);
+    }
+}
+
+static QList<BookmarkItem*> walkSearch(const QString &string, Qt::CaseSensitivity sensitive)
+{
+    QList<BookmarkItem*> items;
+    walkTree(mApp->bookmarks()->rootItem(), [&](BookmarkItem* item) {
+        if (item->title().contains(string, sensitive) ||
+            item->urlString().contains(string, sensitive) ||
+            item->description().contains(string, sensitive) ||
+            item->keyword().compare(string, sensitive) == 0) {
+            items.append(item);
+        }
+    });
+    return items;
+}
+
+static QList<BookmarkItem*> walkUrl(const QUrl &url)
+{
+    QList<BookmarkItem*> items;
+    walkTree(mApp->bookmarks()->rootItem(), [&](BookmarkItem* item) {
+        if (item->url() == url) {
+            items.append(item);
+        }
+    });
+    return items;
+}
+
+static QList<BookmarkItem*> walkKeyword(const QString &keyword)
+{
+    QList<BookmarkItem*> items;
+    walkTree(mApp->bookmarks()->rootItem(), [&](BookmarkItem* item) {
+        if (item->keyword() == keyword) {
+            items.append(item);
+        }
+    });
+    return items;
+}
+
+static QList<BookmarkItem*> sorted(QList<BookmarkItem*> items)
+{
+    std::sort(items.begin(), items.end());
+    return items;
+}
+
+static void compareWithTree()
+{
+    Bookmarks* bookmarks = mApp->bookmarks();
+
+    const QStringList strings = {
+        QString(), QSL("a"), QSL("Ex"), QSL("example"), QSL("EXAMPLE"), QSL("Title"),
+        QSL("title 1"), QSL("desc"), QSL("kw"), QSL("kw1"), QSL("KW2"), QSL("changed"),
+        QSL("http://"), QSL("example.com/5"), QSL("nothing here")
+    };
+    for (const QString &string : strings) {
+        QCOMPARE(sorted(bookmarks->searchBookmarks(string)), sorted(walkSearch(string, Qt::CaseInsensitive)));
+        QCOMPARE(sorted(bookmarks->searchBookmarks(string, -1, Qt::CaseSensitive)), sorted(walkSearch(string, Qt::CaseSensitive)));
+        QCOMPARE(sorted(bookmarks->searchKeyword(string)), sorted(walkKeyword(string)));
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        const QUrl url(QSL("http://example.com/%1").arg(i));
+        QCOMPARE(sorted(bookmarks->searchBookmarks(url)), sorted(walkUrl(url)));
+        QCOMPARE(bookmarks->isBookmarked(url), !walkUrl(url).isEmpty());
+    }
+
+    // Limit returns only matching items
+    const QList<BookmarkItem*> limited = bookmarks->searchBookmarks(QSL("example"), 3);
+    QVERIFY(limited.count() <= 3);
+    for (BookmarkItem* item : limited) {
+        QVERIFY(walkSearch(QSL("example"), Qt::CaseInsensitive).contains(item));
+    }
+}
+
+static BookmarkItem* createBookmark(BookmarkItem* parent, int number)
+{
+    BookmarkItem* item = new BookmarkItem(BookmarkItem::Url);
+    item->setUrl(QUrl(QSL("http://example.com/%1").arg(number % 20)));
+    item->setTitle(QSL("Title %1").arg(number));
+    item->setDescription(QSL("Description %1").arg(number));
+    if (number % 3 == 0) {
+        item->setKeyword(number % 2 ? QSL("kw%1").arg(number % 5) : QSL("KW%1").arg(number % 5));
+    }
+    mApp->bookmarks()->addBookmark(parent, item);
+    return item;
+}
+
+void BookmarksTest::initTestCase()
+{
+}
+
+void BookmarksTest::cleanupTestCase()
+{
+}
+
+void BookmarksTest::indexLookupTest()
+{
+    Bookmarks* bookmarks = mApp->bookmarks();
+
+    BookmarkItem* folder = new BookmarkItem(BookmarkItem::Folder);
+    folder->setTitle(QSL("Index Folder"));
+    bookmarks->addBookmark(bookmarks->unsortedFolder(), folder);
+
+    QList<BookmarkItem*> items;
+    for (int i = 0; i < 60; ++i) {
+        items.append(createBookmark(i % 2 ? folder : bookmarks->toolbarFolder(), i));
+    }
+    compareWithTree();
+
+    items.at(5)->setTitle(QSL("Changed title"));
+    items.at(5)->setUrl(QUrl(QSL("http://example.com/7")));
+    items.at(5)->setKeyword(QSL("kw1"));
+    bookmarks->changeBookmark(items.at(5));
+    items.at(6)->setKeyword(QString());
+    bookmarks->changeBookmark(items.at(6));
+    compareWithTree();
+
+    for (int i = 0; i < 60; i += 4) {
+        QVERIFY(bookmarks->removeBookmark(items.at(i)));
+    }
+    compareWithTree();
+
+    // Removing folder removes all its children
+    QVERIFY(bookmarks->removeBookmark(folder));
+    compareWithTree();
+}
+
+void BookmarksTest::indexCompactTest()
+{
+    Bookmarks* bookmarks = mApp->bookmarks();
+
+    QList<BookmarkItem*> items;
+    for (int i = 0; i < 1200; ++i) {
+        items.append(createBookmark(bookmarks->menuFolder(), i));
+    }
+    compareWithTree();
+
+    // More removed than live entries compacts the index
+    for (int i = 0; i < 1150; ++i) {
+        QVERIFY(bookmarks->removeBookmark(items.at(i)));
+    }
+    compareWithTree();
+
+    items.at(1160)->setTitle(QSL("Changed after compact"));
+    bookmarks->changeBookmark(items.at(1160));
+    createBookmark(bookmarks->menuFolder(), 1300);
+    compareWithTree();
+
+    for (int i = 1150; i < 1200; ++i) {
+        QVERIFY(bookmarks->removeBookmark(items.at(i)));
+    }
+    compareWithTree();
+}
+
+void BookmarksTest::saveChangedSubtreesTest()
+{
+    Bookmarks* bookmarks = mApp->bookmarks();
+    const QString fileName = DataPaths::currentProfilePath() + QSL("/bookmarks.json");
+
+    BookmarkItem* folder1 = new BookmarkItem(BookmarkItem::Folder);
+    folder1->setTitle(QSL("Folder 1"));
+    bookmarks->addBookmark(bookmarks->unsortedFolder(), folder1);
+    BookmarkItem* folder2 = new BookmarkItem(BookmarkItem::Folder);
+    folder2->setTitle(QSL("Folder 2"));
+    bookmarks->addBookmark(bookmarks->unsortedFolder(), folder2);
+    BookmarkItem* item1 = createBookmark(folder1, 1);
+    BookmarkItem* item2 = createBookmark(folder2, 2);
+
+    QMetaObject::invokeMethod(bookmarks, "saveSettings");
+    QVERIFY(!bookmarks->unsortedFolder()->isChanged());
+    QVERIFY(!folder1->isChanged());
+    QVERIFY(!folder2->isChanged());
+    QVERIFY(!item1->isChanged());
+    QVERIFY(!item2->isChanged());
+
+    item1->setTitle(QSL("Saved title"));
+    bookmarks->changeBookmark(item1);
+
+    // Only item and its parents are serialized again
+    QVERIFY(item1->isChanged());
+    QVERIFY(folder1->isChanged());
+    QVERIFY(bookmarks->unsortedFolder()->isChanged());
+    QVERIFY(!folder2->isChanged());
+    QVERIFY(!item2->isChanged());
+    QVERIFY(!bookmarks->toolbarFolder()->isChanged());
+    QVERIFY(!bookmarks->menuFolder()->isChanged());
+
+    QMetaObject::invokeMethod(bookmarks, "saveSettings");
+    QVERIFY(!folder1->isChanged());
+    QVERIFY(!bookmarks->unsortedFolder()->isChanged());
+
+    // Unchanged subtrees are still written
+    auto findChild = [](const QVariantList &list, const QString &name) {
+        for (const QVariant &child : list) {
+            if (child.toMap().value(QSL("name")).toString() == name) {
+                return child.toMap();
+            }
+        }
+        return QVariantMap();
+    };
+    auto unsortedChildren = [&]() {
+        const QVariantMap map = QJsonDocument::fromJson(QzTools::readAllFileByteContents(fileName)).toVariant().toMap();
+        return map.value(QSL("roots")).toMap().value(QSL("other")).toMap().value(QSL("children")).toList();
+    };
+    QTRY_VERIFY(!findChild(findChild(unsortedChildren(), QSL("Folder 1")).value(QSL("children")).toList(), QSL("Saved title")).isEmpty());
+    const QVariantMap saved2 = findChild(findChild(unsortedChildren(), QSL("Folder 2")).value(QSL("children")).toList(), QSL("Title 2"));
+    QCOMPARE(saved2.value(QSL("url")).toString(), item2->urlString());
+    QCOMPARE(saved2.value(QSL("description")).toString(), item2->description());
+    QCOMPARE(saved2.value(QSL("keyword")).toString(), item2->keyword());
+}
+
+FALKONTEST_MAIN(BookmarksTest)
@@ -86,6 +86,11 @@ void CookiesTest::listMatchesDomainTest_data()
     QTest::newRow("test8") << list2 << "c.a.b.x.google.com" << true;
     QTest::newRow("test9") << list2 << ".a.b.x.google.com" << true;
     QTest::newRow("test_empty") << list2 << "" << false;
+    QTest::newRow("test_dot") << (QStringList() << QSL(".example.com")) << "www.example.com" << true;
+    QTest::newRow("test_repeated") << (QStringList() << QSL("b.com")) << "xb.com.b.com" << true;
+    QTest::newRow("test_partial_label") << (QStringList() << QSL("b.com")) << "xb.com" << false;
+    QTest::newRow("test_empty_list") << QStringList() << "example.com" << false;
+    QTest::newRow("test_empty_item") << (QStringList() << QString()) << "example.com" << false;
 }
 
 void CookiesTest::listMatchesDomainTest()
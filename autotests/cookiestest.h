@@ -37,7 +37,7 @@ public:
 
     bool listMatchesDomain(const QStringList &list, const QString &cookieDomain) const
     {
-        return CookieJar::listMatchesDomain(list, cookieDomain);
+        return CookieJar::listMatchesDomain(CookieDomainList(list), cookieDomain);
     }
 };
 
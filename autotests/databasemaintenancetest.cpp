@@ -0,0 +1,147 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "autotests.h"
+#include "databasemaintenancetest.h"
+#include "databasemaintenance.h"
+#include "sqldatabase.h"
+
+#include <QSqlDatabase>
+#include <QTemporaryFile>
+
+static int pragmaValue(const QString &pragma)
+{
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA %1").arg(pragma));
+    return query.next() ? query.value(0).toInt() : -1;
+}
+
+// Creates browsedata-like database with free pages left by deleted rows
+static void setupDatabase(QTemporaryFile *file, bool incrementalVacuum)
+{
+    QVERIFY(file->open());
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"));
+    db.setDatabaseName(file->fileName());
+    QVERIFY(db.open());
+
+    QSqlQuery query(db);
+    if (incrementalVacuum) {
+        query.exec(QSL("PRAGMA auto_vacuum=INCREMENTAL"));
+    }
+    query.exec(QSL("CREATE TABLE history (id INTEGER PRIMARY KEY, url TEXT, date INTEGER)"));
+    query.exec(QSL("CREATE TABLE icons (id INTEGER PRIMARY KEY, url TEXT, data_id INTEGER)"));
+    query.exec(QSL("CREATE TABLE icon_data (id INTEGER PRIMARY KEY, data BLOB)"));
+    query.exec(QSL("CREATE TABLE filler (data BLOB)"));
+
+    db.transaction();
+    query.prepare(QSL("INSERT INTO filler (data) VALUES (zeroblob(4000))"));
+    for (int i = 0; i < 1000; ++i) {
+        query.exec();
+    }
+    db.commit();
+    query.exec(QSL("DELETE FROM filler"));
+
+    SqlDatabase::instance()->setDatabase(db);
+}
+
+static bool waitForFinished(DatabaseMaintenance *maintenance)
+{
+    QSignalSpy spy(maintenance, &DatabaseMaintenance::finished);
+    maintenance->start();
+    return spy.wait(30000);
+}
+
+void DatabaseMaintenanceTest::initTestCase()
+{
+}
+
+void DatabaseMaintenanceTest::cleanupTestCase()
+{
+}
+
+void DatabaseMaintenanceTest::incrementalVacuumSliceTest()
+{
+    QTemporaryFile file;
+    setupDatabase(&file, true);
+
+    QCOMPARE(pragmaValue(QSL("auto_vacuum")), 2);
+    const int freePages = pragmaValue(QSL("freelist_count"));
+    QVERIFY(freePages > 500);
+
+    // Single statement frees only requested number of pages
+    QCOMPARE(DatabaseMaintenance::incrementalVacuum(100), 100);
+    QCOMPARE(pragmaValue(QSL("freelist_count")), freePages - 100);
+
+    QCOMPARE(DatabaseMaintenance::incrementalVacuum(200), 200);
+    QCOMPARE(pragmaValue(QSL("freelist_count")), freePages - 300);
+
+    QCOMPARE(DatabaseMaintenance::incrementalVacuum(100000), freePages - 300);
+    QCOMPARE(pragmaValue(QSL("freelist_count")), 0);
+    QCOMPARE(DatabaseMaintenance::incrementalVacuum(100), 0);
+}
+
+void DatabaseMaintenanceTest::backgroundMaintenanceTest()
+{
+    QTemporaryFile file;
+    setupDatabase(&file, true);
+
+    DatabaseMaintenance maintenance;
+    QSignalSpy spy(&maintenance, &DatabaseMaintenance::finished);
+    QVERIFY(waitForFinished(&maintenance));
+    QVERIFY(spy.at(0).at(0).toLongLong() > 0);
+
+    QVERIFY(!maintenance.isRunning());
+    QVERIFY(!maintenance.needsFullVacuum());
+    QCOMPARE(pragmaValue(QSL("freelist_count")), 0);
+}
+
+void DatabaseMaintenanceTest::fullVacuumNotScheduledTest()
+{
+    QTemporaryFile file;
+    setupDatabase(&file, false);
+
+    const int freePages = pragmaValue(QSL("freelist_count"));
+    QVERIFY(freePages > 500);
+
+    // Background maintenance never blocks writes with full vacuum
+    DatabaseMaintenance maintenance;
+    QVERIFY(!maintenance.isFullVacuumAllowed());
+    QVERIFY(waitForFinished(&maintenance));
+
+    QVERIFY(maintenance.needsFullVacuum());
+    QCOMPARE(pragmaValue(QSL("auto_vacuum")), 0);
+    QCOMPARE(pragmaValue(QSL("freelist_count")), freePages);
+}
+
+void DatabaseMaintenanceTest::fullVacuumOptimizeTest()
+{
+    QTemporaryFile file;
+    setupDatabase(&file, false);
+
+    QVERIFY(pragmaValue(QSL("freelist_count")) > 500);
+
+    DatabaseMaintenance maintenance;
+    maintenance.setFullVacuumAllowed(true);
+    QVERIFY(waitForFinished(&maintenance));
+
+    QVERIFY(!maintenance.needsFullVacuum());
+    QCOMPARE(pragmaValue(QSL("auto_vacuum")), 2);
+    QCOMPARE(pragmaValue(QSL("freelist_count")), 0);
+}
+
+FALKONTEST_MAIN(DatabaseMaintenanceTest)
@@ -0,0 +1,166 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "autotests.h"
+#include "iconprovidertest.h"
+#include "iconprovider.h"
+#include "iconchooser.h"
+#include "sqldatabase.h"
+
+#include <QBuffer>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QSqlDatabase>
+#include <QTemporaryFile>
+
+static QByteArray iconData(const QColor &color)
+{
+    QImage image(16, 16, QImage::Format_ARGB32);
+    image.fill(color);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+
+static QColor iconColor(const QImage &image)
+{
+    return image.isNull() ? QColor() : QColor(image.pixel(0, 0));
+}
+
+// Icons table as created by older versions
+static void createOldDatabase(const QString &fileName, const QVector<QPair<QString, QColor>> &icons)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"), QSL("old"));
+    db.setDatabaseName(fileName);
+    db.open();
+
+    QSqlQuery query(db);
+    query.exec(QSL("CREATE TABLE icons (id INTEGER PRIMARY KEY, url TEXT NOT NULL, icon BLOB)"));
+    query.exec(QSL("CREATE UNIQUE INDEX icons_urluniqueindex ON icons (url)"));
+    query.prepare(QSL("INSERT INTO icons (url, icon) VALUES (?,?)"));
+    for (const auto &icon : icons) {
+        query.addBindValue(icon.first);
+        query.addBindValue(iconData(icon.second));
+        query.exec();
+    }
+
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QSL("old"));
+}
+
+static int searchIcons(const QString &string)
+{
+    IconChooser chooser;
+    chooser.findChild<QLineEdit*>(QSL("siteUrl"))->setText(string);
+    return chooser.findChild<QListWidget*>(QSL("iconList"))->count();
+}
+
+static int count(const QSqlDatabase &db, const QString &sql)
+{
+    QSqlQuery query(db);
+    query.exec(sql);
+    return query.next() ? query.value(0).toInt() : -1;
+}
+
+void IconProviderTest::initTestCase()
+{
+}
+
+void IconProviderTest::cleanupTestCase()
+{
+}
+
+void IconProviderTest::convertDatabaseTest()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    createOldDatabase(file.fileName(), {
+        {QSL("https://www.example.org/page"), Qt::red},
+        {QSL("https://kde.org/"), Qt::blue},
+        {QSL("https://kde.org/other"), Qt::blue}
+    });
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"));
+    db.setDatabaseName(file.fileName());
+    QVERIFY(db.open());
+
+    IconProvider::setupDatabase(db);
+    SqlDatabase::instance()->setDatabase(db);
+    QVERIFY(!IconProvider::isLegacySchema());
+
+    // Space of old table is not reclaimed on load, database without incremental
+    // auto_vacuum asks for full vacuum on quit instead
+    QVERIFY(IconProvider::needsFullVacuum());
+
+    // Same icons are stored only once
+    QCOMPARE(count(db, QSL("SELECT count(*) FROM icons")), 3);
+    QCOMPARE(count(db, QSL("SELECT count(*) FROM icon_data")), 2);
+    QCOMPARE(count(db, QSL("SELECT count(*) FROM icons WHERE host = 'example.org'")), 1);
+
+    QCOMPARE(iconColor(IconProvider::imageForUrl(QUrl(QSL("https://www.example.org/page")), true)), QColor(Qt::red));
+    QCOMPARE(iconColor(IconProvider::imageForUrl(QUrl(QSL("https://kde.org/other")), true)), QColor(Qt::blue));
+    QVERIFY(IconProvider::imageForUrl(QUrl(QSL("https://kde.org/missing")), true).isNull());
+
+    QCOMPARE(iconColor(IconProvider::imageForDomain(QUrl(QSL("https://example.org/")), true)), QColor(Qt::red));
+    QCOMPARE(iconColor(IconProvider::imageForDomain(QUrl(QSL("https://www.kde.org/")), true)), QColor(Qt::blue));
+    QVERIFY(IconProvider::imageForDomain(QUrl(QSL("https://org/")), true).isNull());
+
+    // Search uses host index and returns distinct icons
+    QCOMPARE(searchIcons(QSL("kde.org")), 1);
+    QCOMPARE(searchIcons(QSL("www.example")), 1);
+    QCOMPARE(searchIcons(QSL("https://example.org/page")), 1);
+    QCOMPARE(searchIcons(QSL("nothing")), 0);
+}
+
+void IconProviderTest::legacyDatabaseTest()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    createOldDatabase(file.fileName(), {
+        {QSL("https://www.legacy.test/page"), Qt::green},
+        {QSL("https://other.test/"), Qt::blue}
+    });
+
+    // Read-only database (private mode) can't be converted
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"));
+    db.setDatabaseName(file.fileName());
+    db.setConnectOptions(QSL("QSQLITE_OPEN_READONLY"));
+    QVERIFY(db.open());
+
+    IconProvider::setupDatabase(db);
+    SqlDatabase::instance()->setDatabase(db);
+    QVERIFY(IconProvider::isLegacySchema());
+    QVERIFY(!IconProvider::needsFullVacuum());
+    QVERIFY(!db.tables().contains(QSL("icon_data")));
+
+    QCOMPARE(iconColor(IconProvider::imageForUrl(QUrl(QSL("https://www.legacy.test/page")), true)), QColor(Qt::green));
+    QCOMPARE(iconColor(IconProvider::imageForUrl(QUrl(QSL("https://other.test/")), true)), QColor(Qt::blue));
+    QVERIFY(IconProvider::imageForUrl(QUrl(QSL("https://other.test/missing")), true).isNull());
+
+    QCOMPARE(iconColor(IconProvider::imageForDomain(QUrl(QSL("https://legacy.test/")), true)), QColor(Qt::green));
+    QCOMPARE(iconColor(IconProvider::imageForDomain(QUrl(QSL("https://other.test/")), true)), QColor(Qt::blue));
+    QVERIFY(IconProvider::imageForDomain(QUrl(QSL("https://test/")), true).isNull());
+
+    QCOMPARE(searchIcons(QSL("legacy")), 1);
+    QCOMPARE(searchIcons(QSL(".test")), 2);
+}
+
+FALKONTEST_MAIN(IconProviderTest)
@@ -22,6 +22,10 @@
 #include "bookmarks.h"
 #include "bookmarkitem.h"
 #include "qzsettings.h"
+#include "history.h"
+#include "locationcompletermodel.h"
+
+#include <QSqlQuery>
 
 static void removeBookmarks(BookmarkItem *parent)
 {
@@ -227,4 +231,80 @@ void LocationBarTest::loadAction_kdebug392445()
     QCOMPARE(action.loadRequest.url(), QUrl("http://www.example.com/my%20beautiful%20page"));
 }
 
+static QStringList historyQueryUrls(const QString &searchString)
+{
+    QStringList urls;
+    QSqlQuery query = LocationCompleterModel::createHistoryQuery(searchString, 10);
+    query.exec();
+    while (query.next()) {
+        urls.append(query.value(1).toString());
+    }
+    urls.sort();
+    return urls;
+}
+
+void LocationBarTest::historyQueryTest()
+{
+    if (!History::hasSearchIndex()) {
+        QSKIP("SQLite is built without FTS5");
+    }
+
+    QSignalSpy resetSpy(mApp->history(), &History::resetHistory);
+    mApp->history()->clearHistory();
+    QTRY_COMPARE(resetSpy.count(), 1);
+
+    QSignalSpy addedSpy(mApp->history(), &History::historyEntryAdded);
+    mApp->history()->addHistoryEntry(QUrl(QSL("https://www.example.com/foo")), QSL("Example Domain"));
+    mApp->history()->addHistoryEntry(QUrl(QSL("http://kde.org/applications")), QSL("KDE Community"));
+    QTRY_COMPARE(addedSpy.count(), 2);
+
+    QCOMPARE(historyQueryUrls(QSL("exam")), QStringList{QSL("https://www.example.com/foo")});
+    QCOMPARE(historyQueryUrls(QSL("https://www.exam")), QStringList{QSL("https://www.example.com/foo")});
+    QCOMPARE(historyQueryUrls(QSL("kde comm")), QStringList{QSL("http://kde.org/applications")});
+    QCOMPARE(historyQueryUrls(QSL("doma")), QStringList{QSL("https://www.example.com/foo")});
+    QCOMPARE(historyQueryUrls(QSL("kde.org/app")), QStringList{QSL("http://kde.org/applications")});
+    QCOMPARE(historyQueryUrls(QSL("kde example")), QStringList());
+
+    // Scheme is not indexed
+    QCOMPARE(historyQueryUrls(QSL("http")), QStringList());
+
+    // Title change is reflected in index
+    QSignalSpy editedSpy(mApp->history(), &History::historyEntryEdited);
+    mApp->history()->addHistoryEntry(QUrl(QSL("http://kde.org/applications")), QSL("Applications"));
+    QTRY_COMPARE(editedSpy.count(), 1);
+    QCOMPARE(historyQueryUrls(QSL("comm")), QStringList());
+    QCOMPARE(historyQueryUrls(QSL("appl")), QStringList{QSL("http://kde.org/applications")});
+
+    QSignalSpy deletedSpy(mApp->history(), &History::historyDeletionProgress);
+    mApp->history()->deleteHistoryEntry(QSL("https://www.example.com/foo"));
+    QTRY_COMPARE(deletedSpy.count(), 1);
+    QCOMPARE(historyQueryUrls(QSL("exam")), QStringList());
+
+    resetSpy.clear();
+    mApp->history()->clearHistory();
+    QTRY_COMPARE(resetSpy.count(), 1);
+    QCOMPARE(historyQueryUrls(QSL("kde")), QStringList());
+}
+
+void LocationBarTest::frecencyTest()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 day = 24 * 60 * 60 * 1000;
+
+    const double once = History::addVisitToFrecency(0, now);
+    const double twice = History::addVisitToFrecency(once, now);
+    const double onceOld = History::addVisitToFrecency(0, now - 10 * day);
+    const double twiceOld = History::addVisitToFrecency(History::addVisitToFrecency(0, now - 30 * day), now - 30 * day);
+
+    QVERIFY(twice > once);
+    QVERIFY(once > onceOld);
+    QVERIFY(twice > History::addVisitToFrecency(onceOld, now));
+
+    // Score halves every 30 days
+    QVERIFY(qAbs(twiceOld - once) < 1e-9);
+
+    // Order of visits does not matter
+    QVERIFY(qAbs(History::addVisitToFrecency(onceOld, now) - History::addVisitToFrecency(once, now - 10 * day)) < 1e-9);
+}
+
 FALKONTEST_MAIN(LocationBarTest)
@@ -35,4 +35,7 @@ private Q_SLOTS:
     void loadActionSpecialSchemesTest();
     void loadAction_issue2578();
     void loadAction_kdebug392445();
+
+    void historyQueryTest();
+    void frecencyTest();
 };
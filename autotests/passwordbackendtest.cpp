@@ -210,3 +210,31 @@ void PasswordBackendTest::updateLastUsedTest()
     reloadBackend();
     QCOMPARE(m_backend->getAllEntries().count(), 0);
 }
+
+void PasswordBackendTest::getHostsTest()
+{
+    reloadBackend();
+
+    PasswordEntry entry;
+    entry.host = QSL("org.falkon.google.com");
+    entry.username = QSL("user1");
+    entry.password = QSL("pass1");
+    entry.data = "entry1-data=23&username=user1&password=pass1";
+    m_backend->addEntry(entry);
+
+    entry.username.append(QSL("s"));
+    m_backend->addEntry(entry);
+
+    entry.host = QSL("org.falkon.falkon.com");
+    m_backend->addEntry(entry);
+
+    reloadBackend();
+
+    QStringList hosts = m_backend->getHosts();
+    hosts.sort();
+    QCOMPARE(hosts, QStringList({QSL("org.falkon.falkon.com"), QSL("org.falkon.google.com")}));
+
+    m_backend->removeAll();
+
+    QCOMPARE(m_backend->getHosts(), QStringList());
+}
@@ -37,6 +37,7 @@ private Q_SLOTS:
     void storeTest();
     void removeAllTest();
     void updateLastUsedTest();
+    void getHostsTest();
 
 protected:
     virtual void reloadBackend() = 0;
@@ -0,0 +1,127 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "autotests.h"
+#include "speeddialtest.h"
+#include "speeddial.h"
+#include "pluginproxy.h"
+#include "webpage.h"
+
+#include <QDir>
+#include <QImage>
+#include <QJsonDocument>
+#include <QWebEngineView>
+#include <QCryptographicHash>
+#include <QtWebEngineWidgetsVersion>
+
+static const QString s_url = QSL("https://example.com/dial");
+
+static QString thumbnailHash()
+{
+    return QString::fromLatin1(QCryptographicHash::hash(s_url.toUtf8(), QCryptographicHash::Md4).toHex());
+}
+
+// Image source of test page in speed dial page script
+static QString thumbnailSource()
+{
+    const QString script = mApp->plugins()->speedDial()->initialScript();
+    const QVariantList pages = QJsonDocument::fromJson(script.toUtf8()).toVariant().toList();
+    for (const QVariant &page : pages) {
+        const QVariantMap map = page.toMap();
+        if (map.value(QSL("url")).toString() == s_url) {
+            return map.value(QSL("img")).toString();
+        }
+    }
+    return QString();
+}
+
+// Loads thumbnail in page loaded from baseUrl, returns title set by image handlers
+static QString loadThumbnail(const QUrl &baseUrl, const QString &source)
+{
+    QWebEngineView view;
+    WebPage *page = new WebPage;
+    view.setPage(page);
+
+    QSignalSpy loadSpy(page, &WebPage::loadFinished);
+    page->load(baseUrl);
+    if (!loadSpy.wait() || !loadSpy.at(0).at(0).toBool()) {
+        return QSL("not-loaded");
+    }
+
+    const QString script = QSL("var img = document.createElement('img');"
+                               "img.onload = function() { document.title = 'loaded ' + img.naturalWidth; };"
+                               "img.onerror = function() { document.title = 'error'; };"
+                               "img.src = '%1';"
+                               "document.body.appendChild(img);").arg(source);
+    page->runJavaScript(script);
+
+    QSignalSpy titleSpy(page, &WebPage::titleChanged);
+    while (!page->title().startsWith(QL1S("loaded")) && page->title() != QL1S("error")) {
+        if (!titleSpy.wait()) {
+            break;
+        }
+    }
+    return page->title();
+}
+
+void SpeedDialTest::initTestCase()
+{
+    const QString fileName = mApp->plugins()->speedDial()->thumbnailPath(thumbnailHash());
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QImage image(16, 16, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    QVERIFY(image.save(fileName, "PNG"));
+
+    mApp->plugins()->speedDial()->addPage(QUrl(s_url), QSL("Dial"));
+}
+
+void SpeedDialTest::cleanupTestCase()
+{
+    SpeedDial *speedDial = mApp->plugins()->speedDial();
+    speedDial->removePage(speedDial->pageForUrl(QUrl(s_url)));
+}
+
+void SpeedDialTest::thumbnailUrlTest()
+{
+    const QString source = thumbnailSource();
+
+#if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    // Thumbnail is streamed by scheme handler instead of embedded in page
+    QVERIFY(source.startsWith(QSL("falkon:speeddial-thumbnail?h=%1&v=").arg(thumbnailHash())));
+#else
+    QVERIFY(source.startsWith(QL1S("data:image/png;base64,")));
+#endif
+}
+
+void SpeedDialTest::thumbnailFalkonInitiatorTest()
+{
+#if QTWEBENGINEWIDGETS_VERSION < QT_VERSION_CHECK(5, 11, 0)
+    QSKIP("Request initiator requires QtWebEngine 5.11");
+#endif
+
+    QCOMPARE(loadThumbnail(QUrl(QSL("falkon:about")), thumbnailSource()), QSL("loaded 16"));
+}
+
+void SpeedDialTest::thumbnailWebInitiatorTest()
+{
+    // Web page must not be able to find out what is in speed dial
+    const QString source = QSL("falkon:speeddial-thumbnail?h=%1").arg(thumbnailHash());
+    QCOMPARE(loadThumbnail(QUrl(QSL("qrc:autotests/data/basic_page.html")), source), QSL("error"));
+}
+
+FALKONTEST_MAIN(SpeedDialTest)
@@ -17,11 +17,19 @@
 * ============================================================ */
 #include "sqldatabasetest.h"
 #include "sqldatabase.h"
+#include "historywriter.h"
 
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 #include <QSqlDatabase>
 #include <QTemporaryFile>
+#include <QSet>
+#include <QThread>
+#include <QMutex>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+Q_DECLARE_METATYPE(HistoryEntry)
 
 void SqlDatabaseTest::initTestCase()
 {
@@ -87,4 +95,196 @@ void SqlDatabaseTest::sqlQueryJobTest()
     QVERIFY(job->error().isValid());
 }
 
+void SqlDatabaseTest::readWriteThreadsTest()
+{
+    QTemporaryFile file;
+    file.open();
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"));
+    db.setDatabaseName(file.fileName());
+    db.open();
+
+    SqlDatabase *database = SqlDatabase::instance();
+    database->setDatabase(db);
+
+    database->runWrite([=]() {
+        QSqlQuery createQuery(database->database());
+        createQuery.exec(QSL("CREATE TABLE test2 (id INTEGER PRIMARY KEY, value INTEGER)"));
+    });
+
+    // Writes run in order on one thread other than main thread
+    QMutex mutex;
+    QVector<int> writeOrder;
+    QSet<QThread*> writeThreads;
+
+    for (int i = 0; i < 20; ++i) {
+        database->runWrite([&, i]() {
+            QSqlQuery insertQuery = database->preparedQuery(QSL("INSERT INTO test2 (value) VALUES (?)"));
+            insertQuery.addBindValue(i);
+            insertQuery.exec();
+
+            QMutexLocker locker(&mutex);
+            writeOrder.append(i);
+            writeThreads.insert(QThread::currentThread());
+        });
+    }
+
+    database->waitForDone();
+
+    QVector<int> expectedOrder;
+    for (int i = 0; i < 20; ++i) {
+        expectedOrder.append(i);
+    }
+    QCOMPARE(writeOrder, expectedOrder);
+    QCOMPARE(writeThreads.count(), 1);
+    QVERIFY(!writeThreads.contains(QThread::currentThread()));
+
+    QSqlQuery query(QSL("SELECT value FROM test2 ORDER BY id"), db);
+    QVector<int> values;
+    while (query.next()) {
+        values.append(query.value(0).toInt());
+    }
+    QCOMPARE(values, expectedOrder);
+    query.finish();
+
+    // Reads see committed writes on their own connections
+    QAtomicInt readCount;
+    QSet<QString> readConnections;
+
+    for (int i = 0; i < 4; ++i) {
+        database->runRead([&]() {
+            QSqlQuery countQuery = database->preparedQuery(QSL("SELECT COUNT(*) FROM test2"));
+            countQuery.exec();
+            countQuery.next();
+            readCount.fetchAndAddOrdered(countQuery.value(0).toInt());
+            countQuery.finish();
+
+            QMutexLocker locker(&mutex);
+            readConnections.insert(database->database().connectionName());
+        });
+    }
+
+    database->waitForDone();
+
+    QCOMPARE(readCount.load(), 4 * 20);
+    QVERIFY(!readConnections.isEmpty());
+    QVERIFY(readConnections.count() <= 2);
+    QVERIFY(!readConnections.contains(db.connectionName()));
+
+    // Reads run concurrently with each other
+    QSemaphore first;
+    QSemaphore second;
+    QAtomicInt concurrentReads;
+
+    database->runRead([&]() {
+        first.release();
+        if (second.tryAcquire(1, 5000)) {
+            concurrentReads.ref();
+        }
+    });
+    database->runRead([&]() {
+        second.release();
+        if (first.tryAcquire(1, 5000)) {
+            concurrentReads.ref();
+        }
+    });
+
+    database->waitForDone();
+    QCOMPARE(concurrentReads.load(), 2);
+
+    // Writes are not blocked by running reads
+    QSemaphore written;
+    QAtomicInt readUnblocked;
+
+    QFuture<void> read = database->runRead([&]() {
+        if (written.tryAcquire(1, 5000)) {
+            readUnblocked.ref();
+        }
+    });
+    QFuture<void> write = database->runWrite([&]() {
+        QSqlQuery insertQuery = database->preparedQuery(QSL("INSERT INTO test2 (value) VALUES (?)"));
+        insertQuery.addBindValue(20);
+        insertQuery.exec();
+        written.release();
+    });
+
+    database->waitForDone();
+
+    QVERIFY(read.isFinished());
+    QVERIFY(write.isFinished());
+    QCOMPARE(readUnblocked.load(), 1);
+
+    QVERIFY(query.exec(QSL("SELECT COUNT(*) FROM test2")));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 21);
+}
+
+void SqlDatabaseTest::historyWriterTest()
+{
+    QTemporaryFile file;
+    file.open();
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"));
+    db.setDatabaseName(file.fileName());
+    db.open();
+
+    QSqlQuery query(db);
+    QVERIFY(query.exec(QSL("CREATE TABLE history (id INTEGER PRIMARY KEY, url TEXT NOT NULL, title TEXT, "
+                           "date INTEGER DEFAULT 0 NOT NULL, count INTEGER DEFAULT 0 NOT NULL)")));
+    QVERIFY(query.exec(QSL("CREATE UNIQUE INDEX history_urluniqueindex ON history (url)")));
+
+    qRegisterMetaType<HistoryEntry>();
+
+    HistoryWriter writer;
+    QSignalSpy addedSpy(&writer, &HistoryWriter::entryAdded);
+    QSignalSpy editedSpy(&writer, &HistoryWriter::entryEdited);
+
+    // Repeated visits are coalesced
+    writer.addVisit(QUrl(QSL("https://example.com")), QSL("Example"), 1000);
+    writer.addVisit(QUrl(QSL("https://kde.org")), QSL("KDE"), 2000);
+    writer.addVisit(QUrl(QSL("https://example.com")), QSL("Example Domain"), 3000);
+    writer.flush();
+
+    QCOMPARE(addedSpy.count(), 2);
+    QCOMPARE(editedSpy.count(), 0);
+
+    HistoryEntry entry = addedSpy.at(0).at(0).value<HistoryEntry>();
+    QCOMPARE(entry.url, QUrl(QSL("https://example.com")));
+    QCOMPARE(entry.title, QSL("Example Domain"));
+    QCOMPARE(entry.count, 2);
+    QCOMPARE(entry.date.toMSecsSinceEpoch(), qint64(3000));
+
+    QVERIFY(query.exec(QSL("SELECT id, count, date, title FROM history WHERE url='https://example.com'")));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), entry.id);
+    QCOMPARE(query.value(1).toInt(), 2);
+    QCOMPARE(query.value(2).toLongLong(), qint64(3000));
+    QCOMPARE(query.value(3).toString(), QSL("Example Domain"));
+    query.finish();
+
+    writer.addVisit(QUrl(QSL("https://kde.org")), QSL("KDE Community"), 4000);
+    writer.flush();
+
+    QCOMPARE(addedSpy.count(), 2);
+    QCOMPARE(editedSpy.count(), 1);
+
+    const HistoryEntry before = editedSpy.at(0).at(0).value<HistoryEntry>();
+    const HistoryEntry after = editedSpy.at(0).at(1).value<HistoryEntry>();
+    QCOMPARE(before.id, after.id);
+    QCOMPARE(before.title, QSL("KDE"));
+    QCOMPARE(before.count, 1);
+    QCOMPARE(after.title, QSL("KDE Community"));
+    QCOMPARE(after.count, 2);
+
+    // Cleared visits are never written
+    writer.addVisit(QUrl(QSL("https://sample.com")), QSL("Sample"), 5000);
+    writer.clear();
+    writer.flush();
+
+    QCOMPARE(addedSpy.count(), 2);
+    QVERIFY(query.exec(QSL("SELECT COUNT(*) FROM history")));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 2);
+}
+
 QTEST_GUILESS_MAIN(SqlDatabaseTest)
@@ -28,4 +28,6 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void sqlQueryJobTest();
+    void readWriteThreadsTest();
+    void historyWriterTest();
 };
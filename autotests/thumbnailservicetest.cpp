@@ -0,0 +1,140 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "autotests.h"
+#include "thumbnailservicetest.h"
+#include "thumbnailservice.h"
+
+#include <QImage>
+#include <QTemporaryDir>
+
+static QUrl pageUrl(int number)
+{
+    return QUrl(QSL("qrc:autotests/data/basic_page.html?%1").arg(number));
+}
+
+// Waits until count thumbnails were created and returns their urls in order
+static QList<QUrl> waitForThumbnails(QSignalSpy &spy, int count)
+{
+    while (spy.count() < count) {
+        if (!spy.wait(10000)) {
+            break;
+        }
+    }
+
+    QList<QUrl> urls;
+    for (const QList<QVariant> &arguments : qAsConst(spy)) {
+        urls.append(arguments.at(0).toUrl());
+    }
+    return urls;
+}
+
+void ThumbnailServiceTest::initTestCase()
+{
+}
+
+void ThumbnailServiceTest::cleanupTestCase()
+{
+}
+
+void ThumbnailServiceTest::queueOrderTest()
+{
+    QTemporaryDir dir;
+    ThumbnailService service;
+    service.setMaximumViews(1);
+    QSignalSpy spy(&service, &ThumbnailService::thumbnailCreated);
+
+    for (int i = 1; i <= 3; ++i) {
+        service.requestThumbnail(pageUrl(i), dir.filePath(QString::number(i)));
+    }
+
+    const QList<QUrl> expected = {pageUrl(1), pageUrl(2), pageUrl(3)};
+    QCOMPARE(waitForThumbnails(spy, 3), expected);
+
+    for (const QList<QVariant> &arguments : qAsConst(spy)) {
+        QVERIFY(arguments.at(1).toBool());
+    }
+    QVERIFY(QFile::exists(dir.filePath(QSL("1"))));
+    QVERIFY(!QImage(dir.filePath(QSL("1"))).isNull());
+}
+
+void ThumbnailServiceTest::highPriorityTest()
+{
+    QTemporaryDir dir;
+    ThumbnailService service;
+    service.setMaximumViews(1);
+    QSignalSpy spy(&service, &ThumbnailService::thumbnailCreated);
+
+    // Visible dials are requested with high priority and go first
+    service.requestThumbnail(pageUrl(1), dir.filePath(QSL("1")));
+    service.requestThumbnail(pageUrl(2), dir.filePath(QSL("2")));
+    service.requestThumbnail(pageUrl(3), dir.filePath(QSL("3")), ThumbnailService::HighPriority);
+
+    const QList<QUrl> expected = {pageUrl(1), pageUrl(3), pageUrl(2)};
+    QCOMPARE(waitForThumbnails(spy, 3), expected);
+}
+
+void ThumbnailServiceTest::poolLimitTest()
+{
+    QTemporaryDir dir;
+    ThumbnailService service;
+    service.setMaximumViews(2);
+    QSignalSpy spy(&service, &ThumbnailService::thumbnailCreated);
+
+    int maxViews = 0;
+    connect(&service, &ThumbnailService::thumbnailCreated, this, [&]() {
+        maxViews = qMax(maxViews, service.viewsCount());
+    });
+
+    for (int i = 1; i <= 5; ++i) {
+        service.requestThumbnail(pageUrl(i), dir.filePath(QString::number(i)));
+        maxViews = qMax(maxViews, service.viewsCount());
+    }
+
+    QCOMPARE(service.viewsCount(), 2);
+    QCOMPARE(waitForThumbnails(spy, 5).count(), 5);
+    QVERIFY(maxViews <= 2);
+}
+
+void ThumbnailServiceTest::dedupTest()
+{
+    QTemporaryDir dir;
+    ThumbnailService service;
+    service.setMaximumViews(1);
+    QSignalSpy spy(&service, &ThumbnailService::thumbnailCreated);
+
+    // 1 is running, 2 and 3 are queued
+    service.requestThumbnail(pageUrl(1), dir.filePath(QSL("1")));
+    service.requestThumbnail(pageUrl(2), dir.filePath(QSL("2")));
+    service.requestThumbnail(pageUrl(3), dir.filePath(QSL("3")));
+
+    service.requestThumbnail(pageUrl(1), dir.filePath(QSL("1")), ThumbnailService::HighPriority);
+    // Repeated request raises the priority
+    service.requestThumbnail(pageUrl(3), dir.filePath(QSL("3")), ThumbnailService::HighPriority);
+    // But never lowers it
+    service.requestThumbnail(pageUrl(3), dir.filePath(QSL("3")));
+    service.requestThumbnail(pageUrl(2), dir.filePath(QSL("2")));
+
+    const QList<QUrl> expected = {pageUrl(1), pageUrl(3), pageUrl(2)};
+    QCOMPARE(waitForThumbnails(spy, 3), expected);
+
+    // No more thumbnails are created for merged requests
+    QTest::qWait(1000);
+    QCOMPARE(spy.count(), 3);
+}
+
+FALKONTEST_MAIN(ThumbnailServiceTest)
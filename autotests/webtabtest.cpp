@@ -22,6 +22,13 @@
 #include "tabbedwebview.h"
 #include "mainapplication.h"
 #include "browserwindow.h"
+#include "restoremanager.h"
+#include "sessionjournal.h"
+#include "tabdiscardmanager.h"
+#include "webpage.h"
+#include "settings.h"
+#include "datapaths.h"
+#include "qztools.h"
 
 #include <QWebEngineHistory>
 
@@ -289,4 +296,190 @@ void WebTabTest::saveNotRestoredTabTest()
     QCOMPARE(saved.url, QUrl("qrc:autotests/data/basic_page.html"));
 }
 
+void WebTabTest::savedTabIconTest()
+{
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::red);
+
+    WebTab::SavedTab tab;
+    tab.url = QUrl(QSL("http://example.com/"));
+    tab.icon = QIcon(pixmap);
+
+    // Icon is only serialized when it is not in icon database
+    auto roundTrip = [](const WebTab::SavedTab &tab) {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << tab;
+        QDataStream in(data);
+        WebTab::SavedTab result;
+        in >> result;
+        return result;
+    };
+
+    tab.iconInDatabase = false;
+    WebTab::SavedTab result = roundTrip(tab);
+    QVERIFY(!result.icon.isNull());
+    QVERIFY(!result.iconInDatabase);
+    QCOMPARE(result.url, tab.url);
+
+    tab.iconInDatabase = true;
+    result = roundTrip(tab);
+    QVERIFY(result.icon.isNull());
+    QVERIFY(result.iconInDatabase);
+    QCOMPARE(result.url, tab.url);
+}
+
+void WebTabTest::placeholderTabTest()
+{
+    const QUrl page1(QSL("qrc:autotests/data/basic_page.html"));
+    const QUrl page2(QSL("qrc:autotests/data/basic_page2.html"));
+
+    BrowserWindow *w = mApp->createWindow(Qz::BW_NewWindow);
+    QTRY_COMPARE(w->tabWidget()->count(), 1);
+
+    QVector<WebTab::SavedTab> tabs;
+    for (const QUrl &url : {page1, page2, page1}) {
+        WebTab::SavedTab tab;
+        tab.url = url;
+        tab.title = url.fileName();
+        tabs.append(tab);
+    }
+    QVERIFY(w->tabWidget()->restoreState(tabs, 1));
+    QCOMPARE(w->tabWidget()->count(), 4);
+
+    // Only current tab gets its view
+    QVERIFY(w->tabWidget()->webTab(1)->hasWebView());
+    QVERIFY(!w->tabWidget()->webTab(2)->hasWebView());
+    QVERIFY(!w->tabWidget()->webTab(3)->hasWebView());
+
+    WebTab *tab = w->tabWidget()->webTab(2);
+    QCOMPARE(tab->url(), page2);
+    QCOMPARE(tab->title(), page2.fileName());
+    QVERIFY(!tab->isRestored());
+    QVERIFY(!tab->hasWebView());
+
+    tab->makeCurrentTab();
+    QVERIFY(tab->hasWebView());
+    QTRY_VERIFY(tab->isRestored());
+    QTRY_COMPARE(tab->url(), page2);
+
+    // Unloaded background tab is placeholder again
+    w->tabWidget()->webTab(1)->makeCurrentTab();
+    tab->unload();
+    QVERIFY(!tab->isRestored());
+    QVERIFY(!tab->hasWebView());
+    QCOMPARE(tab->url(), page2);
+
+    delete w;
+}
+
+void WebTabTest::tabDiscardTest()
+{
+    const QByteArray meminfo("MemTotal:       16300000 kB\n"
+                             "MemFree:         1000000 kB\n"
+                             "MemAvailable:    8000000 kB\n");
+    QCOMPARE(TabDiscardManager::parseMemInfo(meminfo, "MemTotal"), qint64(16300000) * 1024);
+    QCOMPARE(TabDiscardManager::parseMemInfo(meminfo, "MemAvailable"), qint64(8000000) * 1024);
+    QCOMPARE(TabDiscardManager::parseMemInfo(meminfo, "SwapTotal"), qint64(-1));
+
+    Settings settings;
+    settings.setValue(QSL("TabDiscarding/Enabled"), false);
+    settings.setValue(QSL("TabDiscarding/MinInactiveMinutes"), 0);
+    TabDiscardManager manager;
+
+    BrowserWindow *w = mApp->createWindow(Qz::BW_NewWindow);
+    w->tabWidget()->addView(QUrl(QSL("qrc:autotests/data/basic_page.html")), Qz::NT_NotSelectedTab);
+    w->tabWidget()->addView(QUrl(QSL("qrc:autotests/data/basic_page2.html")), Qz::NT_NotSelectedTab);
+    w->tabWidget()->addView(QUrl(QSL("qrc:autotests/data/basic_page.html")), Qz::NT_NotSelectedTab, false, /*pinned*/ true);
+    QTRY_COMPARE(w->tabWidget()->count(), 4);
+
+    WebTab *current = w->tabWidget()->webTab();
+    WebTab *tab1 = w->tabWidget()->webTab(w->tabWidget()->count() - 2);
+    WebTab *tab2 = w->tabWidget()->webTab(w->tabWidget()->count() - 1);
+    QVERIFY(tab1 != current && tab2 != current);
+
+    // Visiting a tab makes it least likely to be discarded
+    QTest::qWait(10);
+    tab1->makeCurrentTab();
+    QTest::qWait(10);
+    current->makeCurrentTab();
+    QCOMPARE(manager.discardableTabs(), (QVector<WebTab*>{tab2, tab1}));
+
+    QCOMPARE(manager.discardTabs(1), 1);
+    QVERIFY(!tab2->hasWebView());
+    QVERIFY(!tab2->isRestored());
+    QVERIFY(tab1->hasWebView());
+    QCOMPARE(manager.stats().discardedTabs, 1);
+
+    // Tabs with edited forms are never discarded
+    tab1->webView()->page()->setFormModified(true);
+    QCOMPARE(manager.discardableTabs(), QVector<WebTab*>{});
+    QCOMPARE(manager.discardTabs(1), 0);
+
+    // Disabled by default, and always disabled where memory can't be measured
+    settings.remove(QSL("TabDiscarding"));
+    QVERIFY(!TabDiscardManager().isEnabled());
+    QCOMPARE(TabDiscardManager::isSupported(), QFile::exists(QSL("/proc/self/statm")));
+    settings.setValue(QSL("TabDiscarding/Enabled"), true);
+    QCOMPARE(TabDiscardManager().isEnabled(), TabDiscardManager::isSupported());
+
+    settings.remove(QSL("TabDiscarding"));
+    delete w;
+}
+
+void WebTabTest::sessionJournalTest()
+{
+    const QUrl page1(QSL("qrc:autotests/data/basic_page.html"));
+    const QUrl page2(QSL("qrc:autotests/data/basic_page2.html"));
+    const QString filePath = DataPaths::currentProfilePath() + QSL("/journal-test.dat");
+
+    BrowserWindow *w = mApp->createWindow(Qz::BW_NewWindow);
+    w->tabWidget()->addView(page1);
+    QTRY_COMPARE(w->tabWidget()->count(), 2);
+
+    WebTab *tab = w->tabWidget()->webTab(1);
+    QTRY_COMPARE(tab->url(), page1);
+
+    SessionJournal journal;
+    journal.save(filePath);
+    journal.waitForFinished();
+
+    QVERIFY(QFile::exists(filePath));
+    QVERIFY(QFile::exists(SessionJournal::journalPath(filePath)));
+    const QByteArray snapshot = QzTools::readAllFileByteContents(filePath);
+
+    RestoreData data;
+    RestoreManager::createFromFile(filePath, data);
+    QCOMPARE(data.windows.count(), mApp->windowCount());
+    QCOMPARE(data.windows.first().tabs.last().url, page1);
+
+    tab->load(page2);
+    QTRY_COMPARE(tab->url(), page2);
+    journal.save(filePath);
+
+    // Change is only appended to journal
+    QCOMPARE(QzTools::readAllFileByteContents(filePath), snapshot);
+
+    data.clear();
+    RestoreManager::createFromFile(filePath, data);
+    QCOMPARE(data.windows.count(), mApp->windowCount());
+    QCOMPARE(data.windows.first().tabs.last().url, page2);
+
+    // Journal is ignored once session file is replaced
+    QFile file(filePath);
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(snapshot + QByteArray(1, 0));
+    file.close();
+
+    data.clear();
+    RestoreManager::createFromFile(filePath, data);
+    QCOMPARE(data.windows.first().tabs.last().url, page1);
+
+    journal.discard(filePath);
+    QVERIFY(!QFile::exists(SessionJournal::journalPath(filePath)));
+
+    QFile::remove(filePath);
+    delete w;
+}
+
 FALKONTEST_MAIN(WebTabTest)
@@ -33,4 +33,8 @@ private Q_SLOTS:
     void moveTabTest();
     void loadNotRestoredTabTest();
     void saveNotRestoredTabTest();
+    void savedTabIconTest();
+    void placeholderTabTest();
+    void tabDiscardTest();
+    void sessionJournalTest();
 };
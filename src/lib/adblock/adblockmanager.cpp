@@ -18,6 +18,7 @@
 #include "adblockmanager.h"
 #include "adblockdialog.h"
 #include "adblockmatcher.h"
+#include "adblockrequest.h"
 #include "adblocksubscription.h"
 #include "adblockurlinterceptor.h"
 #include "datapaths.h"
@@ -35,7 +36,6 @@
 #include <QTimer>
 #include <QMessageBox>
 #include <QUrlQuery>
-#include <QMutexLocker>
 #include <QSaveFile>
 
 //#define ADBLOCK_DEBUG
@@ -85,8 +85,6 @@ void AdBlockManager::setEnabled(bool enabled)
     load();
     mApp->reloadUserStyleSheet();
 
-    QMutexLocker locker(&m_mutex);
-
     if (m_enabled) {
         m_matcher->update();
     } else {
@@ -101,8 +99,6 @@ QList<AdBlockSubscription*> AdBlockManager::subscriptions() const
 
 bool AdBlockManager::block(QWebEngineUrlRequestInfo &request, QString &ruleFilter, QString &ruleSubscription)
 {
-    QMutexLocker locker(&m_mutex);
-
     if (!isEnabled()) {
         return false;
     }
@@ -119,21 +115,16 @@ bool AdBlockManager::block(QWebEngineUrlRequestInfo &request, QString &ruleFilte
         return false;
     }
 
-    const AdBlockRule* blockedRule = m_matcher->match(request, urlDomain, urlString);
+    const bool blocked = m_matcher->match(AdBlockRequest(request), urlDomain, urlString, ruleFilter, ruleSubscription);
 
-    if (blockedRule) {
-        ruleFilter = blockedRule->filter();
-        ruleSubscription = blockedRule->subscription()->title();
 #ifdef ADBLOCK_DEBUG
-        qDebug() << "BLOCKED: " << timer.elapsed() << blockedRule->filter() << request.requestUrl();
-#endif
+    if (blocked) {
+        qDebug() << "BLOCKED: " << timer.elapsed() << ruleFilter << request.requestUrl();
     }
-
-#ifdef ADBLOCK_DEBUG
     qDebug() << timer.elapsed() << request.requestUrl();
 #endif
 
-    return blockedRule;
+    return blocked;
 }
 
 QVector<AdBlockedRequest> AdBlockManager::blockedRequestsForUrl(const QUrl &url) const
@@ -225,13 +216,12 @@ AdBlockSubscription* AdBlockManager::addSubscription(const QString &title, const
 
 bool AdBlockManager::removeSubscription(AdBlockSubscription* subscription)
 {
-    QMutexLocker locker(&m_mutex);
-
     if (!m_subscriptions.contains(subscription) || !subscription->canBeRemoved()) {
         return false;
     }
 
     QFile(subscription->filePath()).remove();
+    QFile(subscription->cacheFilePath()).remove();
     m_subscriptions.removeOne(subscription);
 
     m_matcher->update();
@@ -255,8 +245,6 @@ AdBlockCustomList* AdBlockManager::customList() const
 
 void AdBlockManager::load()
 {
-    QMutexLocker locker(&m_mutex);
-
     if (m_loaded) {
         return;
     }
@@ -358,11 +346,7 @@ void AdBlockManager::load()
 
 void AdBlockManager::updateMatcher()
 {
-    QMutexLocker locker(&m_mutex);
-
-    mApp->networkManager()->removeUrlInterceptor(m_interceptor);
     m_matcher->update();
-    mApp->networkManager()->installUrlInterceptor(m_interceptor);
 }
 
 void AdBlockManager::updateAllSubscriptions()
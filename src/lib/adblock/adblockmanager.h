@@ -21,7 +21,6 @@
 #include <QObject>
 #include <QStringList>
 #include <QPointer>
-#include <QMutex>
 #include <QUrl>
 #include <QWebEngineUrlRequestInfo>
 
@@ -110,7 +109,6 @@ private:
 
     AdBlockUrlInterceptor *m_interceptor;
     QPointer<AdBlockDialog> m_adBlockDialog;
-    QMutex m_mutex;
     QHash<QUrl, QVector<AdBlockedRequest>> m_blockedRequests;
 };
 
@@ -18,8 +18,17 @@
 #include "adblockmatcher.h"
 #include "adblockmanager.h"
 #include "adblockrule.h"
+#include "adblockrequest.h"
 #include "adblocksubscription.h"
 
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+AdBlockMatcher::Rules::~Rules()
+{
+    qDeleteAll(ownedRules);
+}
+
 AdBlockMatcher::AdBlockMatcher(AdBlockManager* manager)
     : QObject(manager)
     , m_manager(manager)
@@ -31,39 +40,44 @@ AdBlockMatcher::~AdBlockMatcher()
     clear();
 }
 
-const AdBlockRule* AdBlockMatcher::match(const QWebEngineUrlRequestInfo &request, const QString &urlDomain, const QString &urlString) const
+bool AdBlockMatcher::match(const AdBlockRequest &request, const QString &urlDomain, const QString &urlString,
+                           QString &ruleFilter, QString &ruleSubscription) const
 {
+    // Keeps rules alive even if update() publishes new ones meanwhile
+    const std::shared_ptr<const Rules> r = rules();
+    if (!r)
+        return false;
+
     // Exception rules
-    if (m_networkExceptionTree.find(request, urlDomain, urlString))
-        return 0;
+    if (r->networkExceptionTree.find(request, urlDomain, urlString))
+        return false;
 
-    int count = m_networkExceptionRules.count();
-    for (int i = 0; i < count; ++i) {
-        const AdBlockRule* rule = m_networkExceptionRules.at(i);
-        if (rule->networkMatch(request, urlDomain, urlString))
-            return 0;
-    }
+    if (r->networkExceptionIndex.find(request, urlDomain, urlString))
+        return false;
 
     // Block rules
-    if (const AdBlockRule* rule = m_networkBlockTree.find(request, urlDomain, urlString))
-        return rule;
+    const AdBlockRule* rule = r->networkBlockTree.find(request, urlDomain, urlString);
+    if (!rule)
+        rule = r->networkBlockIndex.find(request, urlDomain, urlString);
 
-    count = m_networkBlockRules.count();
-    for (int i = 0; i < count; ++i) {
-        const AdBlockRule* rule = m_networkBlockRules.at(i);
-        if (rule->networkMatch(request, urlDomain, urlString))
-            return rule;
-    }
+    if (!rule)
+        return false;
 
-    return 0;
+    ruleFilter = rule->filter();
+    ruleSubscription = r->subscriptionTitles.value(rule->subscription());
+    return true;
 }
 
 bool AdBlockMatcher::adBlockDisabledForUrl(const QUrl &url) const
 {
-    int count = m_documentRules.count();
+    const std::shared_ptr<const Rules> r = rules();
+    if (!r)
+        return false;
+
+    int count = r->documentRules.count();
 
     for (int i = 0; i < count; ++i)
-        if (m_documentRules.at(i)->urlMatch(url))
+        if (r->documentRules.at(i)->urlMatch(url))
             return true;
 
     return false;
@@ -74,10 +88,14 @@ bool AdBlockMatcher::elemHideDisabledForUrl(const QUrl &url) const
     if (adBlockDisabledForUrl(url))
         return true;
 
-    int count = m_elemhideRules.count();
+    const std::shared_ptr<const Rules> r = rules();
+    if (!r)
+        return false;
+
+    int count = r->elemhideRules.count();
 
     for (int i = 0; i < count; ++i)
-        if (m_elemhideRules.at(i)->urlMatch(url))
+        if (r->elemhideRules.at(i)->urlMatch(url))
             return true;
 
     return false;
@@ -85,17 +103,22 @@ bool AdBlockMatcher::elemHideDisabledForUrl(const QUrl &url) const
 
 QString AdBlockMatcher::elementHidingRules() const
 {
-    return m_elementHidingRules;
+    const std::shared_ptr<const Rules> r = rules();
+    return r ? r->elementHidingRules : QString();
 }
 
 QString AdBlockMatcher::elementHidingRulesForDomain(const QString &domain) const
 {
+    const std::shared_ptr<const Rules> r = rules();
+    if (!r)
+        return QString();
+
     QString rules;
     int addedRulesCount = 0;
-    int count = m_domainRestrictedCssRules.count();
+    int count = r->domainRestrictedCssRules.count();
 
     for (int i = 0; i < count; ++i) {
-        const AdBlockRule* rule = m_domainRestrictedCssRules.at(i);
+        const AdBlockRule* rule = r->domainRestrictedCssRules.at(i);
         if (!rule->matchDomain(domain))
             continue;
 
@@ -120,47 +143,111 @@ QString AdBlockMatcher::elementHidingRulesForDomain(const QString &domain) const
 
 void AdBlockMatcher::update()
 {
-    clear();
+    update(m_manager->subscriptions());
+}
 
-    QHash<QString, const AdBlockRule*> cssRulesHash;
-    QVector<const AdBlockRule*> exceptionCssRules;
+void AdBlockMatcher::update(const QList<AdBlockSubscription*> &subscriptions)
+{
+    // Rules are copied here in UI thread, compiling them doesn't touch subscriptions
+    QVector<AdBlockRule*> rules;
+    QHash<const AdBlockSubscription*, QString> subscriptionTitles;
 
-    const auto subscriptions = m_manager->subscriptions();
     for (AdBlockSubscription* subscription : subscriptions) {
-        const auto rules = subscription->allRules();
-        for (const AdBlockRule* rule : rules) {
+        subscriptionTitles.insert(subscription, subscription->title());
+
+        const auto subscriptionRules = subscription->allRules();
+        for (const AdBlockRule* rule : subscriptionRules) {
             // Don't add internally disabled rules to cache
             if (rule->isInternalDisabled())
                 continue;
 
-            if (rule->isCssRule()) {
-                // We will add only enabled css rules to cache, because there is no enabled/disabled
-                // check on match. They are directly embedded to pages.
-                if (!rule->isEnabled())
-                    continue;
-
-                if (rule->isException())
-                    exceptionCssRules.append(rule);
-                else
-                    cssRulesHash.insert(rule->cssSelector(), rule);
-            }
-            else if (rule->isDocument()) {
-                m_documentRules.append(rule);
-            }
-            else if (rule->isElemhide()) {
-                m_elemhideRules.append(rule);
-            }
-            else if (rule->isException()) {
-                if (!m_networkExceptionTree.add(rule))
-                    m_networkExceptionRules.append(rule);
-            }
-            else {
-                if (!m_networkBlockTree.add(rule))
-                    m_networkBlockRules.append(rule);
-            }
+            rules.append(rule->copy());
         }
     }
 
+    const int generation = ++m_generation;
+
+    // There are no rules to match with until compile finishes, so do it right away
+    if (!this->rules()) {
+        setRules(compile(rules, subscriptionTitles));
+        return;
+    }
+
+    // Old rules are used for matching until the new ones are compiled
+    auto watcher = new QFutureWatcher<std::shared_ptr<const Rules>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [=]() {
+        watcher->deleteLater();
+
+        // Superseded by newer update() or clear()
+        if (generation != m_generation)
+            return;
+
+        setRules(watcher->result());
+    });
+
+    watcher->setFuture(QtConcurrent::run(&AdBlockMatcher::compile, rules, subscriptionTitles));
+}
+
+void AdBlockMatcher::clear()
+{
+    ++m_generation;
+    setRules(nullptr);
+}
+
+std::shared_ptr<const AdBlockMatcher::Rules> AdBlockMatcher::rules() const
+{
+    return std::atomic_load(&m_rules);
+}
+
+void AdBlockMatcher::setRules(const std::shared_ptr<const Rules> &rules)
+{
+    // Previous rules are deleted once the last request using them finishes
+    std::atomic_store(&m_rules, rules);
+}
+
+// static
+std::shared_ptr<const AdBlockMatcher::Rules> AdBlockMatcher::compile(const QVector<AdBlockRule*> &rules, const QHash<const AdBlockSubscription*, QString> &subscriptionTitles)
+{
+    auto r = std::make_shared<Rules>();
+    r->ownedRules = rules;
+    r->subscriptionTitles = subscriptionTitles;
+
+    QHash<QString, const AdBlockRule*> cssRulesHash;
+    QVector<const AdBlockRule*> exceptionCssRules;
+
+    for (const AdBlockRule* rule : rules) {
+        if (rule->isCssRule()) {
+            // We will add only enabled css rules to cache, because there is no enabled/disabled
+            // check on match. They are directly embedded to pages.
+            if (!rule->isEnabled())
+                continue;
+
+            if (rule->isException())
+                exceptionCssRules.append(rule);
+            else
+                cssRulesHash.insert(rule->cssSelector(), rule);
+        }
+        else if (rule->isDocument()) {
+            r->documentRules.append(rule);
+        }
+        else if (rule->isElemhide()) {
+            r->elemhideRules.append(rule);
+        }
+        else if (rule->isException()) {
+            if (!r->networkExceptionTree.add(rule))
+                r->networkExceptionIndex.add(rule);
+        }
+        else {
+            if (!r->networkBlockTree.add(rule))
+                r->networkBlockIndex.add(rule);
+        }
+    }
+
+    r->networkExceptionTree.build();
+    r->networkExceptionIndex.build();
+    r->networkBlockTree.build();
+    r->networkBlockIndex.build();
+
     for (const AdBlockRule* rule : qAsConst(exceptionCssRules)) {
         const AdBlockRule* originalRule = cssRulesHash.value(rule->cssSelector());
 
@@ -171,9 +258,10 @@ void AdBlockMatcher::update()
         AdBlockRule* copiedRule = originalRule->copy();
         copiedRule->m_options |= AdBlockRule::DomainRestrictedOption;
         copiedRule->m_blockedDomains.append(rule->m_allowedDomains);
+        copiedRule->updateDomainHashes();
 
         cssRulesHash[rule->cssSelector()] = copiedRule;
-        m_createdRules.append(copiedRule);
+        r->ownedRules.append(copiedRule);
     }
 
     // Apparently, excessive amount of selectors for one CSS rule is not what WebKit likes.
@@ -187,35 +275,23 @@ void AdBlockMatcher::update()
         const AdBlockRule* rule = it.value();
 
         if (rule->isDomainRestricted()) {
-            m_domainRestrictedCssRules.append(rule);
+            r->domainRestrictedCssRules.append(rule);
         }
         else if (Q_UNLIKELY(hidingRulesCount == 1000)) {
-            m_elementHidingRules.append(rule->cssSelector());
-            m_elementHidingRules.append(QL1S("{display:none !important;} "));
+            r->elementHidingRules.append(rule->cssSelector());
+            r->elementHidingRules.append(QL1S("{display:none !important;} "));
             hidingRulesCount = 0;
         }
         else {
-            m_elementHidingRules.append(rule->cssSelector() + QLatin1Char(','));
+            r->elementHidingRules.append(rule->cssSelector() + QLatin1Char(','));
             hidingRulesCount++;
         }
     }
 
     if (hidingRulesCount != 0) {
-        m_elementHidingRules = m_elementHidingRules.left(m_elementHidingRules.size() - 1);
-        m_elementHidingRules.append(QL1S("{display:none !important;} "));
+        r->elementHidingRules = r->elementHidingRules.left(r->elementHidingRules.size() - 1);
+        r->elementHidingRules.append(QL1S("{display:none !important;} "));
     }
-}
 
-void AdBlockMatcher::clear()
-{
-    m_networkExceptionTree.clear();
-    m_networkExceptionRules.clear();
-    m_networkBlockTree.clear();
-    m_networkBlockRules.clear();
-    m_domainRestrictedCssRules.clear();
-    m_elementHidingRules.clear();
-    m_documentRules.clear();
-    m_elemhideRules.clear();
-    qDeleteAll(m_createdRules);
-    m_createdRules.clear();
+    return r;
 }
@@ -19,14 +19,19 @@
 #define ADBLOCKMATCHER_H
 
 #include <QUrl>
+#include <QHash>
 #include <QObject>
 
+#include <memory>
+
 #include "qzcommon.h"
 #include "adblocksearchtree.h"
+#include "adblocktokenindex.h"
 
-class QWebEngineUrlRequestInfo;
+class AdBlockRequest;
 
 class AdBlockManager;
+class AdBlockSubscription;
 
 class FALKON_EXPORT AdBlockMatcher : public QObject
 {
@@ -36,7 +41,9 @@ public:
     explicit AdBlockMatcher(AdBlockManager* manager);
     ~AdBlockMatcher();
 
-    const AdBlockRule* match(const QWebEngineUrlRequestInfo &request, const QString &urlDomain, const QString &urlString) const;
+    // Thread-safe, can be called from IO thread while rules are being updated
+    bool match(const AdBlockRequest &request, const QString &urlDomain, const QString &urlString,
+               QString &ruleFilter, QString &ruleSubscription) const;
 
     bool adBlockDisabledForUrl(const QUrl &url) const;
     bool elemHideDisabledForUrl(const QUrl &url) const;
@@ -44,23 +51,43 @@ public:
     QString elementHidingRules() const;
     QString elementHidingRulesForDomain(const QString &domain) const;
 
+    // Compiles rules from subscriptions, synchronously when there are no rules yet
+    void update(const QList<AdBlockSubscription*> &subscriptions);
+
 public Q_SLOTS:
     void update();
     void clear();
 
 private:
-    AdBlockManager* m_manager;
+    // Compiled rules, never modified after being published
+    struct Rules {
+        ~Rules();
+
+        // Copies of subscription rules, so that subscriptions can change while rules are in use
+        QVector<AdBlockRule*> ownedRules;
+        QHash<const AdBlockSubscription*, QString> subscriptionTitles;
+
+        QVector<const AdBlockRule*> domainRestrictedCssRules;
+        QVector<const AdBlockRule*> documentRules;
+        QVector<const AdBlockRule*> elemhideRules;
 
-    QVector<AdBlockRule*> m_createdRules;
-    QVector<const AdBlockRule*> m_networkExceptionRules;
-    QVector<const AdBlockRule*> m_networkBlockRules;
-    QVector<const AdBlockRule*> m_domainRestrictedCssRules;
-    QVector<const AdBlockRule*> m_documentRules;
-    QVector<const AdBlockRule*> m_elemhideRules;
+        QString elementHidingRules;
+        AdBlockSearchTree networkBlockTree;
+        AdBlockSearchTree networkExceptionTree;
+        AdBlockTokenIndex networkBlockIndex;
+        AdBlockTokenIndex networkExceptionIndex;
+    };
+
+    std::shared_ptr<const Rules> rules() const;
+    void setRules(const std::shared_ptr<const Rules> &rules);
+
+    static std::shared_ptr<const Rules> compile(const QVector<AdBlockRule*> &rules, const QHash<const AdBlockSubscription*, QString> &subscriptionTitles);
+
+    AdBlockManager* m_manager;
 
-    QString m_elementHidingRules;
-    AdBlockSearchTree m_networkBlockTree;
-    AdBlockSearchTree m_networkExceptionTree;
+    // Only accessed with std::atomic_load / std::atomic_store
+    std::shared_ptr<const Rules> m_rules;
+    int m_generation = 0;
 };
 
 #endif // ADBLOCKMATCHER_H
@@ -0,0 +1,103 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "adblockrequest.h"
+
+#include <algorithm>
+
+AdBlockRequest::AdBlockRequest(const QWebEngineUrlRequestInfo &info)
+    : m_requestUrl(info.requestUrl())
+    , m_firstPartyUrl(info.firstPartyUrl())
+    , m_resourceType(info.resourceType())
+{
+}
+
+AdBlockRequest::AdBlockRequest(const QUrl &requestUrl, const QUrl &firstPartyUrl, QWebEngineUrlRequestInfo::ResourceType resourceType)
+    : m_requestUrl(requestUrl)
+    , m_firstPartyUrl(firstPartyUrl)
+    , m_resourceType(resourceType)
+{
+}
+
+bool AdBlockRequest::isThirdParty() const
+{
+    if (m_thirdParty == -1) {
+        m_thirdParty = registrableDomain(m_firstPartyUrl) != registrableDomain(m_requestUrl);
+    }
+    return m_thirdParty;
+}
+
+const QVector<quint64> &AdBlockRequest::firstPartyDomainHashes() const
+{
+    if (!m_hasDomainHashes) {
+        m_firstPartyDomainHashes = domainSuffixHashes(m_firstPartyUrl.host());
+        m_hasDomainHashes = true;
+    }
+    return m_firstPartyDomainHashes;
+}
+
+// static
+quint64 AdBlockRequest::domainHash(const QString &domain, int position)
+{
+    // 64-bit FNV-1a, collisions are practically impossible for domain lists
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    const QChar* data = domain.constData();
+    for (int i = position; i < domain.size(); ++i) {
+        hash ^= data[i].unicode();
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+// static
+QVector<quint64> AdBlockRequest::domainSuffixHashes(const QString &domain)
+{
+    QVector<quint64> hashes;
+    if (domain.isEmpty()) {
+        return hashes;
+    }
+
+    hashes.append(domainHash(domain));
+    int index = domain.indexOf(QL1C('.'));
+    while (index != -1) {
+        hashes.append(domainHash(domain, index + 1));
+        index = domain.indexOf(QL1C('.'), index + 1);
+    }
+
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
+// static
+QString AdBlockRequest::registrableDomain(const QUrl &url)
+{
+    const QString topLevelDomain = url.topLevelDomain();
+    const QString urlHost = url.host();
+
+    if (topLevelDomain.isEmpty() || urlHost.isEmpty()) {
+        return QString();
+    }
+
+    // topLevelDomain() starts with dot
+    const int end = urlHost.size() - topLevelDomain.size();
+    if (end <= 0) {
+        return urlHost;
+    }
+
+    const int dot = urlHost.lastIndexOf(QL1C('.'), end - 1);
+    return dot == -1 ? urlHost : urlHost.mid(dot + 1);
+}
@@ -0,0 +1,60 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef ADBLOCKREQUEST_H
+#define ADBLOCKREQUEST_H
+
+#include <QUrl>
+#include <QVector>
+#include <QWebEngineUrlRequestInfo>
+
+#include "qzcommon.h"
+
+// Request data used for matching network rules, can also be created without QtWebEngine (benchmarks)
+// Values derived from urls are computed once per request and shared by all evaluated rules
+class FALKON_EXPORT AdBlockRequest
+{
+public:
+    explicit AdBlockRequest(const QWebEngineUrlRequestInfo &info);
+    AdBlockRequest(const QUrl &requestUrl, const QUrl &firstPartyUrl, QWebEngineUrlRequestInfo::ResourceType resourceType);
+
+    QUrl requestUrl() const { return m_requestUrl; }
+    QUrl firstPartyUrl() const { return m_firstPartyUrl; }
+    QWebEngineUrlRequestInfo::ResourceType resourceType() const { return m_resourceType; }
+
+    // Whether registrable domains of request and first party urls differ
+    bool isThirdParty() const;
+
+    // Sorted hashes of all suffixes of first party host, see domainSuffixHashes()
+    const QVector<quint64> &firstPartyDomainHashes() const;
+
+    static quint64 domainHash(const QString &domain, int position = 0);
+    // Hashes of "a.b.c", "b.c" and "c" for domain "a.b.c"
+    static QVector<quint64> domainSuffixHashes(const QString &domain);
+    static QString registrableDomain(const QUrl &url);
+
+private:
+    QUrl m_requestUrl;
+    QUrl m_firstPartyUrl;
+    QWebEngineUrlRequestInfo::ResourceType m_resourceType;
+
+    mutable int m_thirdParty = -1;
+    mutable bool m_hasDomainHashes = false;
+    mutable QVector<quint64> m_firstPartyDomainHashes;
+};
+
+#endif // ADBLOCKREQUEST_H
@@ -46,35 +46,17 @@
 
 #include "adblockrule.h"
 #include "adblocksubscription.h"
+#include "adblockrequest.h"
 #include "qztools.h"
 
 #include <QUrl>
+#include <QDataStream>
 #include <QString>
 #include <QStringList>
 #include <QWebEnginePage>
 #include <QWebEngineUrlRequestInfo>
 
-static QString toSecondLevelDomain(const QUrl &url)
-{
-    const QString topLevelDomain = url.topLevelDomain();
-    const QString urlHost = url.host();
-
-    if (topLevelDomain.isEmpty() || urlHost.isEmpty()) {
-        return QString();
-    }
-
-    QString domain = urlHost.left(urlHost.size() - topLevelDomain.size());
-
-    if (domain.count(QL1C('.')) == 0) {
-        return urlHost;
-    }
-
-    while (domain.count(QL1C('.')) != 0) {
-        domain = domain.mid(domain.indexOf(QL1C('.')) + 1);
-    }
-
-    return domain + topLevelDomain;
-}
+#include <algorithm>
 
 AdBlockRule::AdBlockRule(const QString &filter, AdBlockSubscription* subscription)
     : m_subscription(subscription)
@@ -108,6 +90,8 @@ AdBlockRule* AdBlockRule::copy() const
     rule->m_isInternalDisabled = m_isInternalDisabled;
     rule->m_allowedDomains = m_allowedDomains;
     rule->m_blockedDomains = m_blockedDomains;
+    rule->m_allowedDomainHashes = m_allowedDomainHashes;
+    rule->m_blockedDomainHashes = m_blockedDomainHashes;
 
     if (m_regExp) {
         rule->m_regExp = new RegExp;
@@ -206,7 +190,7 @@ bool AdBlockRule::urlMatch(const QUrl &url) const
     return stringMatch(domain, encodedUrl);
 }
 
-bool AdBlockRule::networkMatch(const QWebEngineUrlRequestInfo &request, const QString &domain, const QString &encodedUrl) const
+bool AdBlockRule::networkMatch(const AdBlockRequest &request, const QString &domain, const QString &encodedUrl) const
 {
     if (m_type == CssRule || !m_isEnabled || m_isInternalDisabled) {
         return false;
@@ -216,7 +200,7 @@ bool AdBlockRule::networkMatch(const QWebEngineUrlRequestInfo &request, const QS
 
     if (matched) {
         // Check domain restrictions
-        if (hasOption(DomainRestrictedOption) && !matchDomain(request.firstPartyUrl().host())) {
+        if (hasOption(DomainRestrictedOption) && !matchDomainHashes(request.firstPartyDomainHashes())) {
             return false;
         }
 
@@ -289,120 +273,88 @@ bool AdBlockRule::matchDomain(const QString &domain) const
         return true;
     }
 
-    if (m_blockedDomains.isEmpty()) {
-        for (const QString &d : qAsConst(m_allowedDomains)) {
-            if (isMatchingDomain(domain, d)) {
-                return true;
-            }
-        }
-    }
-    else if (m_allowedDomains.isEmpty()) {
-        for (const QString &d : qAsConst(m_blockedDomains)) {
-            if (isMatchingDomain(domain, d)) {
-                return false;
-            }
-        }
-        return true;
-    }
-    else {
-        for (const QString &d : qAsConst(m_blockedDomains)) {
-            if (isMatchingDomain(domain, d)) {
-                return false;
-            }
-        }
-
-        for (const QString &d : qAsConst(m_allowedDomains)) {
-            if (isMatchingDomain(domain, d)) {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    return matchDomainHashes(AdBlockRequest::domainSuffixHashes(domain));
 }
 
-bool AdBlockRule::matchThirdParty(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchThirdParty(const AdBlockRequest &request) const
 {
-    // Third-party matching should be performed on second-level domains
-    const QString firstPartyHost = toSecondLevelDomain(request.firstPartyUrl());
-    const QString host = toSecondLevelDomain(request.requestUrl());
-
-    bool match = firstPartyHost != host;
+    // Third-party matching is performed on registrable domains
+    bool match = request.isThirdParty();
 
     return hasException(ThirdPartyOption) ? !match : match;
 }
 
-bool AdBlockRule::matchObject(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchObject(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeObject;
 
     return hasException(ObjectOption) ? !match : match;
 }
 
-bool AdBlockRule::matchSubdocument(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchSubdocument(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeSubFrame;
 
     return hasException(SubdocumentOption) ? !match : match;
 }
 
-bool AdBlockRule::matchXmlHttpRequest(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchXmlHttpRequest(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeXhr;
 
     return hasException(XMLHttpRequestOption) ? !match : match;
 }
 
-bool AdBlockRule::matchImage(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchImage(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage;
 
     return hasException(ImageOption) ? !match : match;
 }
 
-bool AdBlockRule::matchScript(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchScript(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeScript;
 
     return hasException(ScriptOption) ? !match : match;
 }
 
-bool AdBlockRule::matchStyleSheet(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchStyleSheet(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeStylesheet;
 
     return hasException(StyleSheetOption) ? !match : match;
 }
 
-bool AdBlockRule::matchObjectSubrequest(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchObjectSubrequest(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypePluginResource;
 
     return hasException(ObjectSubrequestOption) ? !match : match;
 }
 
-bool AdBlockRule::matchPing(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchPing(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypePing;
 
     return hasException(PingOption) ? !match : match;
 }
 
-bool AdBlockRule::matchMedia(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchMedia(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMedia;
 
     return hasException(MediaOption) ? !match : match;
 }
 
-bool AdBlockRule::matchFont(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchFont(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeFontResource;
 
     return hasException(FontOption) ? !match : match;
 }
 
-bool AdBlockRule::matchOther(const QWebEngineUrlRequestInfo &request) const
+bool AdBlockRule::matchOther(const AdBlockRequest &request) const
 {
     bool match = request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeFontResource
               || request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeSubResource
@@ -416,6 +368,83 @@ bool AdBlockRule::matchOther(const QWebEngineUrlRequestInfo &request) const
     return hasException(MediaOption) ? !match : match;
 }
 
+void AdBlockRule::saveParsed(QDataStream &stream) const
+{
+    stream << m_filter;
+    stream << m_matchString;
+    stream << qint32(m_type);
+    stream << qint32(m_options);
+    stream << qint32(m_exceptions);
+    stream << qint32(m_caseSensitivity);
+    stream << m_isEnabled;
+    stream << m_isException;
+    stream << m_isInternalDisabled;
+    stream << m_allowedDomains;
+    stream << m_blockedDomains;
+
+    stream << bool(m_regExp);
+    if (m_regExp) {
+        QStringList matchers;
+        matchers.reserve(m_regExp->matchers.size());
+        for (const QStringMatcher &matcher : qAsConst(m_regExp->matchers)) {
+            matchers.append(matcher.pattern());
+        }
+        stream << m_regExp->regExp.pattern();
+        stream << qint32(m_regExp->regExp.patternOptions());
+        stream << matchers;
+    }
+}
+
+bool AdBlockRule::loadParsed(QDataStream &stream)
+{
+    qint32 type;
+    qint32 options;
+    qint32 exceptions;
+    qint32 caseSensitivity;
+    bool hasRegExp;
+
+    stream >> m_filter;
+    stream >> m_matchString;
+    stream >> type;
+    stream >> options;
+    stream >> exceptions;
+    stream >> caseSensitivity;
+    stream >> m_isEnabled;
+    stream >> m_isException;
+    stream >> m_isInternalDisabled;
+    stream >> m_allowedDomains;
+    stream >> m_blockedDomains;
+    stream >> hasRegExp;
+
+    if (stream.status() != QDataStream::Ok || type < CssRule || type > Invalid) {
+        return false;
+    }
+
+    m_type = static_cast<RuleType>(type);
+    m_options = RuleOptions(options);
+    m_exceptions = RuleOptions(exceptions);
+    m_caseSensitivity = static_cast<Qt::CaseSensitivity>(caseSensitivity);
+    updateDomainHashes();
+
+    delete m_regExp;
+    m_regExp = nullptr;
+
+    if (hasRegExp) {
+        QString pattern;
+        qint32 patternOptions;
+        QStringList matchers;
+        stream >> pattern;
+        stream >> patternOptions;
+        stream >> matchers;
+
+        m_regExp = new RegExp;
+        m_regExp->regExp = QRegularExpression(pattern, QRegularExpression::PatternOptions(patternOptions));
+        m_regExp->matchers = createStringMatchers(matchers);
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
 void AdBlockRule::parseFilter()
 {
     QString parsedLine = m_filter;
@@ -648,6 +677,50 @@ void AdBlockRule::parseDomains(const QString &domains, const QChar &separator)
     if (!m_blockedDomains.isEmpty() || !m_allowedDomains.isEmpty()) {
         setOption(DomainRestrictedOption);
     }
+
+    updateDomainHashes();
+}
+
+void AdBlockRule::updateDomainHashes()
+{
+    m_allowedDomainHashes.clear();
+    m_blockedDomainHashes.clear();
+
+    for (const QString &domain : qAsConst(m_allowedDomains)) {
+        m_allowedDomainHashes.append(AdBlockRequest::domainHash(domain));
+    }
+
+    for (const QString &domain : qAsConst(m_blockedDomains)) {
+        m_blockedDomainHashes.append(AdBlockRequest::domainHash(domain));
+    }
+
+    std::sort(m_allowedDomainHashes.begin(), m_allowedDomainHashes.end());
+    std::sort(m_blockedDomainHashes.begin(), m_blockedDomainHashes.end());
+}
+
+// Domain matches rule domain if it is equal to it or its subdomain, so it is enough
+// to look up hashes of all domain suffixes in sorted rule domain hashes
+static bool containsAnyHash(const QVector<quint64> &ruleHashes, const QVector<quint64> &domainHashes)
+{
+    for (quint64 hash : domainHashes) {
+        if (std::binary_search(ruleHashes.constBegin(), ruleHashes.constEnd(), hash)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AdBlockRule::matchDomainHashes(const QVector<quint64> &domainHashes) const
+{
+    if (m_blockedDomainHashes.isEmpty()) {
+        return containsAnyHash(m_allowedDomainHashes, domainHashes);
+    }
+
+    if (containsAnyHash(m_blockedDomainHashes, domainHashes)) {
+        return false;
+    }
+
+    return m_allowedDomainHashes.isEmpty() || containsAnyHash(m_allowedDomainHashes, domainHashes);
 }
 
 bool AdBlockRule::filterIsOnlyDomain(const QString &filter) const
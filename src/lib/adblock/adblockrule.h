@@ -47,6 +47,7 @@
 #define ADBLOCKRULE_H
 
 #include <QObject>
+#include <QVector>
 #include <QStringList>
 #include <QStringMatcher>
 #include <QRegularExpression>
@@ -54,7 +55,8 @@
 #include "qzcommon.h"
 
 class QUrl;
-class QWebEngineUrlRequestInfo;
+class QDataStream;
+class AdBlockRequest;
 
 class AdBlockSubscription;
 
@@ -91,21 +93,25 @@ public:
     bool isInternalDisabled() const;
 
     bool urlMatch(const QUrl &url) const;
-    bool networkMatch(const QWebEngineUrlRequestInfo &request, const QString &domain, const QString &encodedUrl) const;
+    bool networkMatch(const AdBlockRequest &request, const QString &domain, const QString &encodedUrl) const;
 
     bool matchDomain(const QString &domain) const;
-    bool matchThirdParty(const QWebEngineUrlRequestInfo &request) const;
-    bool matchObject(const QWebEngineUrlRequestInfo &request) const;
-    bool matchSubdocument(const QWebEngineUrlRequestInfo &request) const;
-    bool matchXmlHttpRequest(const QWebEngineUrlRequestInfo &request) const;
-    bool matchImage(const QWebEngineUrlRequestInfo &request) const;
-    bool matchScript(const QWebEngineUrlRequestInfo &request) const;
-    bool matchStyleSheet(const QWebEngineUrlRequestInfo &request) const;
-    bool matchObjectSubrequest(const QWebEngineUrlRequestInfo &request) const;
-    bool matchPing(const QWebEngineUrlRequestInfo &request) const;
-    bool matchMedia(const QWebEngineUrlRequestInfo &request) const;
-    bool matchFont(const QWebEngineUrlRequestInfo &request) const;
-    bool matchOther(const QWebEngineUrlRequestInfo &request) const;
+    bool matchThirdParty(const AdBlockRequest &request) const;
+    bool matchObject(const AdBlockRequest &request) const;
+    bool matchSubdocument(const AdBlockRequest &request) const;
+    bool matchXmlHttpRequest(const AdBlockRequest &request) const;
+    bool matchImage(const AdBlockRequest &request) const;
+    bool matchScript(const AdBlockRequest &request) const;
+    bool matchStyleSheet(const AdBlockRequest &request) const;
+    bool matchObjectSubrequest(const AdBlockRequest &request) const;
+    bool matchPing(const AdBlockRequest &request) const;
+    bool matchMedia(const AdBlockRequest &request) const;
+    bool matchFont(const AdBlockRequest &request) const;
+    bool matchOther(const AdBlockRequest &request) const;
+
+    // Parsed state of the rule, used by subscription cache to skip parsing
+    void saveParsed(QDataStream &stream) const;
+    bool loadParsed(QDataStream &stream);
 
 protected:
     bool stringMatch(const QString &domain, const QString &encodedUrl) const;
@@ -155,6 +161,8 @@ private:
 
     void parseFilter();
     void parseDomains(const QString &domains, const QChar &separator);
+    void updateDomainHashes();
+    bool matchDomainHashes(const QVector<quint64> &domainHashes) const;
     bool filterIsOnlyDomain(const QString &filter) const;
     bool filterIsOnlyEndsMatch(const QString &filter) const;
     QString createRegExpFromFilter(const QString &filter) const;
@@ -180,6 +188,10 @@ private:
     QStringList m_allowedDomains;
     QStringList m_blockedDomains;
 
+    // Sorted hashes of domains above, for matching with AdBlockRequest::domainSuffixHashes
+    QVector<quint64> m_allowedDomainHashes;
+    QVector<quint64> m_blockedDomainHashes;
+
     struct RegExp {
         QRegularExpression regExp;
         QList<QStringMatcher> matchers;
@@ -190,6 +202,7 @@ private:
 
     friend class AdBlockMatcher;
     friend class AdBlockSearchTree;
+    friend class AdBlockTokenIndex;
     friend class AdBlockSubscription;
 };
 
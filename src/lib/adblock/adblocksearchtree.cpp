@@ -17,23 +17,48 @@
 * ============================================================ */
 #include "adblocksearchtree.h"
 #include "adblockrule.h"
+#include "adblockrequest.h"
 
-#include <QWebEngineUrlRequestInfo>
+#include <algorithm>
+#include <cstring>
+
+// Characters outside of Latin-1 map to 0, which no pattern contains
+static inline uchar toLowerLatin1(ushort c)
+{
+    static const struct LowerTable {
+        uchar data[256];
+
+        LowerTable()
+        {
+            for (int i = 0; i < 256; ++i) {
+                data[i] = uchar(QChar(ushort(i)).toLower().unicode());
+            }
+        }
+    } table;
+
+    return c < 256 ? table.data[c] : 0;
+}
 
 AdBlockSearchTree::AdBlockSearchTree()
-    : m_root(new Node)
 {
+    clear();
 }
 
 AdBlockSearchTree::~AdBlockSearchTree()
 {
-    deleteNode(m_root);
 }
 
 void AdBlockSearchTree::clear()
 {
-    deleteNode(m_root);
-    m_root = new Node;
+    m_patterns.clear();
+    m_childStart.clear();
+    m_edgeBytes.clear();
+    m_edgeTargets.clear();
+    m_fail.clear();
+    m_outputLink.clear();
+    m_outputStart.clear();
+    m_outputs.clear();
+    std::fill(m_rootTargets, m_rootTargets + 256, 0);
 }
 
 bool AdBlockSearchTree::add(const AdBlockRule* rule)
@@ -50,88 +75,179 @@ bool AdBlockSearchTree::add(const AdBlockRule* rule)
         return false;
     }
 
-    Node* node = m_root;
+    // Case sensitivity is checked by rule itself on match
+    QByteArray string(len, Qt::Uninitialized);
 
     for (int i = 0; i < len; ++i) {
-        const QChar c = filter.at(i);
-        Node *next = node->children.value(c);
-        if (!next) {
-            next = new Node;
-            next->c = c;
-            node->children[c] = next;
+        const uchar c = toLowerLatin1(filter.at(i).unicode());
+        if (c == 0) {
+            return false;
         }
-        node = next;
+        string[i] = char(c);
     }
 
-    node->rule = rule;
+    m_patterns.append(Pattern{string, rule});
 
     return true;
 }
 
-const AdBlockRule* AdBlockSearchTree::find(const QWebEngineUrlRequestInfo &request, const QString &domain, const QString &urlString) const
+void AdBlockSearchTree::build()
 {
-    int len = urlString.size();
+    // Patterns are sorted so each one shares its prefix path with the previous one,
+    // and children of every state are created in increasing byte order
+    std::stable_sort(m_patterns.begin(), m_patterns.end(), [](const Pattern &a, const Pattern &b) {
+        const int r = memcmp(a.string.constData(), b.string.constData(), qMin(a.string.size(), b.string.size()));
+        return r < 0 || (r == 0 && a.string.size() < b.string.size());
+    });
+
+    struct Edge {
+        int parent;
+        uchar c;
+        int child;
+    };
+
+    QVector<Edge> edges;
+    QVector<int> terminals;
+    QVector<int> path;
+    int statesCount = 1;
+
+    terminals.reserve(m_patterns.size());
+    path.append(0);
+
+    for (int i = 0; i < m_patterns.size(); ++i) {
+        const QByteArray &string = m_patterns.at(i).string;
+
+        int prefix = 0;
+        if (i > 0) {
+            const QByteArray &previous = m_patterns.at(i - 1).string;
+            const int max = qMin(previous.size(), string.size());
+            while (prefix < max && previous.at(prefix) == string.at(prefix)) {
+                ++prefix;
+            }
+        }
 
-    if (len <= 0) {
-        return 0;
+        path.resize(prefix + 1);
+        for (int j = prefix; j < string.size(); ++j) {
+            edges.append(Edge{path.at(j), uchar(string.at(j)), statesCount});
+            path.append(statesCount++);
+        }
+
+        terminals.append(path.last());
     }
 
-    const QChar* string = urlString.constData();
+    // Goto function in CSR layout
+    m_childStart.fill(0, statesCount + 1);
+    for (const Edge &edge : qAsConst(edges)) {
+        ++m_childStart[edge.parent + 1];
+    }
+    for (int i = 0; i < statesCount; ++i) {
+        m_childStart[i + 1] += m_childStart.at(i);
+    }
 
-    for (int i = 0; i < len; ++i) {
-        const AdBlockRule* rule = prefixSearch(request, domain, urlString, string++, len - i);
-        if (rule) {
-            return rule;
-        }
+    m_edgeBytes.resize(edges.size());
+    m_edgeTargets.resize(edges.size());
+
+    QVector<int> cursor = m_childStart;
+    for (const Edge &edge : qAsConst(edges)) {
+        const int pos = cursor[edge.parent]++;
+        m_edgeBytes[pos] = char(edge.c);
+        m_edgeTargets[pos] = edge.child;
     }
 
-    return 0;
-}
+    std::fill(m_rootTargets, m_rootTargets + 256, 0);
+    for (int i = m_childStart.at(0); i < m_childStart.at(1); ++i) {
+        m_rootTargets[uchar(m_edgeBytes.at(i))] = m_edgeTargets.at(i);
+    }
 
-const AdBlockRule* AdBlockSearchTree::prefixSearch(const QWebEngineUrlRequestInfo &request, const QString &domain, const QString &urlString, const QChar* string, int len) const
-{
-    if (len <= 0) {
-        return 0;
+    // Rules ending in each state
+    m_outputStart.fill(0, statesCount + 1);
+    for (int state : qAsConst(terminals)) {
+        ++m_outputStart[state + 1];
+    }
+    for (int i = 0; i < statesCount; ++i) {
+        m_outputStart[i + 1] += m_outputStart.at(i);
     }
 
-    QChar c = string[0];
+    m_outputs.resize(terminals.size());
 
-    Node* node = m_root->children.value(c);
-    if (!node) {
-        return nullptr;
+    cursor = m_outputStart;
+    for (int i = 0; i < terminals.size(); ++i) {
+        m_outputs[cursor[terminals.at(i)]++] = m_patterns.at(i).rule;
     }
 
-    for (int i = 1; i < len; ++i) {
-        const QChar c = (++string)[0];
+    // Failure links, computed in breadth-first order
+    m_fail.fill(0, statesCount);
+    m_outputLink.fill(0, statesCount);
 
-        if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
-            return node->rule;
-        }
+    QVector<int> queue;
+    queue.reserve(statesCount);
+    for (int i = m_childStart.at(0); i < m_childStart.at(1); ++i) {
+        queue.append(m_edgeTargets.at(i));
+    }
+
+    for (int head = 0; head < queue.size(); ++head) {
+        const int state = queue.at(head);
+
+        for (int i = m_childStart.at(state); i < m_childStart.at(state + 1); ++i) {
+            const int child = m_edgeTargets.at(i);
+            const int fail = nextState(m_fail.at(state), uchar(m_edgeBytes.at(i)));
+            const bool failHasOutput = m_outputStart.at(fail) != m_outputStart.at(fail + 1);
 
-        node = node->children.value(c);
-        if (!node) {
-            return nullptr;
+            m_fail[child] = fail;
+            m_outputLink[child] = failHasOutput ? fail : m_outputLink.at(fail);
+            queue.append(child);
         }
     }
 
-    if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
-        return node->rule;
+    // Everything needed for matching is in the arrays now
+    m_patterns.clear();
+    m_patterns.squeeze();
+}
+
+const AdBlockRule* AdBlockSearchTree::find(const AdBlockRequest &request, const QString &domain, const QString &urlString) const
+{
+    int len = urlString.size();
+
+    if (len <= 0 || m_outputs.isEmpty()) {
+        return nullptr;
+    }
+
+    const QChar* string = urlString.constData();
+    int state = 0;
+
+    for (int i = 0; i < len; ++i) {
+        state = nextState(state, toLowerLatin1(string[i].unicode()));
+
+        // Visit all patterns ending at this position
+        int s = m_outputStart.at(state) != m_outputStart.at(state + 1) ? state : m_outputLink.at(state);
+        for (; s; s = m_outputLink.at(s)) {
+            for (int j = m_outputStart.at(s); j < m_outputStart.at(s + 1); ++j) {
+                const AdBlockRule* rule = m_outputs.at(j);
+                if (rule->networkMatch(request, domain, urlString)) {
+                    return rule;
+                }
+            }
+        }
     }
 
     return nullptr;
 }
 
-void AdBlockSearchTree::deleteNode(AdBlockSearchTree::Node* node)
+inline int AdBlockSearchTree::nextState(int state, uchar c) const
 {
-    if (!node) {
-        return;
-    }
-
-    QHashIterator<QChar, Node*> i(node->children);
-    while (i.hasNext()) {
-        i.next();
-        deleteNode(i.value());
+    while (state) {
+        const int end = m_childStart.at(state + 1);
+        for (int i = m_childStart.at(state); i < end; ++i) {
+            const uchar edge = uchar(m_edgeBytes.at(i));
+            if (edge == c) {
+                return m_edgeTargets.at(i);
+            }
+            if (edge > c) {
+                break;
+            }
+        }
+        state = m_fail.at(state);
     }
 
-    delete node;
+    return m_rootTargets[c];
 }
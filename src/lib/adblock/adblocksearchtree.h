@@ -18,15 +18,18 @@
 #ifndef ADBLOCKSEARCHTREE_H
 #define ADBLOCKSEARCHTREE_H
 
-#include <QChar>
-#include <QHash>
+#include <QVector>
+#include <QByteArray>
 
 #include "qzcommon.h"
 
-class QWebEngineUrlRequestInfo;
+class AdBlockRequest;
 
 class AdBlockRule;
 
+// Aho-Corasick automaton over lowercase Latin-1 bytes, matching all
+// StringContainsMatchRule rules in one pass over the url.
+// Rules are added with add() and become searchable after build().
 class FALKON_EXPORT AdBlockSearchTree
 {
 public:
@@ -36,23 +39,34 @@ public:
     void clear();
 
     bool add(const AdBlockRule* rule);
-    const AdBlockRule* find(const QWebEngineUrlRequestInfo &request, const QString &domain, const QString &urlString) const;
+    void build();
+
+    const AdBlockRule* find(const AdBlockRequest &request, const QString &domain, const QString &urlString) const;
 
 private:
-    struct Node {
-        QChar c;
+    struct Pattern {
+        QByteArray string;
         const AdBlockRule* rule;
-        QHash<QChar, Node*> children;
-
-        Node() : c(0) , rule(0) { }
     };
 
-    const AdBlockRule* prefixSearch(const QWebEngineUrlRequestInfo &request, const QString &domain,
-                                    const QString &urlString, const QChar* string, int len) const;
+    inline int nextState(int state, uchar c) const;
+
+    // Patterns waiting for build()
+    QVector<Pattern> m_patterns;
+
+    // Goto function, children of state s are edges m_childStart[s] .. m_childStart[s + 1] sorted by byte
+    QVector<int> m_childStart;
+    QByteArray m_edgeBytes;
+    QVector<int> m_edgeTargets;
+    int m_rootTargets[256];
 
-    void deleteNode(Node* node);
+    // Failure links and links to nearest suffix state with output
+    QVector<int> m_fail;
+    QVector<int> m_outputLink;
 
-    Node* m_root;
+    // Rules ending in state s are m_outputStart[s] .. m_outputStart[s + 1]
+    QVector<int> m_outputStart;
+    QVector<const AdBlockRule*> m_outputs;
 };
 
 #endif // ADBLOCKSEARCHTREE_H
@@ -54,6 +54,12 @@
 #include <QTimer>
 #include <QNetworkReply>
 #include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+// Bump when parsing of rules changes
+static const quint32 s_cacheMagic = 0x46414243;
+static const quint32 s_cacheVersion = 1;
 
 AdBlockSubscription::AdBlockSubscription(const QString &title, QObject* parent)
     : QObject(parent)
@@ -103,7 +109,10 @@ void AdBlockSubscription::loadSubscription(const QStringList &disabledRules)
         return;
     }
 
-    QTextStream textStream(&file);
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QTextStream textStream(data);
     textStream.setCodec("UTF-8");
     // Header is on 3rd line
     textStream.readLine(1024);
@@ -119,16 +128,24 @@ void AdBlockSubscription::loadSubscription(const QStringList &disabledRules)
     qDeleteAll(m_rules);
     m_rules.clear();
 
-    while (!textStream.atEnd()) {
-        const QString line = textStream.readLine().trimmed();
-        if (line.isEmpty()) {
-            continue;
+    const QByteArray checksum = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    if (!loadCache(checksum)) {
+        while (!textStream.atEnd()) {
+            const QString line = textStream.readLine().trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+            m_rules.append(new AdBlockRule(line, this));
         }
-        AdBlockRule *rule = new AdBlockRule(line, this);
+
+        saveCache(checksum);
+    }
+
+    for (AdBlockRule* rule : qAsConst(m_rules)) {
         if (disabledRules.contains(rule->filter())) {
             rule->setEnabled(false);
         }
-        m_rules.append(rule);
     }
 
     // Initial update
@@ -141,6 +158,75 @@ void AdBlockSubscription::saveSubscription()
 {
 }
 
+QString AdBlockSubscription::cacheFilePath() const
+{
+    return m_filePath + QL1S(".cache");
+}
+
+bool AdBlockSubscription::loadCache(const QByteArray &checksum)
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    // Rules are read directly from the mapped file, it is unmapped when file is closed
+    const qint64 size = file.size();
+    const uchar* memory = file.map(0, size);
+    if (!memory) {
+        return false;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(memory), size));
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic;
+    quint32 version;
+    QByteArray cacheChecksum;
+    quint32 count;
+    stream >> magic >> version >> cacheChecksum >> count;
+
+    if (stream.status() != QDataStream::Ok || magic != s_cacheMagic || version != s_cacheVersion
+            || cacheChecksum != checksum || count > quint32(size)) {
+        return false;
+    }
+
+    QVector<AdBlockRule*> rules;
+    rules.reserve(count);
+
+    for (quint32 i = 0; i < count; ++i) {
+        AdBlockRule* rule = new AdBlockRule(QString(), this);
+        rules.append(rule);
+
+        if (!rule->loadParsed(stream)) {
+            qWarning() << "AdBlockSubscription::" << __FUNCTION__ << "Corrupted cache file" << file.fileName();
+            qDeleteAll(rules);
+            return false;
+        }
+    }
+
+    m_rules = rules;
+    return true;
+}
+
+void AdBlockSubscription::saveCache(const QByteArray &checksum) const
+{
+    QSaveFile file(cacheFilePath());
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << s_cacheMagic << s_cacheVersion << checksum << quint32(m_rules.count());
+
+    for (const AdBlockRule* rule : m_rules) {
+        rule->saveParsed(stream);
+    }
+
+    file.commit();
+}
+
 void AdBlockSubscription::updateSubscription()
 {
     if (m_reply || !m_url.isValid()) {
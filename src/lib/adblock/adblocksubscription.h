@@ -71,6 +71,9 @@ public:
     QUrl url() const;
     void setUrl(const QUrl &url);
 
+    // Binary cache of parsed rules, valid as long as subscription file doesn't change
+    QString cacheFilePath() const;
+
     virtual void loadSubscription(const QStringList &disabledRules);
     virtual void saveSubscription();
 
@@ -105,6 +108,9 @@ protected:
     QVector<AdBlockRule*> m_rules;
 
 private:
+    bool loadCache(const QByteArray &checksum);
+    void saveCache(const QByteArray &checksum) const;
+
     QString m_title;
     QString m_filePath;
 
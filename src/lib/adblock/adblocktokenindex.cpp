@@ -0,0 +1,228 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "adblocktokenindex.h"
+#include "adblockrule.h"
+#include "adblockrequest.h"
+
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+static inline bool isTokenChar(ushort c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '%';
+}
+
+// Tokens present in almost every url are useless for dispatching
+static bool isBadToken(const QString &token)
+{
+    static const QStringList badTokens = {
+        QSL("http"), QSL("https"), QSL("www"), QSL("com"), QSL("js"), QSL("html")
+    };
+    return token.size() < 2 || badTokens.contains(token);
+}
+
+AdBlockTokenIndex::AdBlockTokenIndex()
+{
+}
+
+void AdBlockTokenIndex::clear()
+{
+    m_rules.clear();
+    m_tokenRules.clear();
+    m_untokenizedRules.clear();
+}
+
+void AdBlockTokenIndex::add(const AdBlockRule* rule)
+{
+    m_rules.append(rule);
+}
+
+void AdBlockTokenIndex::build()
+{
+    QVector<QStringList> tokens;
+    tokens.reserve(m_rules.size());
+
+    QHash<QString, int> frequency;
+
+    for (const AdBlockRule* rule : qAsConst(m_rules)) {
+        const QStringList ruleTokens = AdBlockTokenIndex::ruleTokens(rule);
+        for (const QString &token : ruleTokens) {
+            ++frequency[token];
+        }
+        tokens.append(ruleTokens);
+    }
+
+    // Index each rule by its rarest token
+    for (int i = 0; i < m_rules.size(); ++i) {
+        const QStringList &ruleTokens = tokens.at(i);
+        if (ruleTokens.isEmpty()) {
+            m_untokenizedRules.append(m_rules.at(i));
+            continue;
+        }
+
+        QString best;
+        int bestScore = 0;
+
+        for (const QString &token : ruleTokens) {
+            const int score = frequency.value(token) + (isBadToken(token) ? m_rules.size() : 0);
+            if (best.isEmpty() || score < bestScore || (score == bestScore && token.size() > best.size())) {
+                best = token;
+                bestScore = score;
+            }
+        }
+
+        m_tokenRules[tokenHash(best.constData(), best.size())].append(m_rules.at(i));
+    }
+
+    m_rules.clear();
+    m_rules.squeeze();
+}
+
+const AdBlockRule* AdBlockTokenIndex::find(const AdBlockRequest &request, const QString &domain, const QString &urlString) const
+{
+    for (const AdBlockRule* rule : m_untokenizedRules) {
+        if (rule->networkMatch(request, domain, urlString)) {
+            return rule;
+        }
+    }
+
+    if (m_tokenRules.isEmpty()) {
+        return nullptr;
+    }
+
+    QVarLengthArray<uint, 64> visited;
+
+    auto findInString = [&](const QString &string) -> const AdBlockRule* {
+        const QChar* data = string.constData();
+        const int len = string.size();
+
+        int i = 0;
+        while (i < len) {
+            if (!isTokenChar(data[i].unicode())) {
+                ++i;
+                continue;
+            }
+
+            const int start = i;
+            while (i < len && isTokenChar(data[i].unicode())) {
+                ++i;
+            }
+
+            const uint hash = tokenHash(data + start, i - start);
+            if (std::find(visited.constBegin(), visited.constEnd(), hash) != visited.constEnd()) {
+                continue;
+            }
+            visited.append(hash);
+
+            const auto it = m_tokenRules.constFind(hash);
+            if (it == m_tokenRules.constEnd()) {
+                continue;
+            }
+
+            for (const AdBlockRule* rule : it.value()) {
+                if (rule->networkMatch(request, domain, urlString)) {
+                    return rule;
+                }
+            }
+        }
+
+        return nullptr;
+    };
+
+    if (const AdBlockRule* rule = findInString(urlString)) {
+        return rule;
+    }
+
+    // Domain rules match against host, which may differ from encoded url (IDN)
+    return findInString(domain);
+}
+
+// static
+QStringList AdBlockTokenIndex::ruleTokens(const AdBlockRule* rule)
+{
+    if (rule->m_type == AdBlockRule::MatchAllUrlsRule) {
+        return QStringList();
+    }
+
+    QString pattern = rule->m_filter;
+
+    if (pattern.startsWith(QL1S("@@"))) {
+        pattern.remove(0, 2);
+    }
+
+    const int optionsIndex = pattern.indexOf(QL1C('$'));
+    if (optionsIndex >= 0) {
+        pattern.truncate(optionsIndex);
+    }
+
+    // Literal parts of regular expressions are not reliable
+    if (pattern.startsWith(QL1C('/')) && pattern.endsWith(QL1C('/'))) {
+        return QStringList();
+    }
+
+    // Token is usable only if it can't be part of longer token in url, so it must be
+    // delimited by literal non-token characters, separators (^) or anchors (|) on both sides
+    auto isBoundary = [](const QChar &c) {
+        const ushort u = c.unicode();
+        return u < 0x80 && u != '*' && !isTokenChar(u);
+    };
+
+    QStringList tokens;
+    const int len = pattern.size();
+
+    int i = 0;
+    while (i < len) {
+        if (!isTokenChar(pattern.at(i).unicode())) {
+            ++i;
+            continue;
+        }
+
+        const int start = i;
+        while (i < len && isTokenChar(pattern.at(i).unicode())) {
+            ++i;
+        }
+
+        if (start == 0 || i == len || !isBoundary(pattern.at(start - 1)) || !isBoundary(pattern.at(i))) {
+            continue;
+        }
+
+        const QString token = pattern.mid(start, i - start).toLower();
+        if (!tokens.contains(token)) {
+            tokens.append(token);
+        }
+    }
+
+    return tokens;
+}
+
+// static
+uint AdBlockTokenIndex::tokenHash(const QChar* string, int len)
+{
+    // FNV-1a over lowercase characters
+    uint hash = 2166136261u;
+    for (int i = 0; i < len; ++i) {
+        ushort c = string[i].unicode();
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,57 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef ADBLOCKTOKENINDEX_H
+#define ADBLOCKTOKENINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+
+#include "qzcommon.h"
+
+class AdBlockRequest;
+
+class AdBlockRule;
+
+// Dispatches rules that AdBlockSearchTree can't handle by one literal token
+// of each rule. Only rules whose token is present in the url are evaluated.
+// Rules are added with add() and become searchable after build().
+class FALKON_EXPORT AdBlockTokenIndex
+{
+public:
+    explicit AdBlockTokenIndex();
+
+    void clear();
+
+    void add(const AdBlockRule* rule);
+    void build();
+
+    const AdBlockRule* find(const AdBlockRequest &request, const QString &domain, const QString &urlString) const;
+
+    // Tokens that must be present in any url matched by rule
+    static QStringList ruleTokens(const AdBlockRule* rule);
+    static uint tokenHash(const QChar* string, int len);
+
+private:
+    QVector<const AdBlockRule*> m_rules;
+
+    QHash<uint, QVector<const AdBlockRule*> > m_tokenRules;
+    QVector<const AdBlockRule*> m_untokenizedRules;
+};
+
+#endif // ADBLOCKTOKENINDEX_H
@@ -90,7 +90,7 @@ BrowserWindow::SavedWindow::SavedWindow()
 {
 }
 
-BrowserWindow::SavedWindow::SavedWindow(BrowserWindow *window)
+BrowserWindow::SavedWindow::SavedWindow(BrowserWindow *window, bool withTabs)
 {
     windowState = window->isFullScreen() ? QByteArray() : window->saveState();
     windowGeometry = window->saveGeometry();
@@ -99,14 +99,14 @@ BrowserWindow::SavedWindow::SavedWindow(BrowserWindow *window)
     virtualDesktop = window->getCurrentVirtualDesktop();
 #endif
 
+    if (!withTabs) {
+        return;
+    }
+
     const int tabsCount = window->tabCount();
     tabs.reserve(tabsCount);
     for (int i = 0; i < tabsCount; ++i) {
-        TabbedWebView *webView = window->weView(i);
-        if (!webView) {
-            continue;
-        }
-        WebTab* webTab = webView->webTab();
+        WebTab* webTab = window->tabWidget()->webTab(i);
         if (!webTab) {
             continue;
         }
@@ -158,6 +158,22 @@ QDataStream &operator<<(QDataStream &stream, const BrowserWindow::SavedWindow &w
     return stream;
 }
 
+void BrowserWindow::SavedWindow::writeWithEncodedTabs(QDataStream &stream, const QVector<QByteArray> &encodedTabs) const
+{
+    stream << savedWindowVersion;
+    stream << windowState;
+    stream << windowGeometry;
+    stream << virtualDesktop;
+    stream << currentTab;
+    stream << encodedTabs.count();
+
+    for (const QByteArray &tab : encodedTabs) {
+        stream.writeRawData(tab.constData(), tab.size());
+    }
+
+    stream << windowUiState;
+}
+
 QDataStream &operator>>(QDataStream &stream, BrowserWindow::SavedWindow &window)
 {
     int version;
@@ -68,11 +68,14 @@ public:
         QVector<WebTab::SavedTab> tabs;
 
         SavedWindow();
-        SavedWindow(BrowserWindow *window);
+        SavedWindow(BrowserWindow *window, bool withTabs = true);
 
         bool isValid() const;
         void clear();
 
+        // Writes window in format of operator<<, with given tabs already serialized
+        void writeWithEncodedTabs(QDataStream &stream, const QVector<QByteArray> &encodedTabs) const;
+
         friend FALKON_EXPORT QDataStream &operator<<(QDataStream &stream, const SavedWindow &window);
         friend FALKON_EXPORT QDataStream &operator>>(QDataStream &stream, SavedWindow &window);
     };
@@ -47,6 +47,10 @@
 #include "sessionmanager.h"
 #include "closedwindowsmanager.h"
 #include "protocolhandlermanager.h"
+#include "magicwandstylecache.h"
+#include "tabdiscardmanager.h"
+#include "sqldatabase.h"
+#include "databasemaintenance.h"
 #include "../config.h"
 
 #include <QWebEngineSettings>
@@ -107,6 +111,8 @@ MainApplication::MainApplication(int &argc, char** argv)
     , m_searchEnginesManager(nullptr)
     , m_closedWindowsManager(nullptr)
     , m_protocolHandlerManager(nullptr)
+    , m_magicWandStyleCache(nullptr)
+    , m_tabDiscardManager(nullptr)
     , m_html5PermissionsManager(nullptr)
     , m_desktopNotifications(nullptr)
     , m_webProfile(nullptr)
@@ -287,6 +293,10 @@ MainApplication::MainApplication(int &argc, char** argv)
 
     Settings::createSettings(DataPaths::currentProfilePath() + QLatin1String("/settings.ini"));
 
+    if (IconProvider::needsFullVacuum()) {
+        Settings().setValue(QSL("Browser/FullVacuumOnQuit"), true);
+    }
+
     NetworkManager::registerSchemes();
 
     m_webProfile = isPrivate() ? new QWebEngineProfile() : QWebEngineProfile::defaultProfile();
@@ -386,6 +396,7 @@ MainApplication::~MainApplication()
 
     // Wait for all QtConcurrent jobs to finish
     QThreadPool::globalInstance()->waitForDone();
+    SqlDatabase::instance()->waitForDone();
 
     // Delete all classes that are saving data in destructor
     delete m_bookmarks;
@@ -626,6 +637,22 @@ ProtocolHandlerManager *MainApplication::protocolHandlerManager()
     return m_protocolHandlerManager;
 }
 
+MagicWandStyleCache *MainApplication::magicWandStyleCache()
+{
+    if (!m_magicWandStyleCache) {
+        m_magicWandStyleCache = new MagicWandStyleCache(this);
+    }
+    return m_magicWandStyleCache;
+}
+
+TabDiscardManager *MainApplication::tabDiscardManager()
+{
+    if (!m_tabDiscardManager) {
+        m_tabDiscardManager = new TabDiscardManager(this);
+    }
+    return m_tabDiscardManager;
+}
+
 HTML5PermissionsManager* MainApplication::html5PermissionsManager()
 {
     if (!m_html5PermissionsManager) {
@@ -728,7 +755,7 @@ void MainApplication::quitApplication()
     }
 
     if (m_sessionManager && m_windows.count() > 0) {
-        m_sessionManager->autoSaveLastSession();
+        m_sessionManager->writeLastSession();
     }
 
     m_isClosing = true;
@@ -766,6 +793,9 @@ void MainApplication::postLaunch()
     createJumpList();
     initPulseSupport();
 
+    // Starts watching memory usage
+    tabDiscardManager();
+
     QTimer::singleShot(5000, this, &MainApplication::runDeferredPostLaunchActions);
 }
 
@@ -830,6 +860,11 @@ void MainApplication::saveSettings()
         QzTools::removeRecursively(mApp->webProfile()->cachePath());
     }
 
+    if (settings.value(QSL("Browser/FullVacuumOnQuit"), false).toBool()) {
+        SqlDatabase::instance()->runWrite(&DatabaseMaintenance::fullVacuum).waitForFinished();
+        settings.setValue(QSL("Browser/FullVacuumOnQuit"), false);
+    }
+
     m_searchEnginesManager->saveSettings();
     m_plugins->shutdown();
     m_networkManager->shutdown();
@@ -1113,9 +1148,19 @@ void MainApplication::checkOptimizeDatabase()
     const int numberOfRuns = settings.value(QSL("RunsWithoutOptimizeDb"), 0).toInt();
     settings.setValue(QSL("RunsWithoutOptimizeDb"), numberOfRuns + 1);
 
-    if (numberOfRuns > 20) {
+    if (numberOfRuns > 20 && !isPrivate()) {
         std::cout << "Optimizing database..." << std::endl;
-        IconProvider::instance()->clearOldIconsInDatabase();
+        auto maintenance = new DatabaseMaintenance(this);
+        connect(maintenance, &DatabaseMaintenance::historyExpired, history(), &History::resetHistory);
+        connect(maintenance, &DatabaseMaintenance::finished, this, [=](qint64 reclaimedBytes) {
+            std::cout << "Database optimized, reclaimed " << qPrintable(QzTools::fileSizeToString(reclaimedBytes)) << std::endl;
+            // Full vacuum would block database writes, it is done on quit instead
+            if (maintenance->needsFullVacuum()) {
+                Settings().setValue(QSL("Browser/FullVacuumOnQuit"), true);
+            }
+            maintenance->deleteLater();
+        });
+        maintenance->start();
         settings.setValue(QSL("RunsWithoutOptimizeDb"), 0);
     }
 
@@ -53,6 +53,8 @@ class ProxyStyle;
 class SessionManager;
 class ClosedWindowsManager;
 class ProtocolHandlerManager;
+class MagicWandStyleCache;
+class TabDiscardManager;
 
 class FALKON_EXPORT MainApplication : public QtSingleApplication
 {
@@ -110,6 +112,8 @@ public:
     SearchEnginesManager* searchEnginesManager();
     ClosedWindowsManager* closedWindowsManager();
     ProtocolHandlerManager *protocolHandlerManager();
+    MagicWandStyleCache *magicWandStyleCache();
+    TabDiscardManager *tabDiscardManager();
     HTML5PermissionsManager* html5PermissionsManager();
     DesktopNotificationsFactory* desktopNotifications();
     QWebEngineProfile* webProfile() const;
@@ -185,6 +189,8 @@ private:
     SearchEnginesManager* m_searchEnginesManager;
     ClosedWindowsManager* m_closedWindowsManager;
     ProtocolHandlerManager *m_protocolHandlerManager;
+    MagicWandStyleCache *m_magicWandStyleCache;
+    TabDiscardManager *m_tabDiscardManager;
     HTML5PermissionsManager* m_html5PermissionsManager;
     DesktopNotificationsFactory* m_desktopNotifications;
     QWebEngineProfile* m_webProfile;
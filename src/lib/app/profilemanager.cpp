@@ -21,6 +21,8 @@
 #include "updater.h"
 #include "qztools.h"
 #include "sqldatabase.h"
+#include "history.h"
+#include "iconprovider.h"
 
 #include <QDir>
 #include <QSqlError>
@@ -310,5 +312,9 @@ void ProfileManager::connectDatabase()
         }
     }
 
+    History::setupSearchIndex(db);
+    History::setupFrecency(db);
+    IconProvider::setupDatabase(db);
+
     SqlDatabase::instance()->setDatabase(db);
 }
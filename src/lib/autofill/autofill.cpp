@@ -24,6 +24,7 @@
 #include "autofillnotification.h"
 #include "settings.h"
 #include "passwordmanager.h"
+#include "passwordbackends/passwordbackend.h"
 #include "qztools.h"
 #include "scripts.h"
 #include "webpage.h"
@@ -33,6 +34,9 @@
 #include <QWebEngineProfile>
 #include <QWebEngineScriptCollection>
 #include <QUrlQuery>
+#include <QFutureWatcher>
+
+#include <memory>
 
 AutoFill::AutoFill(QObject* parent)
     : QObject(parent)
@@ -70,7 +74,7 @@ bool AutoFill::isStored(const QUrl &url)
         return false;
     }
 
-    return !m_manager->getUsernames(url).isEmpty();
+    return m_manager->hasEntries(url);
 }
 
 bool AutoFill::isStoringEnabled(const QUrl &url)
@@ -84,16 +88,11 @@ bool AutoFill::isStoringEnabled(const QUrl &url)
         server = url.toString();
     }
 
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QStringLiteral("SELECT count(id) FROM autofill_exceptions WHERE server=?"));
-    query.addBindValue(server);
-    query.exec();
-
-    if (!query.next()) {
-        return false;
+    if (!m_exceptionsLoaded) {
+        reloadExceptions();
     }
 
-    return query.value(0).toInt() <= 0;
+    return !m_exceptions.contains(server);
 }
 
 void AutoFill::blockStoringforUrl(const QUrl &url)
@@ -107,6 +106,22 @@ void AutoFill::blockStoringforUrl(const QUrl &url)
     query.prepare(QStringLiteral("INSERT INTO autofill_exceptions (server) VALUES (?)"));
     query.addBindValue(server);
     query.exec();
+
+    m_exceptions.insert(server);
+}
+
+void AutoFill::reloadExceptions()
+{
+    m_exceptions.clear();
+
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.prepare(QStringLiteral("SELECT server FROM autofill_exceptions"));
+    query.exec();
+    while (query.next()) {
+        m_exceptions.insert(query.value(0).toString());
+    }
+
+    m_exceptionsLoaded = true;
 }
 
 QVector<PasswordEntry> AutoFill::getFormData(const QUrl &url)
@@ -217,31 +232,70 @@ void AutoFill::saveForm(WebPage *page, const QUrl &frameUrl, const PageFormData
     m_lastNotificationPage = page;
 }
 
-// Returns all saved passwords on this page
-QStringList AutoFill::completePage(WebPage *page, const QUrl &frameUrl)
+// Sets all saved usernames on this page
+void AutoFill::completePage(WebPage *page, const QUrl &frameUrl)
 {
-    QStringList usernames;
-
+    // Most pages have no saved passwords, this is answered from memory
     if (!page || !isStored(frameUrl))
-        return usernames;
+        return;
 
     if (!m_isAutoComplete) {
-        return m_manager->getUsernames(frameUrl);
+        page->setAutoFillUsernames(m_manager->getUsernames(frameUrl));
+        return;
+    }
+
+    PasswordBackend *backend = m_manager->activeBackend();
+
+    if (!backend->isThreadSafe()) {
+        completePageEntries(page, getFormData(frameUrl));
+        return;
     }
 
-    const auto entries = getFormData(frameUrl);
+    // Load and decrypt entries in database thread
+    QPointer<WebPage> webPage = page;
+    const QUrl pageUrl = page->url();
+    const int loadCount = page->loadCount();
+    auto entries = std::make_shared<QVector<PasswordEntry>>();
 
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+
+        // Page may have been destroyed or navigated in the meantime
+        if (!webPage || webPage->loadCount() != loadCount || webPage->url() != pageUrl) {
+            return;
+        }
+        completePageEntries(webPage.data(), *entries);
+    });
+    watcher->setFuture(SqlDatabase::instance()->runRead([=]() {
+        *entries = backend->getEntries(frameUrl);
+    }, SqlDatabase::HighPriority));
+}
+
+void AutoFill::completePageEntries(WebPage *page, const QVector<PasswordEntry> &entries)
+{
     if (!entries.isEmpty()) {
-        PasswordEntry entry = entries.at(0);
-        updateLastUsed(entry);
+        const PasswordEntry entry = entries.at(0);
         page->runJavaScript(Scripts::completeFormData(entry.data), WebPage::SafeJsWorld);
+
+        PasswordBackend *backend = m_manager->activeBackend();
+        if (backend->isThreadSafe()) {
+            SqlDatabase::instance()->runWrite([=]() {
+                PasswordEntry e = entry;
+                backend->updateLastUsed(e);
+            });
+        } else {
+            PasswordEntry e = entry;
+            updateLastUsed(e);
+        }
     }
 
+    QStringList usernames;
     usernames.reserve(entries.size());
     for (const PasswordEntry &entry : entries) {
         usernames.append(entry.username);
     }
-    return usernames;
+    page->setAutoFillUsernames(usernames);
 }
 
 QByteArray AutoFill::exportPasswords()
@@ -354,6 +408,7 @@ bool AutoFill::importPasswords(const QByteArray &data)
                         query.prepare(QStringLiteral("INSERT INTO autofill_exceptions (server) VALUES (?)"));
                         query.addBindValue(server);
                         query.exec();
+                        m_exceptions.insert(server);
                     }
                 }
             }
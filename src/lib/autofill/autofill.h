@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 
 #include "qzcommon.h"
 
@@ -56,6 +57,7 @@ public:
     bool isStored(const QUrl &url);
     bool isStoringEnabled(const QUrl &url);
     void blockStoringforUrl(const QUrl &url);
+    void reloadExceptions();
 
     QVector<PasswordEntry> getFormData(const QUrl &url);
     QVector<PasswordEntry> getAllFormData();
@@ -72,15 +74,20 @@ public:
     void removeAllEntries();
 
     void saveForm(WebPage *page, const QUrl &frameUrl, const PageFormData &formData);
-    QStringList completePage(WebPage *page, const QUrl &frameUrl);
+    // Usernames are set to page once saved entries are loaded
+    void completePage(WebPage *page, const QUrl &frameUrl);
 
     QByteArray exportPasswords();
     bool importPasswords(const QByteArray &data);
 
 private:
+    void completePageEntries(WebPage *page, const QVector<PasswordEntry> &entries);
+
     PasswordManager* m_manager;
     bool m_isStoring = false;
     bool m_isAutoComplete = false;
+    bool m_exceptionsLoaded = false;
+    QSet<QString> m_exceptions;
     QPointer<AutoFillNotification> m_lastNotification;
     WebPage *m_lastNotificationPage = nullptr;
 
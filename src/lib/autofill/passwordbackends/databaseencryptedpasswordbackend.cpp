@@ -130,6 +130,29 @@ QVector<PasswordEntry> DatabaseEncryptedPasswordBackend::getAllEntries()
     return list;
 }
 
+QStringList DatabaseEncryptedPasswordBackend::getHosts()
+{
+    QStringList list;
+
+    // Server is stored unencrypted, so master password is not needed
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.prepare(QSL("SELECT DISTINCT server FROM autofill_encrypted WHERE server!=?"));
+    query.addBindValue(INTERNAL_SERVER_ID);
+    query.exec();
+
+    while (query.next()) {
+        list.append(query.value(0).toString());
+    }
+
+    return list;
+}
+
+bool DatabaseEncryptedPasswordBackend::isThreadSafe() const
+{
+    // Asking for master password needs dialog in UI thread
+    return !m_askMasterPassword;
+}
+
 void DatabaseEncryptedPasswordBackend::setActive(bool active)
 {
     if (active == isActive()) {
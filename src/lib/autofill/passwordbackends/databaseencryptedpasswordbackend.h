@@ -43,6 +43,9 @@ public:
     QStringList getUsernames(const QUrl &url) override;
     QVector<PasswordEntry> getEntries(const QUrl &url) override;
     QVector<PasswordEntry> getAllEntries() override;
+    QStringList getHosts() override;
+
+    bool isThreadSafe() const override;
 
     void setActive(bool active) override;
 
@@ -80,6 +80,26 @@ QVector<PasswordEntry> DatabasePasswordBackend::getAllEntries()
     return list;
 }
 
+QStringList DatabasePasswordBackend::getHosts()
+{
+    QStringList list;
+
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.prepare(QSL("SELECT DISTINCT server FROM autofill"));
+    query.exec();
+
+    while (query.next()) {
+        list.append(query.value(0).toString());
+    }
+
+    return list;
+}
+
+bool DatabasePasswordBackend::isThreadSafe() const
+{
+    return true;
+}
+
 void DatabasePasswordBackend::addEntry(const PasswordEntry &entry)
 {
     // Data is empty only for HTTP/FTP authorization
@@ -30,6 +30,9 @@ public:
 
     QVector<PasswordEntry> getEntries(const QUrl &url) override;
     QVector<PasswordEntry> getAllEntries() override;
+    QStringList getHosts() override;
+
+    bool isThreadSafe() const override;
 
     void addEntry(const PasswordEntry &entry) override;
     bool updateEntry(const PasswordEntry &entry) override;
@@ -32,6 +32,23 @@ QStringList PasswordBackend::getUsernames(const QUrl &url)
     return out;
 }
 
+QStringList PasswordBackend::getHosts()
+{
+    QStringList out;
+    const auto entries = getAllEntries();
+    for (const PasswordEntry &entry : entries) {
+        if (!out.contains(entry.host)) {
+            out.append(entry.host);
+        }
+    }
+    return out;
+}
+
+bool PasswordBackend::isThreadSafe() const
+{
+    return false;
+}
+
 void PasswordBackend::setActive(bool active)
 {
     m_active = active;
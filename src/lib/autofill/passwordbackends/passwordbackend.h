@@ -32,6 +32,7 @@ public:
     virtual QString name() const = 0;
 
     virtual QStringList getUsernames(const QUrl &url);
+    virtual QStringList getHosts();
     virtual QVector<PasswordEntry> getEntries(const QUrl &url) = 0;
     virtual QVector<PasswordEntry> getAllEntries() = 0;
 
@@ -42,6 +43,9 @@ public:
     virtual void removeEntry(const PasswordEntry &entry) = 0;
     virtual void removeAll() = 0;
 
+    // Whether getEntries and updateLastUsed can be called from SqlDatabase threads
+    virtual bool isThreadSafe() const;
+
     virtual void setActive(bool active);
     bool isActive() const;
 
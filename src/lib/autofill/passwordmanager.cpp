@@ -61,6 +61,7 @@ QDataStream &operator >>(QDataStream &stream, PasswordEntry &entry)
 PasswordManager::PasswordManager(QObject* parent)
     : QObject(parent)
     , m_loaded(false)
+    , m_hostsLoaded(false)
     , m_backend(nullptr)
     , m_databaseBackend(new DatabasePasswordBackend)
     , m_databaseEncryptedBackend(new DatabaseEncryptedPasswordBackend)
@@ -81,6 +82,13 @@ void PasswordManager::loadSettings()
     }
     m_backend = m_backends[m_backends.contains(backendId) ? backendId : QSL("database")];
     m_backend->setActive(true);
+    m_hostsLoaded = false;
+}
+
+bool PasswordManager::hasEntries(const QUrl &url)
+{
+    ensureHostsLoaded();
+    return m_hosts.contains(createHost(url));
 }
 
 QStringList PasswordManager::getUsernames(const QUrl &url)
@@ -105,6 +113,10 @@ void PasswordManager::addEntry(const PasswordEntry &entry)
 {
     ensureLoaded();
     m_backend->addEntry(entry);
+
+    if (m_hostsLoaded) {
+        m_hosts.insert(entry.host);
+    }
 }
 
 bool PasswordManager::updateEntry(const PasswordEntry &entry)
@@ -123,12 +135,14 @@ void PasswordManager::removeEntry(const PasswordEntry &entry)
 {
     ensureLoaded();
     m_backend->removeEntry(entry);
+    m_hostsLoaded = false;
 }
 
 void PasswordManager::removeAllEntries()
 {
     ensureLoaded();
     m_backend->removeAll();
+    m_hostsLoaded = false;
 }
 
 QHash<QString, PasswordBackend*> PasswordManager::availableBackends()
@@ -157,6 +171,7 @@ void PasswordManager::switchBackend(const QString &backendID)
 
     m_backend = backend;
     m_backend->setActive(true);
+    m_hostsLoaded = false;
 
     Settings settings;
     settings.beginGroup(QSL("PasswordManager"));
@@ -183,6 +198,7 @@ void PasswordManager::unregisterBackend(PasswordBackend* backend)
 
     if (m_backend == backend) {
         m_backend = m_databaseBackend;
+        m_hostsLoaded = false;
     }
 }
 
@@ -219,6 +235,20 @@ void PasswordManager::ensureLoaded()
     }
 }
 
+void PasswordManager::ensureHostsLoaded()
+{
+    ensureLoaded();
+
+    if (!m_hostsLoaded) {
+        m_hosts.clear();
+        const QStringList hosts = m_backend->getHosts();
+        for (const QString &host : hosts) {
+            m_hosts.insert(host);
+        }
+        m_hostsLoaded = true;
+    }
+}
+
 PasswordManager::~PasswordManager()
 {
     delete m_databaseBackend;
@@ -21,6 +21,7 @@
 #include <QObject>
 #include <QUrl>
 #include <QVariant>
+#include <QSet>
 
 #include "qzcommon.h"
 
@@ -63,6 +64,9 @@ public:
 
     void loadSettings();
 
+    // Looked up in memory, without asking the backend
+    bool hasEntries(const QUrl &url);
+
     QStringList getUsernames(const QUrl &url);
     QVector<PasswordEntry> getEntries(const QUrl &url);
     QVector<PasswordEntry> getAllEntries();
@@ -86,8 +90,11 @@ public:
 
 private:
     void ensureLoaded();
+    void ensureHostsLoaded();
 
     bool m_loaded;
+    bool m_hostsLoaded;
+    QSet<QString> m_hosts;
 
     PasswordBackend* m_backend;
     DatabasePasswordBackend* m_databaseBackend;
@@ -24,6 +24,7 @@ BookmarkItem::BookmarkItem(BookmarkItem::Type type, BookmarkItem* parent)
     , m_visitCount(0)
     , m_expanded(false)
     , m_sidebarExpanded(false)
+    , m_changed(true)
 {
     if (m_parent) {
         parent->addChild(this);
@@ -43,6 +44,7 @@ BookmarkItem::Type BookmarkItem::type() const
 void BookmarkItem::setType(BookmarkItem::Type type)
 {
     m_type = type;
+    markChanged();
 }
 
 bool BookmarkItem::isFolder() const
@@ -107,6 +109,7 @@ QUrl BookmarkItem::url() const
 void BookmarkItem::setUrl(const QUrl &url)
 {
     m_url = url;
+    markChanged();
 }
 
 QString BookmarkItem::title() const
@@ -117,6 +120,7 @@ QString BookmarkItem::title() const
 void BookmarkItem::setTitle(const QString &title)
 {
     m_title = title;
+    markChanged();
 }
 
 QString BookmarkItem::description() const
@@ -127,6 +131,7 @@ QString BookmarkItem::description() const
 void BookmarkItem::setDescription(const QString &description)
 {
     m_description = description;
+    markChanged();
 }
 
 QString BookmarkItem::keyword() const
@@ -137,6 +142,7 @@ QString BookmarkItem::keyword() const
 void BookmarkItem::setKeyword(const QString &keyword)
 {
     m_keyword = keyword;
+    markChanged();
 }
 
 int BookmarkItem::visitCount() const
@@ -147,11 +153,13 @@ int BookmarkItem::visitCount() const
 void BookmarkItem::setVisitCount(int count)
 {
     m_visitCount = count;
+    markChanged();
 }
 
 void BookmarkItem::updateVisitCount()
 {
     m_visitCount++;
+    markChanged();
 }
 
 bool BookmarkItem::isExpanded() const
@@ -162,6 +170,7 @@ bool BookmarkItem::isExpanded() const
 void BookmarkItem::setExpanded(bool expanded)
 {
     m_expanded = expanded;
+    markChanged();
 }
 
 bool BookmarkItem::isSidebarExpanded() const
@@ -172,6 +181,12 @@ bool BookmarkItem::isSidebarExpanded() const
 void BookmarkItem::setSidebarExpanded(bool expanded)
 {
     m_sidebarExpanded = expanded;
+    markChanged();
+}
+
+bool BookmarkItem::isChanged() const
+{
+    return m_changed;
 }
 
 void BookmarkItem::addChild(BookmarkItem* child, int index)
@@ -188,12 +203,22 @@ void BookmarkItem::addChild(BookmarkItem* child, int index)
     else {
         m_children.insert(index, child);
     }
+    markChanged();
 }
 
 void BookmarkItem::removeChild(BookmarkItem* child)
 {
     child->m_parent = nullptr;
     m_children.removeOne(child);
+    markChanged();
+}
+
+void BookmarkItem::markChanged()
+{
+    // Parents of changed item are always marked already
+    for (BookmarkItem* item = this; item && !item->m_changed; item = item->m_parent) {
+        item->m_changed = true;
+    }
 }
 
 BookmarkItem::Type BookmarkItem::typeFromString(const QString &string)
@@ -23,6 +23,7 @@
 #include <QIcon>
 #include <QTime>
 #include <QUrl>
+#include <QVariant>
 
 #include "qzcommon.h"
 
@@ -81,6 +82,9 @@ public:
     bool isSidebarExpanded() const;
     void setSidebarExpanded(bool expanded);
 
+    // Item or its children changed since bookmarks were last saved
+    bool isChanged() const;
+
     void addChild(BookmarkItem* child, int index = -1);
     void removeChild(BookmarkItem* child);
 
@@ -88,6 +92,9 @@ public:
     static QString typeToString(Type type);
 
 private:
+    // Marks item and its parents to be serialized again
+    void markChanged();
+
     Type m_type;
     BookmarkItem* m_parent;
     QList<BookmarkItem*> m_children;
@@ -101,6 +108,12 @@ private:
     int m_visitCount;
     bool m_expanded;
     bool m_sidebarExpanded;
+
+    // Serialized children, valid while item is not changed
+    bool m_changed;
+    QVariantList m_writtenChildren;
+
+    friend class Bookmarks;
 };
 
 #endif // BOOKMARKITEM_H
@@ -19,6 +19,7 @@
 #include "bookmarkitem.h"
 #include "bookmarksmodel.h"
 #include "bookmarkstools.h"
+#include "bookmarksindex.h"
 #include "autosaver.h"
 #include "datapaths.h"
 #include "settings.h"
@@ -26,11 +27,13 @@
 
 #include <QSaveFile>
 #include <QJsonDocument>
+#include <QtConcurrent/QtConcurrentRun>
 
 static const int bookmarksVersion = 1;
 
 Bookmarks::Bookmarks(QObject* parent)
     : QObject(parent)
+    , m_index(new BookmarksIndex)
     , m_autoSaver(nullptr)
 {
     m_autoSaver = new AutoSaver(this);
@@ -43,6 +46,8 @@ Bookmarks::Bookmarks(QObject* parent)
 Bookmarks::~Bookmarks()
 {
     m_autoSaver->saveIfNecessary();
+    m_saveFuture.waitForFinished();
+    delete m_index;
     delete m_root;
 }
 
@@ -97,7 +102,7 @@ BookmarksModel* Bookmarks::model() const
 
 bool Bookmarks::isBookmarked(const QUrl &url)
 {
-    return !searchBookmarks(url).isEmpty();
+    return !m_index->itemsForUrl(url).isEmpty();
 }
 
 bool Bookmarks::canBeModified(BookmarkItem* item) const
@@ -112,23 +117,17 @@ bool Bookmarks::canBeModified(BookmarkItem* item) const
 
 QList<BookmarkItem*> Bookmarks::searchBookmarks(const QUrl &url) const
 {
-    QList<BookmarkItem*> items;
-    search(&items, m_root, url);
-    return items;
+    return m_index->itemsForUrl(url);
 }
 
 QList<BookmarkItem*> Bookmarks::searchBookmarks(const QString &string, int limit, Qt::CaseSensitivity sensitive) const
 {
-    QList<BookmarkItem*> items;
-    search(&items, m_root, string, limit, sensitive);
-    return items;
+    return m_index->search(string, limit, sensitive);
 }
 
 QList<BookmarkItem*> Bookmarks::searchKeyword(const QString &keyword) const
 {
-    QList<BookmarkItem*> items;
-    searchKeyword(&items, m_root, keyword);
-    return items;
+    return m_index->itemsForKeyword(keyword);
 }
 
 void Bookmarks::addBookmark(BookmarkItem* parent, BookmarkItem* item)
@@ -148,6 +147,7 @@ void Bookmarks::insertBookmark(BookmarkItem* parent, int row, BookmarkItem* item
 
     m_lastFolder = parent;
     m_model->addBookmark(parent, row, item);
+    m_index->addItem(item);
     emit bookmarkAdded(item);
 
     m_autoSaver->changeOccurred();
@@ -159,6 +159,7 @@ bool Bookmarks::removeBookmark(BookmarkItem* item)
         return false;
     }
 
+    m_index->removeItem(item);
     m_model->removeBookmark(item);
     emit bookmarkRemoved(item);
 
@@ -169,6 +170,7 @@ bool Bookmarks::removeBookmark(BookmarkItem* item)
 void Bookmarks::changeBookmark(BookmarkItem* item)
 {
     Q_ASSERT(item);
+    m_index->updateItem(item);
     emit bookmarkChanged(item);
 
     m_autoSaver->changeOccurred();
@@ -224,6 +226,9 @@ void Bookmarks::init()
         loadBookmarks();
     }
 
+    m_index->clear();
+    m_index->addItem(m_root);
+
     m_lastFolder = m_folderUnsorted;
     m_model = new BookmarksModel(m_root, this, this);
 }
@@ -287,6 +292,15 @@ void Bookmarks::saveBookmarks()
     map.insert(QSL("version"), bookmarksVersion);
     map.insert(QSL("roots"), bookmarksMap);
 
+    // Map is an implicitly shared snapshot, JSON conversion and writing runs in thread.
+    // Saves are serialized, so an older snapshot can't overwrite the newer one.
+    m_saveFuture.waitForFinished();
+    m_saveFuture = QtConcurrent::run(&Bookmarks::writeBookmarksFile, map, DataPaths::currentProfilePath() + QLatin1String("/bookmarks.json"));
+}
+
+// static
+void Bookmarks::writeBookmarksFile(const QVariantMap &map, const QString &fileName)
+{
     const QJsonDocument json = QJsonDocument::fromVariant(map);
     const QByteArray data = json.toJson();
 
@@ -295,7 +309,7 @@ void Bookmarks::saveBookmarks()
         return;
     }
 
-    QSaveFile file(DataPaths::currentProfilePath() + QLatin1String("/bookmarks.json"));
+    QSaveFile file(fileName);
     if (!file.open(QFile::WriteOnly)) {
         qWarning() << "Bookmarks::saveBookmarks() Error opening bookmarks file for writing!";
         return;
@@ -362,6 +376,11 @@ QVariantList Bookmarks::writeBookmarks(BookmarkItem* parent)
 {
     Q_ASSERT(parent);
 
+    // Unchanged subtree is reused from the last save
+    if (!parent->m_changed) {
+        return parent->m_writtenChildren;
+    }
+
     QVariantList list;
 
     const auto children = parent->children();
@@ -392,93 +411,12 @@ QVariantList Bookmarks::writeBookmarks(BookmarkItem* parent)
         if (!child->children().isEmpty()) {
             map.insert(QSL("children"), writeBookmarks(child));
         }
+        child->m_changed = false;
 
         list.append(map);
     }
 
+    parent->m_writtenChildren = list;
+    parent->m_changed = false;
     return list;
 }
-
-void Bookmarks::search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QUrl &url) const
-{
-    Q_ASSERT(items);
-    Q_ASSERT(parent);
-
-    switch (parent->type()) {
-    case BookmarkItem::Root:
-    case BookmarkItem::Folder: {
-        const auto children = parent->children();
-        for (BookmarkItem* child : children) {
-            search(items, child, url);
-        }
-        break;
-    }
-
-    case BookmarkItem::Url:
-        if (parent->url() == url) {
-            items->append(parent);
-        }
-        break;
-
-    default:
-        break;
-    }
-}
-
-void Bookmarks::search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &string, int limit, Qt::CaseSensitivity sensitive) const
-{
-    Q_ASSERT(items);
-    Q_ASSERT(parent);
-
-    if (limit == items->count()) {
-        return;
-    }
-
-    switch (parent->type()) {
-    case BookmarkItem::Root:
-    case BookmarkItem::Folder: {
-        const auto children = parent->children();
-        for (BookmarkItem* child : children) {
-            search(items, child, string, limit, sensitive);
-        }
-        break;
-    }
-
-    case BookmarkItem::Url:
-        if (parent->title().contains(string, sensitive) ||
-            parent->urlString().contains(string, sensitive) ||
-            parent->description().contains(string, sensitive) ||
-            parent->keyword().compare(string, sensitive) == 0
-           ) {
-            items->append(parent);
-        }
-        break;
-
-    default:
-        break;
-    }
-}
-
-void Bookmarks::searchKeyword(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &keyword) const
-{
-    Q_ASSERT(items);
-    Q_ASSERT(parent);
-
-    switch (parent->type()) {
-    case BookmarkItem::Root:
-    case BookmarkItem::Folder: {
-        const auto children = parent->children();
-        for (BookmarkItem* child : children)
-            searchKeyword(items, child, keyword);
-        break;
-    }
-
-    case BookmarkItem::Url:
-        if (parent->keyword() == keyword)
-            items->append(parent);
-        break;
-
-    default:
-        break;
-    }
-}
@@ -20,12 +20,14 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QFuture>
 
 #include "qzcommon.h"
 
 class QUrl;
 
 class BookmarkItem;
+class BookmarksIndex;
 class BookmarksModel;
 class AutoSaver;
 
@@ -90,10 +92,7 @@ private:
     void loadBookmarksFromMap(const QVariantMap &map);
     void readBookmarks(const QVariantList &list, BookmarkItem* parent);
     QVariantList writeBookmarks(BookmarkItem* parent);
-
-    void search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QUrl &url) const;
-    void search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &string, int limit, Qt::CaseSensitivity sensitive) const;
-    void searchKeyword(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &keyword) const;
+    static void writeBookmarksFile(const QVariantMap &map, const QString &fileName);
 
     BookmarkItem* m_root;
     BookmarkItem* m_folderToolbar;
@@ -102,7 +101,9 @@ private:
     BookmarkItem* m_lastFolder;
 
     BookmarksModel* m_model;
+    BookmarksIndex* m_index;
     AutoSaver* m_autoSaver;
+    QFuture<void> m_saveFuture;
 
     bool m_showOnlyIconsInToolbar;
     bool m_showOnlyTextInToolbar;
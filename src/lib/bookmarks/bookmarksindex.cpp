@@ -0,0 +1,259 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "bookmarksindex.h"
+#include "bookmarkitem.h"
+
+#include <algorithm>
+
+// Index is rebuilt when there are more removed than live entries
+static const int s_minCompactCount = 1000;
+
+BookmarksIndex::BookmarksIndex()
+    : m_removedCount(0)
+{
+}
+
+void BookmarksIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+
+    m_entries.clear();
+    m_ids.clear();
+    m_removedCount = 0;
+    m_urls.clear();
+    m_keywords.clear();
+    m_trigrams.clear();
+}
+
+void BookmarksIndex::addItem(BookmarkItem* item)
+{
+    QWriteLocker locker(&m_lock);
+    addItemInternal(item);
+}
+
+void BookmarksIndex::removeItem(BookmarkItem* item)
+{
+    QWriteLocker locker(&m_lock);
+    removeItemInternal(item);
+
+    if (m_removedCount > s_minCompactCount && m_removedCount > m_ids.count()) {
+        compact();
+    }
+}
+
+void BookmarksIndex::updateItem(BookmarkItem* item)
+{
+    if (!item->isUrl()) {
+        return;
+    }
+
+    QWriteLocker locker(&m_lock);
+    removeItemInternal(item);
+    addItemInternal(item);
+}
+
+QList<BookmarkItem*> BookmarksIndex::itemsForUrl(const QUrl &url) const
+{
+    QReadLocker locker(&m_lock);
+
+    // Multi-hash iterates from the last inserted item
+    QList<BookmarkItem*> items;
+    auto it = m_urls.constFind(url);
+    while (it != m_urls.constEnd() && it.key() == url) {
+        items.prepend(m_entries.at(it.value()).item);
+        ++it;
+    }
+    return items;
+}
+
+QList<BookmarkItem*> BookmarksIndex::itemsForKeyword(const QString &keyword) const
+{
+    QReadLocker locker(&m_lock);
+
+    QList<BookmarkItem*> items;
+    const QString key = keyword.toCaseFolded();
+    auto it = m_keywords.constFind(key);
+    while (it != m_keywords.constEnd() && it.key() == key) {
+        const Entry &entry = m_entries.at(it.value());
+        if (entry.keyword == keyword) {
+            items.prepend(entry.item);
+        }
+        ++it;
+    }
+    return items;
+}
+
+QList<BookmarkItem*> BookmarksIndex::search(const QString &string, int limit, Qt::CaseSensitivity sensitive) const
+{
+    QList<BookmarkItem*> items;
+    const QVector<quint64> keys = trigrams(string.toCaseFolded());
+
+    QReadLocker locker(&m_lock);
+
+    // Strings shorter than trigram are matched against all entries
+    if (keys.isEmpty()) {
+        for (const Entry &entry : qAsConst(m_entries)) {
+            if (limit == items.count()) {
+                break;
+            }
+            if (entry.item && matches(entry, string, sensitive)) {
+                items.append(entry.item);
+            }
+        }
+        return items;
+    }
+
+    // Intersect posting lists starting from the shortest one
+    QVector<const QVector<int>*> lists;
+    lists.reserve(keys.size());
+    for (quint64 key : keys) {
+        const auto it = m_trigrams.constFind(key);
+        if (it == m_trigrams.constEnd()) {
+            return items;
+        }
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> ids = *lists.at(0);
+    for (int i = 1; i < lists.size() && !ids.isEmpty(); ++i) {
+        QVector<int> intersection;
+        std::set_intersection(ids.constBegin(), ids.constEnd(), lists.at(i)->constBegin(), lists.at(i)->constEnd(), std::back_inserter(intersection));
+        ids = intersection;
+    }
+
+    // Trigrams only narrow down candidates, match is verified on the entry
+    for (int id : qAsConst(ids)) {
+        if (limit == items.count()) {
+            break;
+        }
+        const Entry &entry = m_entries.at(id);
+        if (entry.item && matches(entry, string, sensitive)) {
+            items.append(entry.item);
+        }
+    }
+
+    return items;
+}
+
+void BookmarksIndex::addItemInternal(BookmarkItem* item)
+{
+    const auto children = item->children();
+    for (BookmarkItem* child : children) {
+        addItemInternal(child);
+    }
+
+    if (!item->isUrl() || m_ids.contains(item)) {
+        return;
+    }
+
+    addEntry(Entry{item, item->url(), item->urlString(), item->title(), item->description(), item->keyword()});
+}
+
+void BookmarksIndex::addEntry(const Entry &entry)
+{
+    // Ids are increasing, so posting lists stay sorted
+    const int id = m_entries.count();
+    m_entries.append(entry);
+    m_ids.insert(entry.item, id);
+
+    m_urls.insert(entry.url, id);
+    if (!entry.keyword.isEmpty()) {
+        m_keywords.insert(entry.keyword.toCaseFolded(), id);
+    }
+
+    const QString text = QStringList({entry.title, entry.urlString, entry.description, entry.keyword}).join(QL1C('\n'));
+    const QVector<quint64> keys = trigrams(text.toCaseFolded());
+    for (quint64 key : keys) {
+        m_trigrams[key].append(id);
+    }
+}
+
+void BookmarksIndex::removeItemInternal(BookmarkItem* item)
+{
+    const auto children = item->children();
+    for (BookmarkItem* child : children) {
+        removeItemInternal(child);
+    }
+
+    const int id = m_ids.value(item, -1);
+    if (id == -1) {
+        return;
+    }
+
+    const Entry &entry = m_entries.at(id);
+    m_urls.remove(entry.url, id);
+    m_keywords.remove(entry.keyword.toCaseFolded(), id);
+
+    // Posting lists still contain the id, it is skipped in search
+    m_entries[id] = Entry();
+    m_ids.remove(item);
+    m_removedCount++;
+}
+
+void BookmarksIndex::compact()
+{
+    // Rebuilt from copied data, order of entries is kept
+    QVector<Entry> entries;
+    entries.reserve(m_ids.count());
+    for (const Entry &entry : qAsConst(m_entries)) {
+        if (entry.item) {
+            entries.append(entry);
+        }
+    }
+
+    m_entries.clear();
+    m_ids.clear();
+    m_removedCount = 0;
+    m_urls.clear();
+    m_keywords.clear();
+    m_trigrams.clear();
+
+    for (const Entry &entry : qAsConst(entries)) {
+        addEntry(entry);
+    }
+}
+
+// static
+bool BookmarksIndex::matches(const Entry &entry, const QString &string, Qt::CaseSensitivity sensitive)
+{
+    return entry.title.contains(string, sensitive) ||
+           entry.urlString.contains(string, sensitive) ||
+           entry.description.contains(string, sensitive) ||
+           entry.keyword.compare(string, sensitive) == 0;
+}
+
+// static
+QVector<quint64> BookmarksIndex::trigrams(const QString &text)
+{
+    QVector<quint64> keys;
+    if (text.size() < 3) {
+        return keys;
+    }
+
+    keys.reserve(text.size() - 2);
+    for (int i = 0; i < text.size() - 2; ++i) {
+        keys.append(quint64(text.at(i).unicode()) << 32 | quint64(text.at(i + 1).unicode()) << 16 | text.at(i + 2).unicode());
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
@@ -0,0 +1,89 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef BOOKMARKSINDEX_H
+#define BOOKMARKSINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QUrl>
+#include <QReadWriteLock>
+
+#include "qzcommon.h"
+
+class BookmarkItem;
+
+// In-memory index of url bookmarks for url, keyword and text lookups.
+// Lookups may run from other threads (location completer), modifications
+// are done in UI thread. Lookups only match against data copied into the
+// index and never access the items, returned items may be used in UI thread.
+class FALKON_EXPORT BookmarksIndex
+{
+public:
+    explicit BookmarksIndex();
+
+    void clear();
+
+    // Adds item and all its children
+    void addItem(BookmarkItem* item);
+    // Removes item and all its children
+    void removeItem(BookmarkItem* item);
+    // Reindexes item after its data changed
+    void updateItem(BookmarkItem* item);
+
+    QList<BookmarkItem*> itemsForUrl(const QUrl &url) const;
+    QList<BookmarkItem*> itemsForKeyword(const QString &keyword) const;
+
+    // Items with title, url, description containing string or with equal keyword
+    QList<BookmarkItem*> search(const QString &string, int limit, Qt::CaseSensitivity sensitive) const;
+
+private:
+    // Copy of item data, item is null for removed entries
+    struct Entry {
+        BookmarkItem* item;
+        QUrl url;
+        QString urlString;
+        QString title;
+        QString description;
+        QString keyword;
+    };
+
+    void addItemInternal(BookmarkItem* item);
+    void addEntry(const Entry &entry);
+    void removeItemInternal(BookmarkItem* item);
+    void compact();
+
+    static bool matches(const Entry &entry, const QString &string, Qt::CaseSensitivity sensitive);
+
+    static QVector<quint64> trigrams(const QString &text);
+
+    // Entry id is its position, removed entries are left empty until compact()
+    QVector<Entry> m_entries;
+    QHash<BookmarkItem*, int> m_ids;
+    int m_removedCount;
+
+    QMultiHash<QUrl, int> m_urls;
+    // Case folded keyword to entry ids
+    QMultiHash<QString, int> m_keywords;
+    // Sorted ids of entries containing trigram
+    QHash<quint64, QVector<int>> m_trigrams;
+
+    mutable QReadWriteLock m_lock;
+};
+
+#endif // BOOKMARKSINDEX_H
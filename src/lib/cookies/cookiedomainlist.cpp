@@ -0,0 +1,116 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "cookiedomainlist.h"
+
+CookieDomainList::CookieDomainList()
+{
+    m_terminal.append(false);
+}
+
+CookieDomainList::CookieDomainList(const QStringList &domains)
+    : CookieDomainList()
+{
+    for (const QString &domain : domains) {
+        addDomain(domain);
+    }
+}
+
+bool CookieDomainList::isEmpty() const
+{
+    return m_terminal.size() == 1;
+}
+
+void CookieDomainList::addDomain(const QString &domain)
+{
+    const int start = domain.startsWith(QL1C('.')) ? 1 : 0;
+    if (start >= domain.size()) {
+        return;
+    }
+
+    int node = 0;
+    int end = domain.size();
+
+    while (true) {
+        int dot = end > start ? domain.lastIndexOf(QL1C('.'), end - 1) : -1;
+        if (dot < start) {
+            dot = start - 1;
+        }
+
+        const QPair<int, quint64> edge(node, labelHash(domain, dot + 1, end));
+        auto it = m_edges.constFind(edge);
+        if (it == m_edges.constEnd()) {
+            m_terminal.append(false);
+            it = m_edges.insert(edge, m_terminal.size() - 1);
+        }
+        node = it.value();
+
+        if (dot < start) {
+            break;
+        }
+        end = dot;
+    }
+
+    m_terminal[node] = true;
+}
+
+bool CookieDomainList::matches(const QString &domain) const
+{
+    const int start = domain.startsWith(QL1C('.')) ? 1 : 0;
+    if (start >= domain.size() || isEmpty()) {
+        return false;
+    }
+
+    int node = 0;
+    int end = domain.size();
+
+    while (true) {
+        int dot = end > start ? domain.lastIndexOf(QL1C('.'), end - 1) : -1;
+        if (dot < start) {
+            dot = start - 1;
+        }
+
+        const auto it = m_edges.constFind(qMakePair(node, labelHash(domain, dot + 1, end)));
+        if (it == m_edges.constEnd()) {
+            return false;
+        }
+        node = it.value();
+
+        // Listed domain is suffix of tested domain ending at label boundary
+        if (m_terminal.at(node)) {
+            return true;
+        }
+
+        if (dot < start) {
+            return false;
+        }
+        end = dot;
+    }
+}
+
+// static
+quint64 CookieDomainList::labelHash(const QString &domain, int start, int end)
+{
+    // 64-bit FNV-1a, same as AdBlockRequest::domainHash
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    const QChar *data = domain.constData();
+    for (int i = start; i < end; ++i) {
+        hash ^= data[i].unicode();
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
@@ -0,0 +1,49 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef COOKIEDOMAINLIST_H
+#define COOKIEDOMAINLIST_H
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QStringList>
+
+#include "qzcommon.h"
+
+// List of domains matching also all their subdomains (RFC 6265 domain matching),
+// stored as trie of reversed labels so lookup only walks labels of tested domain
+class FALKON_EXPORT CookieDomainList
+{
+public:
+    CookieDomainList();
+    explicit CookieDomainList(const QStringList &domains);
+
+    bool isEmpty() const;
+
+    void addDomain(const QString &domain);
+    bool matches(const QString &domain) const;
+
+private:
+    static quint64 labelHash(const QString &domain, int start, int end);
+
+    // (parent node, label hash) -> child node, node 0 is root
+    QHash<QPair<int, quint64>, int> m_edges;
+    QVector<bool> m_terminal;
+};
+
+#endif // COOKIEDOMAINLIST_H
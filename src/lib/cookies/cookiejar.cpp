@@ -29,6 +29,13 @@
 
 //#define COOKIE_DEBUG
 
+CookieJar::CookieKey::CookieKey(const QNetworkCookie &cookie)
+    : domain(cookie.domain())
+    , path(cookie.path())
+    , name(cookie.name())
+{
+}
+
 CookieJar::CookieJar(QObject* parent)
     : QObject(parent)
     , m_client(mApp->webProfile()->cookieStore())
@@ -58,9 +65,13 @@ void CookieJar::loadSettings()
     m_allowCookies = settings.value("allowCookies", true).toBool();
     m_filterThirdParty = settings.value("filterThirdPartyCookies", false).toBool();
     m_filterTrackingCookie = settings.value("filterTrackingCookie", false).toBool();
-    m_whitelist = settings.value("whitelist", QStringList()).toStringList();
-    m_blacklist = settings.value("blacklist", QStringList()).toStringList();
+    const CookieDomainList whitelist(settings.value("whitelist", QStringList()).toStringList());
+    const CookieDomainList blacklist(settings.value("blacklist", QStringList()).toStringList());
     settings.endGroup();
+
+    QWriteLocker locker(&m_listsLock);
+    m_whitelist = whitelist;
+    m_blacklist = blacklist;
 }
 
 void CookieJar::setAllowCookies(bool allow)
@@ -75,18 +86,26 @@ void CookieJar::deleteCookie(const QNetworkCookie &cookie)
 
 QVector<QNetworkCookie> CookieJar::getAllCookies() const
 {
-    return m_cookies;
+    QVector<QNetworkCookie> cookies;
+    cookies.reserve(m_cookies.size());
+    for (const QNetworkCookie &cookie : m_cookies) {
+        cookies.append(cookie);
+    }
+    return cookies;
 }
 
 void CookieJar::deleteAllCookies(bool deleteAll)
 {
+    QReadLocker locker(&m_listsLock);
+
     if (deleteAll || m_whitelist.isEmpty()) {
         m_client->deleteAllCookies();
         return;
     }
 
+    // Removals are signalled asynchronously, m_cookies is not changed while iterating
     for (const QNetworkCookie &cookie : qAsConst(m_cookies)) {
-        if (!listMatchesDomain(m_whitelist, cookie.domain())) {
+        if (!m_whitelist.matches(cookie.domain())) {
             m_client->deleteCookie(cookie);
         }
     }
@@ -108,15 +127,9 @@ bool CookieJar::matchDomain(QString cookieDomain, QString siteDomain) const
     return QzTools::matchDomain(cookieDomain, siteDomain);
 }
 
-bool CookieJar::listMatchesDomain(const QStringList &list, const QString &cookieDomain) const
+bool CookieJar::listMatchesDomain(const CookieDomainList &list, const QString &cookieDomain) const
 {
-    for (const QString &d : list) {
-        if (matchDomain(d, cookieDomain)) {
-            return true;
-        }
-    }
-
-    return false;
+    return list.matches(cookieDomain);
 }
 
 void CookieJar::slotCookieAdded(const QNetworkCookie &cookie)
@@ -126,19 +139,37 @@ void CookieJar::slotCookieAdded(const QNetworkCookie &cookie)
         return;
     }
 
-    m_cookies.append(cookie);
+    const CookieKey key(cookie);
+    auto it = m_cookies.find(key);
+    if (it != m_cookies.end()) {
+        if (it.value() == cookie) {
+            return;
+        }
+        // Overwritten cookie, its removal may be signalled only after this
+        const QNetworkCookie old = it.value();
+        it.value() = cookie;
+        emit cookieRemoved(old);
+    } else {
+        m_cookies.insert(key, cookie);
+    }
+
     emit cookieAdded(cookie);
 }
 
 void CookieJar::slotCookieRemoved(const QNetworkCookie &cookie)
 {
-    if (m_cookies.removeOne(cookie))
+    auto it = m_cookies.find(CookieKey(cookie));
+    if (it != m_cookies.end() && it.value() == cookie) {
+        m_cookies.erase(it);
         emit cookieRemoved(cookie);
+    }
 }
 
 #if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 11, 0)
 bool CookieJar::cookieFilter(const QWebEngineCookieStore::FilterRequest &request) const
 {
+    QReadLocker locker(&m_listsLock);
+
     if (!m_allowCookies) {
         bool result = listMatchesDomain(m_whitelist, request.origin.host());
         if (!result) {
@@ -174,6 +205,8 @@ bool CookieJar::rejectCookie(const QString &domain, const QNetworkCookie &cookie
 {
     Q_UNUSED(domain)
 
+    QReadLocker locker(&m_listsLock);
+
     if (!m_allowCookies) {
         bool result = listMatchesDomain(m_whitelist, cookieDomain);
         if (!result) {
@@ -18,12 +18,15 @@
 #ifndef COOKIEJAR_H
 #define COOKIEJAR_H
 
+#include <QHash>
 #include <QVector>
 #include <QStringList>
+#include <QReadWriteLock>
 #include <QWebEngineCookieStore>
 #include <QtWebEngineWidgetsVersion>
 
 #include "qzcommon.h"
+#include "cookiedomainlist.h"
 
 class AutoSaver;
 
@@ -50,9 +53,26 @@ Q_SIGNALS:
 
 protected:
     bool matchDomain(QString cookieDomain, QString siteDomain) const;
-    bool listMatchesDomain(const QStringList &list, const QString &cookieDomain) const;
+    bool listMatchesDomain(const CookieDomainList &list, const QString &cookieDomain) const;
 
 private:
+    // Cookies are unique by domain, path and name
+    struct CookieKey {
+        QString domain;
+        QString path;
+        QByteArray name;
+
+        explicit CookieKey(const QNetworkCookie &cookie);
+
+        bool operator==(const CookieKey &other) const {
+            return name == other.name && domain == other.domain && path == other.path;
+        }
+
+        friend uint qHash(const CookieKey &key, uint seed = 0) {
+            return qHash(key.domain, seed) ^ qHash(key.path, seed) ^ qHash(key.name, seed);
+        }
+    };
+
     void slotCookieAdded(const QNetworkCookie &cookie);
     void slotCookieRemoved(const QNetworkCookie &cookie);
 
@@ -67,11 +87,13 @@ private:
     bool m_filterTrackingCookie;
     bool m_filterThirdParty;
 
-    QStringList m_whitelist;
-    QStringList m_blacklist;
+    // Lists are accessed also from cookie filter on IO thread
+    mutable QReadWriteLock m_listsLock;
+    CookieDomainList m_whitelist;
+    CookieDomainList m_blacklist;
 
     QWebEngineCookieStore *m_client;
-    QVector<QNetworkCookie> m_cookies;
+    QHash<CookieKey, QNetworkCookie> m_cookies;
 };
 
 #endif // COOKIEJAR_H
@@ -1,5 +1,8 @@
 -- Falkon browsedata.db
 
+-- Needs to be set before creating tables
+PRAGMA auto_vacuum = INCREMENTAL;
+
 -- Tables
 CREATE TABLE autofill (
     id INTEGER PRIMARY KEY,
@@ -32,9 +35,11 @@ CREATE TABLE history (
     url TEXT NOT NULL,
     title TEXT,
     date INTEGER DEFAULT 0 NOT NULL,
-    count INTEGER DEFAULT 0 NOT NULL
+    count INTEGER DEFAULT 0 NOT NULL,
+    frecency REAL DEFAULT 0 NOT NULL
 );
 CREATE INDEX history_titleindex ON history (title);
+CREATE INDEX history_frecencyindex ON history (frecency);
 CREATE UNIQUE INDEX history_urluniqueindex ON history (url);
 
 CREATE TABLE search_engines (
@@ -51,8 +56,18 @@ CREATE TABLE search_engines (
 CREATE TABLE icons (
     id INTEGER PRIMARY KEY,
     url TEXT NOT NULL,
-    icon BLOB
+    host TEXT NOT NULL,
+    data_id INTEGER NOT NULL
 );
 CREATE UNIQUE INDEX icons_urluniqueindex ON icons (url);
+CREATE INDEX icons_hostindex ON icons (host);
+CREATE INDEX icons_dataindex ON icons (data_id);
+
+CREATE TABLE icon_data (
+    id INTEGER PRIMARY KEY,
+    hash BLOB NOT NULL,
+    icon BLOB NOT NULL
+);
+CREATE UNIQUE INDEX icon_data_hashuniqueindex ON icon_data (hash);
 
 -- Data
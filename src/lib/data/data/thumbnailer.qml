@@ -6,13 +6,18 @@ WebEngineView {
     width: 1280
     height: 720
 
+    // Set by PageThumbnailer for each loaded url
+    property int requestId: 0
+
     onLoadingChanged: {
         if (loadRequest.status == WebEngineView.LoadStartedStatus)
             return;
 
         var ok = loadRequest.status == WebEngineView.LoadSucceededStatus;
+        var url = loadRequest.url;
+        var id = view.requestId;
         view.runJavaScript(thumbnailer.afterLoadScript(), function() {
-            thumbnailer.createThumbnail(ok);
+            thumbnailer.createThumbnail(ok, url, id);
         });
     }
 }
@@ -0,0 +1,437 @@
+// Transparency theming engine, injected by WebPage::finished()
+//
+// Elements are themed once when they appear and again only when their
+// class or inline style changes. Work is batched per animation frame,
+// time-boxed and suspended while the page is hidden. Mutations made while
+// hidden only mark their nodes dirty, they are themed once visible again.
+//
+// Decisions made for elements identified by tag, id and class are
+// recorded and persisted per origin by MagicWandStyleCache. On later
+// visits the cached stylesheet is applied at document creation and
+// elements it covers are skipped here.
+
+(function() {
+
+if (window._falkon_magicwand)
+    return;
+
+var FRAME_BUDGET = 8;
+
+var colorCache = new Map();
+var nodeCache = new WeakMap();
+var pending = new Set();
+// Node -> whether its subtree is dirty, collected while page is hidden
+var dirty = new Map();
+var frameRequested = false;
+var stats = { busy: 0, passes: 0, elements: 0, covered: 0 };
+
+var ENGINE_CLASSES = ["trans", "quaz", "bblur"];
+var cached = window._falkon_magicwand_cache || { selectors: new Set(), trans: new Set() };
+var themed = new WeakSet();
+var recorded = new Map();
+var decision = null;
+
+var style = document.createElement("style");
+style.innerHTML = "body,html,.darkmode-background,.darkmode-layer,html,.trans:not(.quaz),html[dark]{background:transparent !important;}::-webkit-scrollbar {    background-color:#ffffff00;    width:8px;height:8px;}::-webkit-scrollbar-track {    background-color:#ffffff00;width:16px;height:16px;}::-webkit-scrollbar-thumb {    background-color:#babac080;    border-radius:8px;    border:4px solid transparent}::-webkit-scrollbar-button {display:none} .bblur{background:rgba(49, 49, 58,0.2) !important;}";
+(document.body || document.documentElement).append(style);
+
+// Computed colors are parsed once per distinct value
+function parseColor(c)
+{
+    var q = colorCache.get(c);
+    if (q === undefined) {
+        var m = c.match(/\d+/g);
+        q = m ? m.map(parseFloat) : null;
+        colorCache.set(c, q);
+    }
+    return q;
+}
+
+// Background color of element, valid until the element is modified
+function backgroundColor(el)
+{
+    var q = nodeCache.get(el);
+    if (q === undefined) {
+        q = parseColor(window.getComputedStyle(el, null).getPropertyValue("background-color"));
+        nodeCache.set(el, q);
+    }
+    return q;
+}
+
+function applyStyle(el, property, value)
+{
+    el.style[property] = value;
+    if (decision) {
+        decision[property] = value;
+    }
+}
+
+function setStyle(el, property, value)
+{
+    applyStyle(el, property, value);
+    nodeCache.delete(el);
+}
+
+function addClass(el, name)
+{
+    if (!el.classList.contains(name)) {
+        el.classList.add(name);
+        nodeCache.delete(el);
+    }
+}
+
+// Elements covered by cached stylesheet carry no marker classes
+function isTrans(el)
+{
+    if (el.classList.contains("trans")) {
+        return true;
+    }
+    if (!cached.trans.size || themed.has(el)) {
+        return false;
+    }
+    return cached.trans.has(selectorFor(el));
+}
+
+function getBkColor(el)
+{
+    var q = backgroundColor(el);
+    if (q) {
+        return q.length < 4 ? q.concat([1]) : q;
+    }
+    return [0, 0, 0, 0];
+}
+
+function bkInfluence(e)
+{
+    if (!e.parentElement) {
+        return 0;
+    }
+    var a = getBkColor(e);
+    var b = getBkColor(e.parentElement);
+    var diff = [Math.abs(a[0] - b[0]) / 255, Math.abs(a[1] - b[1]) / 255, Math.abs(a[2] - b[2]) / 255];
+    return (diff[0] + diff[2] + diff[2]) * a[3] / 3;
+}
+
+function shouldT(e)
+{
+    var cc = backgroundColor(e);
+    if (cc) {
+        var tcond = (!(cc.length > 3 && cc[3] < 0.25) || isTrans(e));
+        if (cc[0] + cc[1] + cc[2] > 127 * 3 || tcond) {
+            if (tcond && e.parentElement) {
+                return !shouldT(e.parentElement);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+function colorWild(color)
+{
+    var ave = (color[0] + color[1] + color[2]) / 255 / 3;
+    return (color.slice(0, 3).map(x => (x / 255 - ave) ** 2).reduce((a, b) => a + b) / 2) ** 0.5;
+}
+
+function wildBackground(cc)
+{
+    return "rgba(" + cc[0] + "," + cc[1] + "," + cc[2] + "," + Math.max(colorWild(cc), 0) + ")";
+}
+
+var borders = [
+    ["border-left-color", "borderLeftColor"],
+    ["border-right-color", "borderRightColor"],
+    ["border-top-color", "borderTopColor"],
+    ["border-bottom-color", "borderBottomColor"]
+];
+
+function themeElement(e)
+{
+    if (!e.style) {
+        return;
+    }
+
+    var computed = window.getComputedStyle(e, null);
+    var bi = computed.getPropertyValue("background-image");
+    var cd = computed.getPropertyValue("position");
+    var cc = backgroundColor(e);
+
+    if (cc) {
+        if (cc[0] + cc[1] + cc[2] < 127 * 3 / 4) {
+            setStyle(e, "backgroundColor", "rgba(0,0,0,0)");
+            if (!(cc.length > 3 && cc[3] < 0.25)) {
+                addClass(e, "trans");
+            }
+        }
+        if (e.classList.contains("docos-avatar")) {
+            applyStyle(e, "zIndex", "1"); // fix google doc avatar
+        }
+        if (shouldT(e) || (bkInfluence(e) < 1 / 3 || cc[0] + cc[1] + cc[2] > 127 * 3 || (e.style.backgroundImage.substring(0, "linear-gradient".length) == "linear-gradient"))) {
+            setStyle(e, "backgroundColor", wildBackground(cc));
+            if (cc.length < 4 && colorWild(cc) > 0.125) {
+                addClass(e, "quaz");
+            }
+            if (!(cc.length > 3 && cc[3] < 0.25)) {
+                addClass(e, "trans");
+            }
+            if (!(bi.length > 3 && (bi.substring(0, 3) === "non"))) {
+                if (bi.match("gradient") || e.webkitMatchesSelector(".vectorTabs li")) {
+                    setStyle(e, "backgroundImage", "none");
+                }
+            }
+
+            var tcond = (!(cc.length > 3 && cc[3] < 0.25) || e.classList.contains("trans"));
+            if (tcond || e.tagName.toLowerCase() !== "span" || !e.webkitMatchesSelector("pre code span")) {
+                applyStyle(e, "color", "rgba(255,255,255,1)");
+            }
+            var nt = bkInfluence(e) > 1 / 2 || e.style.boxShadow != "none";
+            if (tcond && ((cd === "absolute" || cd === "fixed" || cd === "sticky" || !(e.parentElement && shouldT(e.parentElement))) || (nt && !(e.parentElement && shouldT(e.parentElement))))) {
+                if ((!(e.parentElement && e.parentElement.innerText && e.parentElement.innerText.length < e.innerText.length + 2) || nt) &&
+                    (!e.webkitMatchesSelector("ytd-app,ytd-watch-flexy"))) {
+                    addClass(e, "bblur");
+                    applyStyle(e, "backdropFilter", "opacity(" + (1 - Math.abs((cc[0] + cc[1] + cc[2]) / 255 / 3 - 0.5) / 5 * 2) + ") blur(5px)");
+                    if (cc.length < 4) {
+                        setStyle(e, "backgroundColor", wildBackground(cc));
+                        if (colorWild(cc) > 0.125) {
+                            addClass(e, "quaz");
+                        }
+                    }
+                    applyStyle(e, "boxShadow", "none");
+                }
+            }
+        }
+    }
+
+    for (var i = 0; i < borders.length; ++i) {
+        var bc = parseColor(computed.getPropertyValue(borders[i][0]));
+        if (bc && bc[0] + bc[1] + bc[2] > 127 * 3 && (bc.length < 4 || bc[3] > 0.25)) {
+            applyStyle(e, borders[i][1], "rgb(255,255,255)");
+        }
+    }
+}
+
+// Selector matching exactly this element's tag, id and class attribute,
+// null when element is not specific enough or was already modified
+function selectorFor(el)
+{
+    var cls = el.getAttribute("class");
+    if (!el.id && !cls) {
+        return null;
+    }
+    if (cls) {
+        var tokens = Array.from(el.classList);
+        if (tokens.join(" ") !== cls || tokens.some(t => ENGINE_CLASSES.indexOf(t) != -1)) {
+            return null;
+        }
+    }
+    // [class=""] doesn't match elements without class attribute
+    var clsSelector = cls === null ? ":not([class])" : "[class=\"" + CSS.escape(cls) + "\"]";
+    return el.localName + (el.id ? "#" + CSS.escape(el.id) : "") + clsSelector;
+}
+
+function cssProperty(property)
+{
+    return property.replace(/[A-Z]/g, c => "-" + c.toLowerCase());
+}
+
+// Declarations reproducing the decision, including effect of marker classes
+function decisionStyle(e, d)
+{
+    var out = [];
+    var trans = e.classList.contains("trans") && !e.classList.contains("quaz");
+    var blur = e.classList.contains("bblur");
+    if (trans) {
+        out.push("background:transparent !important");
+    } else if (blur) {
+        out.push("background:rgba(49, 49, 58,0.2) !important");
+    }
+    for (var property in d) {
+        if ((trans || blur) && (property === "backgroundColor" || property === "backgroundImage")) {
+            continue;
+        }
+        out.push(cssProperty(property) + ":" + d[property] + " !important");
+    }
+    return out.join(";");
+}
+
+// Same selector with different decisions can't be cached
+function record(selector, e, d)
+{
+    var value = (e.classList.contains("trans") ? "1" : "0") + decisionStyle(e, d);
+    var previous = recorded.get(selector);
+    if (previous === undefined) {
+        recorded.set(selector, value);
+    } else if (previous !== value) {
+        recorded.set(selector, null);
+    }
+}
+
+function processElement(e)
+{
+    if (themed.has(e)) {
+        themeElement(e);
+        return;
+    }
+
+    var selector = selectorFor(e);
+    if (selector && cached.selectors.has(selector)) {
+        ++stats.covered;
+        return;
+    }
+
+    themed.add(e);
+    decision = {};
+    themeElement(e);
+    if (selector) {
+        record(selector, e, decision);
+    }
+    decision = null;
+}
+
+function enqueue(node, subtree)
+{
+    if (node.nodeType !== Node.ELEMENT_NODE) {
+        return;
+    }
+    nodeCache.delete(node);
+    pending.add(node);
+    if (subtree) {
+        var all = node.getElementsByTagName("*");
+        for (var i = 0; i < all.length; ++i) {
+            nodeCache.delete(all[i]);
+            pending.add(all[i]);
+        }
+    }
+}
+
+function markDirty(node, subtree)
+{
+    if (node.nodeType === Node.ELEMENT_NODE) {
+        dirty.set(node, subtree || dirty.get(node) === true);
+    }
+}
+
+function schedule()
+{
+    if (frameRequested || document.hidden || !pending.size) {
+        return;
+    }
+    frameRequested = true;
+    window.requestAnimationFrame(flush);
+}
+
+function flush()
+{
+    frameRequested = false;
+    if (document.hidden) {
+        return;
+    }
+
+    var start = performance.now();
+    for (var e of pending) {
+        pending.delete(e);
+        if (e.isConnected) {
+            processElement(e);
+            ++stats.elements;
+        }
+        if (performance.now() - start > FRAME_BUDGET) {
+            break;
+        }
+    }
+
+    // Drop records caused by our own style changes
+    observer.takeRecords();
+
+    stats.busy += performance.now() - start;
+    ++stats.passes;
+    schedule();
+}
+
+var observer = new MutationObserver(function(mutations) {
+    var add = document.hidden ? markDirty : enqueue;
+    for (var i = 0; i < mutations.length; ++i) {
+        var m = mutations[i];
+        if (m.type === "childList") {
+            for (var j = 0; j < m.addedNodes.length; ++j) {
+                add(m.addedNodes[j], true);
+            }
+        } else {
+            // Class change may restyle whole subtree, inline style only the element
+            add(m.target, m.attributeName === "class");
+        }
+    }
+    schedule();
+});
+
+function observe()
+{
+    observer.observe(document.documentElement, {
+        childList: true,
+        subtree: true,
+        attributes: true,
+        attributeFilter: ["class", "style"]
+    });
+}
+
+document.addEventListener("visibilitychange", function() {
+    if (document.hidden) {
+        return;
+    }
+    // Only subtrees changed while hidden are themed again
+    for (var [node, subtree] of dirty) {
+        if (node.isConnected) {
+            enqueue(node, subtree);
+        }
+    }
+    dirty.clear();
+    schedule();
+});
+
+// Late stylesheets change computed colors without any DOM mutation
+document.addEventListener("load", function(event) {
+    var t = event.target;
+    if (t.tagName === "LINK" && t.rel === "stylesheet") {
+        if (document.hidden) {
+            markDirty(document.documentElement, true);
+            return;
+        }
+        enqueue(document.documentElement, true);
+        schedule();
+    }
+}, true);
+
+window._falkon_magicwand = {
+    stats: function() {
+        return {
+            busy: stats.busy,
+            passes: stats.passes,
+            elements: stats.elements,
+            covered: stats.covered,
+            pending: pending.size,
+            dirty: dirty.size
+        };
+    },
+    // Returns decisions recorded since last call
+    decisions: function() {
+        var out = [];
+        for (var [selector, value] of recorded) {
+            if (value === null) {
+                out.push({ selector: selector, conflict: true });
+            } else {
+                out.push({ selector: selector, trans: value[0] === "1", style: value.substring(1) });
+            }
+        }
+        recorded.clear();
+        return out;
+    }
+};
+
+observe();
+if (document.hidden) {
+    markDirty(document.documentElement, true);
+} else {
+    enqueue(document.documentElement, true);
+    schedule();
+}
+
+})();
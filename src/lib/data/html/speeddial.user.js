@@ -124,6 +124,11 @@ function onEditClick(box) {
     $('#formUrl').focus().val('').val(temp); // focus and move cursor to end
 }
 
+function isVisible(element) {
+    var rect = element.getBoundingClientRect();
+    return rect.bottom > 0 && rect.top < window.innerHeight;
+}
+
 function onReloadClick(box) {
     var url = $(box).children('a').first().attr('href');
     var img = $(box).children('img').first();
@@ -132,7 +137,7 @@ function onReloadClick(box) {
         return;
 
     $(img).attr('src', scriptData.loadingImage);
-    external.speedDial.loadThumbnail(url, false);
+    external.speedDial.loadThumbnail(url, false, isVisible(box));
 }
 
 function boxEdited() {
@@ -157,7 +162,7 @@ function boxEdited() {
             $('#fadeOverlay').fadeOut("slow", function() {
                 $("#fadeOverlay").remove();
             });
-            external.speedDial.loadThumbnail(a.getAttribute('href'), fetchTitleChecked);
+            external.speedDial.loadThumbnail(a.getAttribute('href'), fetchTitleChecked, true);
         } else {
             hideEditBox();
         }
@@ -225,7 +230,7 @@ function addBox(url, title, img_source) {
     div.appendChild(span4);
     document.getElementById("quickdial").appendChild(div);
     if (img_source == scriptData.loadingImage) {
-        external.speedDial.loadThumbnail(url, false);
+        external.speedDial.loadThumbnail(url, false, isVisible(div));
     }
     return div;
 }
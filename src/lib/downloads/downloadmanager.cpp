@@ -179,6 +179,9 @@ void DownloadManager::closeDownloadTab(QWebEngineDownloadItem *item) const
     for (auto *window : windows) {
         const auto tabs = window->tabWidget()->allTabs();
         for (auto *tab : tabs) {
+            if (!tab->hasWebView()) {
+                continue;
+            }
             auto *view = tab->webView();
             if (testWebView(view, item->url())) {
                 view->closeView();
@@ -23,14 +23,44 @@
 #include "mainapplication.h"
 #include "sqldatabase.h"
 #include "webview.h"
+#include "historywriter.h"
 
 #include <QWebEngineProfile>
+#include <QSqlError>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+
+#include <QFutureWatcher>
+
+#include <cmath>
+#include <memory>
+
+static bool s_hasSearchIndex = false;
+static bool s_hasFrecency = false;
+
+// Keeps number of bound values below SQLite limit
+static const int s_deleteChunkSize = 500;
+
+// Score of visits halves every 30 days
+static const double s_frecencyHalfLife = 30 * 24 * 60 * 60 * 1000.0;
+
+// Scheme is not indexed, otherwise short prefixes like "h" would match every url
+static QString searchIndexUrl(const QString &column)
+{
+    return QSL("CASE WHEN instr(%1, '://') THEN substr(%1, instr(%1, '://') + 3) ELSE %1 END").arg(column);
+}
 
 History::History(QObject* parent)
     : QObject(parent)
     , m_isSaving(true)
+    , m_deletionTotal(0)
+    , m_deletionDone(0)
     , m_model(0)
 {
+    m_writer = new HistoryWriter(this);
+    connect(m_writer, &HistoryWriter::entryAdded, this, &History::historyEntryAdded);
+    connect(m_writer, &HistoryWriter::entryEdited, this, &History::historyEntryEdited);
+
     loadSettings();
 }
 
@@ -82,56 +112,7 @@ void History::addHistoryEntry(const QUrl &url, QString title)
         title = tr("Empty Page");
     }
 
-    auto job = new SqlQueryJob(QSL("SELECT id, count, date, title FROM history WHERE url=?"), this);
-    job->addBindValue(url);
-    connect(job, &SqlQueryJob::finished, this, [=]() {
-        if (job->records().isEmpty()) {
-            auto job = new SqlQueryJob(QSL("INSERT INTO history (count, date, url, title) VALUES (1,?,?,?)"), this);
-            job->addBindValue(QDateTime::currentMSecsSinceEpoch());
-            job->addBindValue(url);
-            job->addBindValue(title);
-            connect(job, &SqlQueryJob::finished, this, [=]() {
-                HistoryEntry entry;
-                entry.id = job->lastInsertId().toInt();
-                entry.count = 1;
-                entry.date = QDateTime::currentDateTime();
-                entry.url = url;
-                entry.urlString = url.toEncoded();
-                entry.title = title;
-                emit historyEntryAdded(entry);
-            });
-            job->start();
-        } else {
-            const auto record = job->records().at(0);
-            const int id = record.value(0).toInt();
-            const int count = record.value(1).toInt();
-            const QDateTime date = QDateTime::fromMSecsSinceEpoch(record.value(2).toLongLong());
-            const QString oldTitle = record.value(3).toString();
-
-            auto job = new SqlQueryJob(QSL("UPDATE history SET count = count + 1, date=?, title=? WHERE url=?"), this);
-            job->addBindValue(QDateTime::currentMSecsSinceEpoch());
-            job->addBindValue(title);
-            job->addBindValue(url);
-            connect(job, &SqlQueryJob::finished, this, [=]() {
-                HistoryEntry before;
-                before.id = id;
-                before.count = count;
-                before.date = date;
-                before.url = url;
-                before.urlString = url.toEncoded();
-                before.title = oldTitle;
-
-                HistoryEntry after = before;
-                after.count = count + 1;
-                after.date = QDateTime::currentDateTime();
-                after.title = title;
-
-                emit historyEntryEdited(before, after);
-            });
-            job->start();
-        }
-    });
-    job->start();
+    m_writer->addVisit(url, title, QDateTime::currentMSecsSinceEpoch());
 }
 
 // DeleteHistoryEntry
@@ -145,85 +126,93 @@ void History::deleteHistoryEntry(int index)
 
 void History::deleteHistoryEntry(const QList<int> &list)
 {
-    QSqlDatabase db = SqlDatabase::instance()->database();
-    db.transaction();
-
-    for (int index : list) {
-        QSqlQuery query(SqlDatabase::instance()->database());
-        query.prepare("SELECT count, date, url, title FROM history WHERE id=?");
-        query.addBindValue(index);
-        query.exec();
-
-        if (!query.isActive() || !query.next()) {
-            continue;
-        }
-
-        HistoryEntry entry;
-        entry.id = index;
-        entry.count = query.value(0).toInt();
-        entry.date = QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong());
-        entry.url = query.value(2).toUrl();
-        entry.urlString = entry.url.toEncoded();
-        entry.title = query.value(3).toString();
-
-        query.prepare("DELETE FROM history WHERE id=?");
-        query.addBindValue(index);
-        query.exec();
-
-        query.prepare("DELETE FROM icons WHERE url=?");
-        query.addBindValue(entry.url.toEncoded(QUrl::RemoveFragment));
-        query.exec();
-
-        emit historyEntryDeleted(entry);
+    if (list.isEmpty()) {
+        // Lets deletion by time range report nothing was found
+        emit historyDeletionProgress(m_deletionDone, m_deletionTotal);
+        return;
     }
 
-    db.commit();
+    m_deletionTotal += list.size();
+
+    // Chunks are written one after another on database writer thread,
+    // all deleted entries are reported together after the last one
+    auto deleted = std::make_shared<int>(0);
+    auto deletedEntries = std::make_shared<QVector<HistoryEntry>>();
+    const int total = list.size();
+
+    for (int i = 0; i < total; i += s_deleteChunkSize) {
+        const QList<int> ids = list.mid(i, s_deleteChunkSize);
+        auto entries = std::make_shared<QVector<HistoryEntry>>();
+
+        auto watcher = new QFutureWatcher<void>(this);
+        connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+            watcher->deleteLater();
+            *deleted += ids.size();
+
+            for (const HistoryEntry &entry : qAsConst(*entries)) {
+                emit historyEntryDeleted(entry);
+            }
+            *deletedEntries += *entries;
+
+            m_deletionDone += ids.size();
+            emit historyDeletionProgress(m_deletionDone, m_deletionTotal);
+            if (m_deletionDone == m_deletionTotal) {
+                m_deletionDone = 0;
+                m_deletionTotal = 0;
+            }
+
+            if (*deleted == total) {
+                emit historyEntriesDeleted(*deletedEntries);
+            }
+        });
+        watcher->setFuture(SqlDatabase::instance()->runWrite([=]() {
+            *entries = deleteEntries(ids);
+        }));
+    }
 }
 
 void History::deleteHistoryEntry(const QString &url)
 {
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QSL("SELECT id FROM history WHERE url=?"));
-    query.bindValue(0, url);
-    query.exec();
-    if (query.next()) {
-        int id = query.value(0).toInt();
-        deleteHistoryEntry(id);
-    }
+    deleteMatchingEntries(QSL("url=?"), {url});
 }
 
 void History::deleteHistoryEntry(const QString &url, const QString &title)
 {
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare("SELECT id FROM history WHERE url=? AND title=?");
-    query.bindValue(0, url);
-    query.bindValue(1, title);
-    query.exec();
-    if (query.next()) {
-        int id = query.value(0).toInt();
-        deleteHistoryEntry(id);
-    }
+    deleteMatchingEntries(QSL("url=? AND title=?"), {url, title});
 }
 
-QList<int> History::indexesFromTimeRange(qint64 start, qint64 end)
+void History::deleteHistoryRange(qint64 start, qint64 end)
 {
-    QList<int> list;
-
     if (start < 0 || end < 0) {
-        return list;
+        return;
     }
 
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ?");
-    query.addBindValue(end);
-    query.addBindValue(start);
-    query.exec();
+    deleteMatchingEntries(QSL("date BETWEEN ? AND ?"), {end, start});
+}
 
-    while (query.next()) {
-        list.append(query.value(0).toInt());
-    }
+void History::deleteMatchingEntries(const QString &condition, const QVariantList &values)
+{
+    // Runs after pending visits on writer thread, so they are matched too
+    m_writer->submit();
 
-    return list;
+    auto ids = std::make_shared<QList<int>>();
+
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+        deleteHistoryEntry(*ids);
+    });
+    watcher->setFuture(SqlDatabase::instance()->runWrite([=]() {
+        QSqlQuery query = SqlDatabase::instance()->preparedQuery(QSL("SELECT id FROM history WHERE %1").arg(condition));
+        for (const QVariant &value : values) {
+            query.addBindValue(value);
+        }
+        query.exec();
+        while (query.next()) {
+            ids->append(query.value(0).toInt());
+        }
+        query.finish();
+    }));
 }
 
 QVector<HistoryEntry> History::mostVisited(int count)
@@ -246,13 +235,20 @@ QVector<HistoryEntry> History::mostVisited(int count)
 
 void History::clearHistory()
 {
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.exec(QSL("DELETE FROM history"));
-    query.exec(QSL("VACUUM"));
+    m_writer->clear();
 
     mApp->webProfile()->clearAllVisitedLinks();
 
-    emit resetHistory();
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+        emit resetHistory();
+    });
+    watcher->setFuture(SqlDatabase::instance()->runWrite([]() {
+        QSqlQuery query(SqlDatabase::instance()->database());
+        query.exec(QSL("DELETE FROM history"));
+        query.exec(QSL("VACUUM"));
+    }));
 }
 
 void History::setSaving(bool state)
@@ -298,6 +294,176 @@ QString History::titleCaseLocalizedMonth(int month)
     }
 }
 
+// static
+void History::setupSearchIndex(QSqlDatabase db)
+{
+    s_hasSearchIndex = db.tables().contains(QSL("history_fts"));
+
+    if (s_hasSearchIndex || mApp->isPrivate()) {
+        return;
+    }
+
+    // Contentless table, it only stores the index and rowid is history id
+    QSqlQuery query(db);
+    if (!query.exec(QSL("CREATE VIRTUAL TABLE history_fts USING fts5(url, title, content='')"))) {
+        qWarning() << "History: Full-text search is not available, location bar completion will be slower:" << query.lastError().text();
+        return;
+    }
+
+    const QStringList statements = {
+        QSL("INSERT INTO history_fts (rowid, url, title) SELECT id, %1, title FROM history").arg(searchIndexUrl(QSL("url"))),
+
+        QSL("CREATE TRIGGER history_fts_insert AFTER INSERT ON history BEGIN "
+            "INSERT INTO history_fts (rowid, url, title) VALUES (new.id, %1, new.title); "
+            "END").arg(searchIndexUrl(QSL("new.url"))),
+
+        QSL("CREATE TRIGGER history_fts_delete AFTER DELETE ON history BEGIN "
+            "INSERT INTO history_fts (history_fts, rowid, url, title) VALUES ('delete', old.id, %1, old.title); "
+            "END").arg(searchIndexUrl(QSL("old.url"))),
+
+        QSL("CREATE TRIGGER history_fts_update AFTER UPDATE OF url, title ON history "
+            "WHEN old.url IS NOT new.url OR old.title IS NOT new.title BEGIN "
+            "INSERT INTO history_fts (history_fts, rowid, url, title) VALUES ('delete', old.id, %1, old.title); "
+            "INSERT INTO history_fts (rowid, url, title) VALUES (new.id, %2, new.title); "
+            "END").arg(searchIndexUrl(QSL("old.url")), searchIndexUrl(QSL("new.url")))
+    };
+
+    db.transaction();
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "History: Cannot create full-text index:" << query.lastError().text();
+            db.rollback();
+            query.exec(QSL("DROP TABLE history_fts"));
+            return;
+        }
+    }
+    db.commit();
+
+    s_hasSearchIndex = true;
+}
+
+// static
+bool History::hasSearchIndex()
+{
+    return s_hasSearchIndex;
+}
+
+// static
+QVector<HistoryEntry> History::deleteEntries(const QList<int> &ids)
+{
+    QVector<HistoryEntry> entries;
+
+    QStringList placeholders;
+    for (int i = 0; i < ids.size(); ++i) {
+        placeholders.append(QSL("?"));
+    }
+
+    QSqlDatabase db = SqlDatabase::instance()->database();
+    db.transaction();
+
+    QSqlQuery query(db);
+    query.prepare(QSL("SELECT id, count, date, url, title FROM history WHERE id IN (%1)").arg(placeholders.join(QL1C(','))));
+    for (int id : ids) {
+        query.addBindValue(id);
+    }
+    query.exec();
+
+    QStringList iconUrls;
+    while (query.next()) {
+        HistoryEntry entry;
+        entry.id = query.value(0).toInt();
+        entry.count = query.value(1).toInt();
+        entry.date = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        entry.url = query.value(3).toUrl();
+        entry.urlString = entry.url.toEncoded();
+        entry.title = query.value(4).toString();
+        entries.append(entry);
+        iconUrls.append(QString::fromUtf8(entry.url.toEncoded(QUrl::RemoveFragment)));
+    }
+
+    if (entries.isEmpty()) {
+        db.commit();
+        return entries;
+    }
+
+    query.prepare(QSL("DELETE FROM history WHERE id IN (%1)").arg(placeholders.join(QL1C(','))));
+    for (int id : ids) {
+        query.addBindValue(id);
+    }
+    query.exec();
+
+    query.prepare(QSL("DELETE FROM icons WHERE url IN (%1)").arg(placeholders.mid(0, iconUrls.size()).join(QL1C(','))));
+    for (const QString &url : qAsConst(iconUrls)) {
+        query.addBindValue(url);
+    }
+    query.exec();
+
+    db.commit();
+
+    return entries;
+}
+
+// static
+void History::setupFrecency(QSqlDatabase db)
+{
+    s_hasFrecency = db.record(QSL("history")).contains(QSL("frecency"));
+
+    if (s_hasFrecency || mApp->isPrivate()) {
+        return;
+    }
+
+    QSqlQuery query(db);
+    db.transaction();
+
+    if (!query.exec(QSL("ALTER TABLE history ADD COLUMN frecency REAL DEFAULT 0 NOT NULL"))) {
+        qWarning() << "History: Cannot add frecency column:" << query.lastError().text();
+        db.rollback();
+        return;
+    }
+
+    // Only last visit time is known for existing entries, count all visits at that time
+    QSqlQuery update(db);
+    update.prepare(QSL("UPDATE history SET frecency=? WHERE id=?"));
+    query.exec(QSL("SELECT id, count, date FROM history"));
+    while (query.next()) {
+        update.addBindValue(addVisitToFrecency(0, query.value(2).toLongLong()) + std::log2(qMax(1, query.value(1).toInt())));
+        update.addBindValue(query.value(0));
+        update.exec();
+    }
+
+    if (!query.exec(QSL("CREATE INDEX history_frecencyindex ON history (frecency)"))) {
+        qWarning() << "History: Cannot create frecency index:" << query.lastError().text();
+        db.rollback();
+        return;
+    }
+
+    db.commit();
+
+    s_hasFrecency = true;
+}
+
+// static
+bool History::hasFrecency()
+{
+    return s_hasFrecency;
+}
+
+// static
+double History::addVisitToFrecency(double frecency, qint64 time)
+{
+    // Score is sum of 2^(visitTime / halfLife) over all visits, stored as its log2.
+    // All scores decay by the same factor as time passes, so stored values never need
+    // to be updated and ordering by them is the same as ordering by decayed score.
+    const double visit = time / s_frecencyHalfLife;
+    if (frecency <= 0) {
+        return visit;
+    }
+
+    const double high = qMax(frecency, visit);
+    const double low = qMin(frecency, visit);
+    return high + std::log2(1 + std::exp2(low - high));
+}
+
 QList<HistoryEntry> History::searchHistoryEntry(const QString &text)
 {
     QList<HistoryEntry> list;
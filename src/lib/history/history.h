@@ -22,13 +22,16 @@
 #include <QList>
 #include <QDateTime>
 #include <QUrl>
+#include <QVariant>
 
 #include "qzcommon.h"
 
 class QIcon;
+class QSqlDatabase;
 
 class WebView;
 class HistoryModel;
+class HistoryWriter;
 
 class FALKON_EXPORT History : public QObject
 {
@@ -47,17 +50,28 @@ public:
 
     static QString titleCaseLocalizedMonth(int month);
 
+    // Full-text index of history urls and titles (history_fts), kept in sync by triggers
+    static void setupSearchIndex(QSqlDatabase db);
+    static bool hasSearchIndex();
+
+    // Score of url decaying with time since visits, ordering by frecency column ranks most
+    // frequently and recently visited urls first. Visit at time (ms) is added to the score.
+    static void setupFrecency(QSqlDatabase db);
+    static bool hasFrecency();
+    static double addVisitToFrecency(double frecency, qint64 time);
+
     HistoryModel* model();
 
     void addHistoryEntry(WebView* view);
     void addHistoryEntry(const QUrl &url, QString title);
 
+    // Entries are deleted asynchronously on database writer thread
     void deleteHistoryEntry(int index);
     void deleteHistoryEntry(const QList<int> &list);
     void deleteHistoryEntry(const QString &url);
     void deleteHistoryEntry(const QString &url, const QString &title);
-
-    QList<int> indexesFromTimeRange(qint64 start, qint64 end);
+    // Deletes entries last visited between end and start (ms since epoch, end is earlier)
+    void deleteHistoryRange(qint64 start, qint64 end);
 
     QVector<HistoryEntry> mostVisited(int count);
 
@@ -73,13 +87,23 @@ public:
 Q_SIGNALS:
     void historyEntryAdded(const HistoryEntry &entry);
     void historyEntryDeleted(const HistoryEntry &entry);
+    // All entries removed by one deleteHistoryEntry call
+    void historyEntriesDeleted(const QVector<HistoryEntry> &entries);
+    // Entries deleted of all running deletions, deleted == total when they have all finished
+    void historyDeletionProgress(int deleted, int total);
     void historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after);
 
     void resetHistory();
 
 private:
+    void deleteMatchingEntries(const QString &condition, const QVariantList &values);
+    static QVector<HistoryEntry> deleteEntries(const QList<int> &ids);
+
     bool m_isSaving;
+    int m_deletionTotal;
+    int m_deletionDone;
     HistoryModel* m_model;
+    HistoryWriter* m_writer;
 };
 
 typedef History::HistoryEntry HistoryEntry;
@@ -45,6 +45,9 @@ HistoryManager::HistoryManager(BrowserWindow* window, QWidget* parent)
 
     connect(ui->deleteB, &QAbstractButton::clicked, ui->historyTree, &HistoryTreeView::removeSelectedItems);
     connect(ui->clearAll, &QAbstractButton::clicked, this, &HistoryManager::clearHistory);
+    connect(mApp->history(), &History::historyDeletionProgress, this, &HistoryManager::deletionProgress);
+
+    ui->deleteProgress->hide();
 
     ui->historyTree->setFocus();
 }
@@ -84,6 +87,13 @@ void HistoryManager::clearHistory()
     mApp->history()->clearHistory();
 }
 
+void HistoryManager::deletionProgress(int deleted, int total)
+{
+    ui->deleteProgress->setMaximum(total);
+    ui->deleteProgress->setValue(deleted);
+    ui->deleteProgress->setVisible(deleted < total);
+}
+
 void HistoryManager::keyPressEvent(QKeyEvent *event)
 {
     switch (event->key()) {
@@ -64,6 +64,7 @@ private Q_SLOTS:
     void copyUrl();
     void copyTitle();
     void clearHistory();
+    void deletionProgress(int deleted, int total);
 
 private:
     void keyPressEvent(QKeyEvent *event) override;
@@ -23,6 +23,10 @@
 #include <QApplication>
 #include <QDateTime>
 #include <QTimer>
+#include <QHash>
+
+#include <algorithm>
+#include <functional>
 
 static QString dateTimeToString(const QDateTime &dateTime)
 {
@@ -44,7 +48,7 @@ HistoryModel::HistoryModel(History* history)
 
     connect(m_history, &History::resetHistory, this, &HistoryModel::resetHistory);
     connect(m_history, &History::historyEntryAdded, this, &HistoryModel::historyEntryAdded);
-    connect(m_history, &History::historyEntryDeleted, this, &HistoryModel::historyEntryDeleted);
+    connect(m_history, &History::historyEntriesDeleted, this, &HistoryModel::historyEntriesDeleted);
     connect(m_history, &History::historyEntryEdited, this, &HistoryModel::historyEntryEdited);
 }
 
@@ -371,6 +375,53 @@ void HistoryModel::historyEntryDeleted(const HistoryEntry &entry)
     checkEmptyParentItem(parentItem);
 }
 
+void HistoryModel::historyEntriesDeleted(const QVector<HistoryEntry> &entries)
+{
+    QHash<HistoryItem*, QVector<int>> parentRows;
+    for (const HistoryEntry &entry : entries) {
+        HistoryItem* item = findHistoryItem(entry);
+        if (item) {
+            parentRows[item->parent()].append(item->row());
+        }
+    }
+
+    // Deleted entries usually are one time range, so they are consecutive rows
+    // in each top level item. Anything else is reloaded with single reset.
+    for (auto it = parentRows.begin(); it != parentRows.end(); ++it) {
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+        if (rows.last() - rows.first() + 1 != rows.size()) {
+            resetHistory();
+            return;
+        }
+    }
+
+    for (auto it = parentRows.constBegin(); it != parentRows.constEnd(); ++it) {
+        HistoryItem* parentItem = it.key();
+        const int first = it.value().first();
+        const int last = it.value().last();
+
+        // Emptied top level item is removed at once with all its children
+        if (parentItem->isTopLevel() && last - first + 1 == parentItem->childCount()) {
+            if (parentItem == m_todayItem) {
+                m_todayItem = 0;
+            }
+
+            const int row = parentItem->row();
+            beginRemoveRows(QModelIndex(), row, row);
+            delete parentItem;
+            endRemoveRows();
+            continue;
+        }
+
+        beginRemoveRows(createIndex(parentItem->row(), 0, parentItem), first, last);
+        for (int row = last; row >= first; --row) {
+            delete parentItem->child(row);
+        }
+        endRemoveRows();
+    }
+}
+
 void HistoryModel::historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after)
 {
 #if 0
@@ -72,6 +72,7 @@ private Q_SLOTS:
 
     void historyEntryAdded(const HistoryEntry &entry);
     void historyEntryDeleted(const HistoryEntry &entry);
+    void historyEntriesDeleted(const QVector<HistoryEntry> &entries);
     void historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after);
 
 private:
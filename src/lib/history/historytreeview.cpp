@@ -101,7 +101,6 @@ void HistoryTreeView::search(const QString &string)
 void HistoryTreeView::removeSelectedItems()
 {
     QList<int> list;
-    QApplication::setOverrideCursor(Qt::WaitCursor);
 
     QList<QPersistentModelIndex> topLevelIndexes;
 
@@ -115,11 +114,11 @@ void HistoryTreeView::removeSelectedItems()
             qint64 start = index.data(HistoryModel::TimestampStartRole).toLongLong();
             qint64 end = index.data(HistoryModel::TimestampEndRole).toLongLong();
 
-            list.append(m_history->indexesFromTimeRange(start, end));
+            m_history->deleteHistoryRange(start, end);
 
             topLevelIndexes.append(index);
         }
-        else {
+        else if (!selectionModel()->isSelected(index.parent())) {
             int id = index.data(HistoryModel::IdRole).toInt();
             if (!list.contains(id)) {
                 list.append(id);
@@ -129,8 +128,6 @@ void HistoryTreeView::removeSelectedItems()
 
     m_history->deleteHistoryEntry(list);
     m_history->model()->removeTopLevelIndexes(topLevelIndexes);
-
-    QApplication::restoreOverrideCursor();
 }
 
 void HistoryTreeView::contextMenuEvent(QContextMenuEvent* event)
@@ -0,0 +1,227 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "historywriter.h"
+#include "sqldatabase.h"
+
+#include <QTimer>
+#include <QFutureWatcher>
+
+// Visits are written at most after this interval or when this many urls are queued
+static const int s_flushInterval = 1000;
+static const int s_maxQueuedVisits = 50;
+
+HistoryWriter::HistoryWriter(QObject *parent)
+    : QObject(parent)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(s_flushInterval);
+    connect(m_timer, &QTimer::timeout, this, &HistoryWriter::submit);
+}
+
+HistoryWriter::~HistoryWriter()
+{
+    // Written on writer thread too, so it doesn't compete with it for database lock
+    submit();
+
+    for (const Batch &batch : qAsConst(m_batches)) {
+        batch.watcher->waitForFinished();
+    }
+}
+
+void HistoryWriter::addVisit(const QUrl &url, const QString &title, qint64 time)
+{
+    const int index = m_visitIndexes.value(url, -1);
+    if (index >= 0) {
+        Visit &visit = m_visits[index];
+        visit.title = title;
+        visit.times.append(time);
+    } else {
+        Visit visit;
+        visit.url = url;
+        visit.title = title;
+        visit.times.append(time);
+        m_visitIndexes.insert(url, m_visits.size());
+        m_visits.append(visit);
+    }
+
+    if (m_visits.size() >= s_maxQueuedVisits) {
+        submit();
+    } else if (!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+void HistoryWriter::submit()
+{
+    m_timer->stop();
+
+    if (m_visits.isEmpty()) {
+        return;
+    }
+
+    const QVector<Visit> visits = m_visits;
+    m_visits.clear();
+    m_visitIndexes.clear();
+
+    Batch batch;
+    batch.results = std::make_shared<QVector<Result>>();
+    batch.watcher = new QFutureWatcher<void>(this);
+    connect(batch.watcher, &QFutureWatcherBase::finished, this, &HistoryWriter::batchFinished);
+
+    auto results = batch.results;
+    batch.watcher->setFuture(SqlDatabase::instance()->runWrite([=]() {
+        *results = writeVisits(visits);
+    }));
+
+    m_batches.append(batch);
+}
+
+void HistoryWriter::flush()
+{
+    submit();
+
+    // Batches are written in order on writer thread
+    while (!m_batches.isEmpty()) {
+        const Batch batch = m_batches.takeFirst();
+        batch.watcher->waitForFinished();
+        batch.watcher->deleteLater();
+        emitResults(*batch.results);
+    }
+}
+
+void HistoryWriter::clear()
+{
+    m_timer->stop();
+    m_visits.clear();
+    m_visitIndexes.clear();
+
+    // Anything cleared on writer thread afterwards removes these entries again
+    for (const Batch &batch : qAsConst(m_batches)) {
+        batch.watcher->disconnect(this);
+        if (batch.watcher->isFinished()) {
+            batch.watcher->deleteLater();
+        } else {
+            connect(batch.watcher, &QFutureWatcherBase::finished, batch.watcher, &QObject::deleteLater);
+        }
+    }
+    m_batches.clear();
+}
+
+void HistoryWriter::batchFinished()
+{
+    // Batches finish in order, flush() and clear() may have taken them already
+    while (!m_batches.isEmpty() && m_batches.first().watcher->isFinished()) {
+        const Batch batch = m_batches.takeFirst();
+        batch.watcher->deleteLater();
+        emitResults(*batch.results);
+    }
+}
+
+void HistoryWriter::emitResults(const QVector<Result> &results)
+{
+    for (const Result &result : results) {
+        if (result.added) {
+            emit entryAdded(result.after);
+        } else {
+            emit entryEdited(result.before, result.after);
+        }
+    }
+}
+
+// static
+QVector<HistoryWriter::Result> HistoryWriter::writeVisits(const QVector<Visit> &visits)
+{
+    QVector<Result> results;
+
+    SqlDatabase *database = SqlDatabase::instance();
+    QSqlDatabase db = database->database();
+    const bool frecency = History::hasFrecency();
+
+    QSqlQuery selectQuery = database->preparedQuery(QSL("SELECT id, count, date, title%1 FROM history WHERE url=?").arg(frecency ? QSL(", frecency") : QString()));
+
+    // Both statements bind count, date, title, frecency and url/id in this order
+    QSqlQuery insertQuery = database->preparedQuery(frecency
+        ? QSL("INSERT INTO history (count, date, title, frecency, url) VALUES (?,?,?,?,?)")
+        : QSL("INSERT INTO history (count, date, title, url) VALUES (?,?,?,?)"));
+    QSqlQuery updateQuery = database->preparedQuery(frecency
+        ? QSL("UPDATE history SET count = count + ?, date=?, title=?, frecency=? WHERE id=?")
+        : QSL("UPDATE history SET count = count + ?, date=?, title=? WHERE id=?"));
+
+    db.transaction();
+
+    for (const Visit &visit : visits) {
+        selectQuery.addBindValue(visit.url);
+        selectQuery.exec();
+
+        Result result;
+        result.added = !selectQuery.next();
+        result.before.url = visit.url;
+        result.before.urlString = visit.url.toEncoded();
+
+        double score = 0;
+        if (result.added) {
+            result.before.id = -1;
+            result.before.count = 0;
+        } else {
+            result.before.id = selectQuery.value(0).toInt();
+            result.before.count = selectQuery.value(1).toInt();
+            result.before.date = QDateTime::fromMSecsSinceEpoch(selectQuery.value(2).toLongLong());
+            result.before.title = selectQuery.value(3).toString();
+            if (frecency) {
+                score = selectQuery.value(4).toDouble();
+            }
+        }
+        selectQuery.finish();
+
+        for (qint64 time : visit.times) {
+            score = History::addVisitToFrecency(score, time);
+        }
+
+        QSqlQuery &query = result.added ? insertQuery : updateQuery;
+        query.addBindValue(visit.times.size());
+        query.addBindValue(visit.times.last());
+        query.addBindValue(visit.title);
+        if (frecency) {
+            query.addBindValue(score);
+        }
+        if (result.added) {
+            query.addBindValue(visit.url);
+        } else {
+            query.addBindValue(result.before.id);
+        }
+        if (!query.exec()) {
+            qWarning() << "HistoryWriter: Cannot save" << visit.url << query.lastError().text();
+            continue;
+        }
+
+        result.after = result.before;
+        result.after.count += visit.times.size();
+        result.after.date = QDateTime::fromMSecsSinceEpoch(visit.times.last());
+        result.after.title = visit.title;
+        if (result.added) {
+            result.after.id = insertQuery.lastInsertId().toInt();
+        }
+
+        results.append(result);
+    }
+
+    db.commit();
+
+    return results;
+}
@@ -0,0 +1,93 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef HISTORYWRITER_H
+#define HISTORYWRITER_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QUrl>
+
+#include <memory>
+
+#include "qzcommon.h"
+#include "history.h"
+
+class QTimer;
+
+template<typename T>
+class QFutureWatcher;
+
+// Queues visits in memory and writes them in batches, each batch in single transaction.
+// Repeated visits of the same url are coalesced into one write.
+class FALKON_EXPORT HistoryWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HistoryWriter(QObject *parent = nullptr);
+    ~HistoryWriter();
+
+    void addVisit(const QUrl &url, const QString &title, qint64 time);
+
+    // Queues all pending visits on database writer thread, anything run there
+    // with SqlDatabase::runWrite() afterwards sees them saved
+    void submit();
+
+    // Writes all queued visits and waits until they are saved
+    void flush();
+
+    // Drops all queued visits, batches already submitted are still saved
+    // but not reported
+    void clear();
+
+Q_SIGNALS:
+    void entryAdded(const HistoryEntry &entry);
+    void entryEdited(const HistoryEntry &before, const HistoryEntry &after);
+
+private:
+    struct Visit {
+        QUrl url;
+        QString title;
+        QVector<qint64> times;
+    };
+
+    struct Result {
+        bool added = false;
+        HistoryEntry before;
+        HistoryEntry after;
+    };
+
+    struct Batch {
+        QFutureWatcher<void> *watcher;
+        std::shared_ptr<QVector<Result>> results;
+    };
+
+    void batchFinished();
+    void emitResults(const QVector<Result> &results);
+
+    static QVector<Result> writeVisits(const QVector<Visit> &visits);
+
+    QVector<Visit> m_visits;
+    QHash<QUrl, int> m_visitIndexes;
+
+    QTimer *m_timer;
+    QVector<Batch> m_batches;
+};
+
+#endif // HISTORYWRITER_H
@@ -24,6 +24,7 @@
 #include "browserwindow.h"
 #include "tabwidget.h"
 #include "sqldatabase.h"
+#include "history.h"
 
 LocationCompleterModel::LocationCompleterModel(QObject* parent)
     : QStandardItemModel(parent)
@@ -97,8 +98,58 @@ QSqlQuery LocationCompleterModel::createDomainQuery(const QString &text)
     return sqlQuery;
 }
 
+// Profile opened read-only in private mode may be missing the frecency column
+static QString historyOrder()
+{
+    return History::hasFrecency() ? QStringLiteral("frecency DESC") : QStringLiteral("date DESC");
+}
+
+// Prefix query for history_fts, empty if search string has nothing that can be searched in index
+static QString createSearchIndexQuery(const QString &searchString)
+{
+    QStringList terms;
+    const QStringList words = searchString.split(QLatin1Char(' '), QString::SkipEmptyParts);
+
+    for (QString word : words) {
+        // Scheme is not indexed
+        const int schemeEnd = word.indexOf(QLatin1String("://"));
+        if (schemeEnd >= 0) {
+            word = word.mid(schemeEnd + 3);
+        }
+
+        // Punctuation is not indexed, such words cannot be matched
+        bool hasTokenChar = false;
+        for (const QChar &c : qAsConst(word)) {
+            if (c.isLetterOrNumber()) {
+                hasTokenChar = true;
+                break;
+            }
+        }
+        if (!hasTokenChar) {
+            continue;
+        }
+
+        word.replace(QLatin1Char('"'), QLatin1String("\"\""));
+        terms.append(QLatin1Char('"') + word + QLatin1String("\"*"));
+    }
+
+    return terms.join(QLatin1Char(' '));
+}
+
 QSqlQuery LocationCompleterModel::createHistoryQuery(const QString &searchString, int limit, bool exactMatch)
 {
+    const QString indexQuery = exactMatch || !History::hasSearchIndex() ? QString() : createSearchIndexQuery(searchString);
+
+    if (!indexQuery.isEmpty()) {
+        QSqlQuery sqlQuery(SqlDatabase::instance()->database());
+        sqlQuery.prepare(QLatin1String("SELECT history.id, history.url, history.title, history.count FROM history_fts "
+                                       "JOIN history ON history.id = history_fts.rowid "
+                                       "WHERE history_fts MATCH ? ORDER BY history.%1 LIMIT ?").arg(historyOrder()));
+        sqlQuery.addBindValue(indexQuery);
+        sqlQuery.addBindValue(limit);
+        return sqlQuery;
+    }
+
     QStringList searchList;
     QString query = QLatin1String("SELECT id, url, title, count FROM history WHERE ");
 
@@ -116,7 +167,7 @@ QSqlQuery LocationCompleterModel::createHistoryQuery(const QString &searchString
         }
     }
 
-    query.append(QLatin1String("ORDER BY date DESC LIMIT ?"));
+    query.append(QLatin1String("ORDER BY %1 LIMIT ?").arg(historyOrder()));
 
     QSqlQuery sqlQuery(SqlDatabase::instance()->database());
     sqlQuery.prepare(query);
@@ -137,6 +188,15 @@ QSqlQuery LocationCompleterModel::createHistoryQuery(const QString &searchString
     return sqlQuery;
 }
 
+QSqlQuery LocationCompleterModel::createMostVisitedQuery(int limit)
+{
+    QSqlQuery sqlQuery(SqlDatabase::instance()->database());
+    sqlQuery.prepare(QLatin1String("SELECT id, url, title FROM history ORDER BY %1 LIMIT ?")
+                     .arg(History::hasFrecency() ? QStringLiteral("frecency DESC") : QStringLiteral("count DESC")));
+    sqlQuery.addBindValue(limit);
+    return sqlQuery;
+}
+
 void LocationCompleterModel::setTabPosition(QStandardItem* item) const
 {
     Q_ASSERT(item);
@@ -53,6 +53,7 @@ public:
 
     static QSqlQuery createHistoryQuery(const QString &searchString, int limit, bool exactMatch = false);
     static QSqlQuery createDomainQuery(const QString &text);
+    static QSqlQuery createMostVisitedQuery(int limit);
 
 private:
     enum Type {
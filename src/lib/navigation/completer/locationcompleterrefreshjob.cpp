@@ -24,13 +24,13 @@
 #include "qzsettings.h"
 #include "bookmarks.h"
 #include "qztools.h"
+#include "history.h"
 
 #include <algorithm>
 
+#include <QHash>
 #include <QDateTime>
 
-#include <QtConcurrent/QtConcurrentRun>
-
 LocationCompleterRefreshJob::LocationCompleterRefreshJob(const QString &searchString)
     : QObject()
     , m_timestamp(QDateTime::currentMSecsSinceEpoch())
@@ -40,7 +40,8 @@ LocationCompleterRefreshJob::LocationCompleterRefreshJob(const QString &searchSt
     m_watcher = new QFutureWatcher<void>(this);
     connect(m_watcher, &QFutureWatcherBase::finished, this, &LocationCompleterRefreshJob::slotFinished);
 
-    QFuture<void> future = QtConcurrent::run(this, &LocationCompleterRefreshJob::runJob);
+    // Completions are read before any other queued database reads
+    QFuture<void> future = SqlDatabase::instance()->runRead([this]() { runJob(); }, SqlDatabase::HighPriority);
     m_watcher->setFuture(future);
 }
 
@@ -79,13 +80,6 @@ void LocationCompleterRefreshJob::slotFinished()
     emit finished();
 }
 
-static bool countBiggerThan(const QStandardItem* i1, const QStandardItem* i2)
-{
-    int i1Count = i1->data(LocationCompleterModel::CountRole).toInt();
-    int i2Count = i2->data(LocationCompleterModel::CountRole).toInt();
-    return i1Count > i2Count;
-}
-
 void LocationCompleterRefreshJob::runJob()
 {
     if (m_jobCancelled || mApp->isClosing() || !mApp) {
@@ -176,8 +170,30 @@ void LocationCompleterRefreshJob::completeFromHistory()
         }
     }
 
-    // Sort by count
-    std::sort(m_items.begin(), m_items.end(), countBiggerThan);
+    // Sort by frecency of bookmarked url in history, unvisited bookmarks by count
+    if (!m_items.isEmpty()) {
+        QHash<const QStandardItem*, double> frecency;
+        if (History::hasFrecency()) {
+            QSqlQuery query(SqlDatabase::instance()->database());
+            query.prepare(QSL("SELECT frecency FROM history WHERE url=?"));
+            for (const QStandardItem* item : qAsConst(m_items)) {
+                query.addBindValue(item->data(LocationCompleterModel::UrlRole).toUrl());
+                query.exec();
+                if (query.next()) {
+                    frecency[item] = query.value(0).toDouble();
+                }
+            }
+        }
+
+        std::stable_sort(m_items.begin(), m_items.end(), [&](const QStandardItem* i1, const QStandardItem* i2) {
+            const double f1 = frecency.value(i1);
+            const double f2 = frecency.value(i2);
+            if (f1 != f2) {
+                return f1 > f2;
+            }
+            return i1->data(LocationCompleterModel::CountRole).toInt() > i2->data(LocationCompleterModel::CountRole).toInt();
+        });
+    }
 
     // Search in history
     if (showType == HistoryAndBookmarks || showType == History) {
@@ -208,8 +224,8 @@ void LocationCompleterRefreshJob::completeFromHistory()
 
 void LocationCompleterRefreshJob::completeMostVisited()
 {
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.exec(QSL("SELECT id, url, title FROM history ORDER BY count DESC LIMIT 15"));
+    QSqlQuery query = LocationCompleterModel::createMostVisitedQuery(15);
+    query.exec();
 
     while (query.next()) {
         QStandardItem* item = new QStandardItem();
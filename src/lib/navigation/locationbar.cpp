@@ -141,6 +141,7 @@ void LocationBar::setWebView(TabbedWebView* view)
     connect(m_webView, &QWebEngineView::loadFinished, this, &LocationBar::loadFinished);
     connect(m_webView, &QWebEngineView::urlChanged, this, &LocationBar::showUrl);
     connect(m_webView, &WebView::privacyChanged, this, &LocationBar::setPrivacyState);
+    connect(m_webView, &WebView::autoFillUsernamesChanged, this, &LocationBar::showAutoFillIcon);
 }
 
 void LocationBar::setText(const QString &text)
@@ -645,8 +646,16 @@ void LocationBar::loadFinished()
 
     WebPage* page = qobject_cast<WebPage*>(m_webView->page());
 
-    if (page && !page->autoFillUsernames().isEmpty()) {
-        m_autofillIcon->setUsernames(page->autoFillUsernames());
+    if (page) {
+        showAutoFillIcon(page->autoFillUsernames());
+    }
+}
+
+void LocationBar::showAutoFillIcon(const QStringList &usernames)
+{
+    // Saved usernames may be loaded only after the page finished loading
+    if (!usernames.isEmpty()) {
+        m_autofillIcon->setUsernames(usernames);
         m_autofillIcon->show();
     }
 }
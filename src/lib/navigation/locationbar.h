@@ -90,6 +90,7 @@ private Q_SLOTS:
     void loadProgress(int progress);
     void loadFinished();
     void hideProgress();
+    void showAutoFillIcon(const QStringList &usernames);
 
     void loadSettings();
 
@@ -21,7 +21,8 @@
 #include "mainapplication.h"
 #include "useragentmanager.h"
 
-#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 NetworkUrlInterceptor::NetworkUrlInterceptor(QObject *parent)
     : QWebEngineUrlRequestInterceptor(parent)
@@ -31,7 +32,8 @@ NetworkUrlInterceptor::NetworkUrlInterceptor(QObject *parent)
 
 void NetworkUrlInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
 {
-    QMutexLocker lock(&m_mutex);
+    // Requests only read the state, they don't block each other
+    QReadLocker lock(&m_lock);
 
     if (m_sendDNT) {
         info.setHttpHeader(QByteArrayLiteral("DNT"), QByteArrayLiteral("1"));
@@ -65,7 +67,7 @@ void NetworkUrlInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
 
 void NetworkUrlInterceptor::installUrlInterceptor(UrlInterceptor *interceptor)
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     if (!m_interceptors.contains(interceptor)) {
         m_interceptors.append(interceptor);
@@ -74,14 +76,14 @@ void NetworkUrlInterceptor::installUrlInterceptor(UrlInterceptor *interceptor)
 
 void NetworkUrlInterceptor::removeUrlInterceptor(UrlInterceptor *interceptor)
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     m_interceptors.removeOne(interceptor);
 }
 
 void NetworkUrlInterceptor::loadSettings()
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     Settings settings;
     settings.beginGroup("Web-Browser-Settings");
@@ -19,7 +19,7 @@
 #ifndef NETWORKURLINTERCEPTOR_H
 #define NETWORKURLINTERCEPTOR_H
 
-#include <QMutex>
+#include <QReadWriteLock>
 #include <QWebEngineUrlRequestInterceptor>
 
 #include "qzcommon.h"
@@ -39,7 +39,7 @@ public:
     void loadSettings();
 
 private:
-    QMutex m_mutex;
+    QReadWriteLock m_lock;
     QList<UrlInterceptor*> m_interceptors;
     bool m_sendDNT = false;
     bool m_usePerDomainUserAgent = false;
@@ -27,13 +27,17 @@
 #include "iconprovider.h"
 #include "sessionmanager.h"
 #include "restoremanager.h"
+#include "tabdiscardmanager.h"
 #include "../config.h"
 
+#include <QFile>
 #include <QTimer>
+#include <QLocale>
 #include <QSettings>
 #include <QUrlQuery>
 #include <QWebEngineProfile>
 #include <QWebEngineUrlRequestJob>
+#include <QtWebEngineWidgetsVersion>
 
 static QString authorString(const char* name, const QString &mail)
 {
@@ -77,6 +81,28 @@ bool FalkonSchemeHandler::handleRequest(QWebEngineUrlRequestJob *job)
     } else if (job->requestUrl().path() == QL1S("reportbug")) {
         job->redirect(QUrl(Qz::BUGSADDRESS));
         return true;
+    } else if (job->requestUrl().path() == QL1S("speeddial-thumbnail")) {
+        // Only falkon: pages may load thumbnails, otherwise any site could probe
+        // which urls are in speed dial. Without initiator (QtWebEngine < 5.11),
+        // SpeedDial embeds thumbnails as data urls instead.
+#if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+        if (job->initiator().scheme() != QL1S("falkon")) {
+            job->fail(QWebEngineUrlRequestJob::RequestDenied);
+            return true;
+        }
+#else
+        job->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return true;
+#endif
+        // Stream the file, url is versioned by SpeedDial so it can be cached by page
+        const QString fileName = mApp->plugins()->speedDial()->thumbnailPath(query.queryItemValue(QSL("h")));
+        QFile *file = new QFile(fileName, job);
+        if (fileName.isEmpty() || !file->open(QFile::ReadOnly)) {
+            job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        } else {
+            job->reply(QByteArrayLiteral("image/png"), file);
+        }
+        return true;
     }
 
     return false;
@@ -286,6 +312,7 @@ QString FalkonSchemeReply::configPage()
         cPage.replace(QLatin1String("%BROWSER-IDENTIFICATION%"), tr("Browser Identification"));
         cPage.replace(QLatin1String("%PATHS%"), tr("Paths"));
         cPage.replace(QLatin1String("%BUILD-CONFIG%"), tr("Build Configuration"));
+        cPage.replace(QLatin1String("%TAB-DISCARDING%"), tr("Tab Discarding"));
         cPage.replace(QLatin1String("%PREFS%"), tr("Preferences"));
         cPage.replace(QLatin1String("%OPTION%"), tr("Option"));
         cPage.replace(QLatin1String("%VALUE%"), tr("Value"));
@@ -355,6 +382,28 @@ QString FalkonSchemeReply::configPage()
     QString page = cPage;
     page.replace(QLatin1String("%USER-AGENT%"), mApp->webProfile()->httpUserAgent());
 
+    auto memorySize = [](qint64 size) {
+        return size < 0 ? tr("Unknown") : QzTools::fileSizeToString(size);
+    };
+    auto dateTime = [](const QDateTime &dateTime) {
+        return dateTime.isValid() ? QLocale().toString(dateTime, QLocale::ShortFormat) : tr("Never");
+    };
+
+    QString discardEnabled = mApp->tabDiscardManager()->isEnabled() ? tr("Yes") : tr("No");
+    if (!TabDiscardManager::isSupported()) {
+        discardEnabled = tr("Unsupported");
+    }
+
+    const TabDiscardManager::Stats discardStats = mApp->tabDiscardManager()->stats();
+    page.replace(QLatin1String("%TAB-DISCARDING-TEXT%"),
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Enabled"), discardEnabled) +
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Memory usage"), memorySize(discardStats.rss)) +
+                 QString("<dt>%1</dt><dd>%2 / %3<dd>").arg(tr("Available memory"), memorySize(discardStats.availableMemory), memorySize(discardStats.totalMemory)) +
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Loaded tabs"), QString::number(discardStats.loadedTabs)) +
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Discarded tabs"), QString::number(discardStats.discardedTabs)) +
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Last check"), dateTime(discardStats.lastCheck)) +
+                 QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Last discard"), dateTime(discardStats.lastDiscard)));
+
     QString pluginsString;
     const QList<Plugins::Plugin> &availablePlugins = mApp->plugins()->availablePlugins();
 
@@ -26,6 +26,8 @@
 #include "networkmanager.h"
 #include "ui_clearprivatedata.h"
 #include "iconprovider.h"
+#include "databasemaintenance.h"
+#include "magicwandstylecache.h"
 #include "qztools.h"
 #include "cookiemanager.h"
 #include "desktopnotificationsfactory.h"
@@ -85,6 +87,7 @@ void ClearPrivateData::clearCache()
     QzTools::removeRecursively(profile + "/GPUCache");
 
     mApp->webProfile()->clearHttpCache();
+    mApp->magicWandStyleCache()->clear();
 }
 
 void ClearPrivateData::closeEvent(QCloseEvent* e)
@@ -101,6 +104,8 @@ void ClearPrivateData::dialogAccepted()
 {
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
+    bool deletingHistory = false;
+
     if (ui->history->isChecked()) {
         qint64 start = QDateTime::currentMSecsSinceEpoch();
         qint64 end = 0;
@@ -127,8 +132,9 @@ void ClearPrivateData::dialogAccepted()
             mApp->history()->clearHistory();
         }
         else {
-            const QList<int> &indexes = mApp->history()->indexesFromTimeRange(start, end);
-            mApp->history()->deleteHistoryEntry(indexes);
+            deletingHistory = true;
+            connect(mApp->history(), &History::historyDeletionProgress, this, &ClearPrivateData::historyDeletionProgress);
+            mApp->history()->deleteHistoryRange(start, end);
         }
     }
 
@@ -151,25 +157,48 @@ void ClearPrivateData::dialogAccepted()
     QApplication::restoreOverrideCursor();
 
     ui->clear->setEnabled(false);
-    ui->clear->setText(tr("Done"));
 
-    QTimer::singleShot(1000, this, &QWidget::close);
+    // History is deleted in background, dialog is closed when it finishes
+    if (deletingHistory) {
+        ui->clear->setText(tr("Deleting history..."));
+    } else {
+        ui->clear->setText(tr("Done"));
+        QTimer::singleShot(1000, this, &QWidget::close);
+    }
 }
 
-void ClearPrivateData::optimizeDb()
+void ClearPrivateData::historyDeletionProgress(int deleted, int total)
 {
-    mApp->setOverrideCursor(Qt::WaitCursor);
-
-    const QString profilePath = DataPaths::currentProfilePath();
-    QString sizeBefore = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
-
-    IconProvider::instance()->clearOldIconsInDatabase();
+    if (deleted < total) {
+        ui->clear->setText(tr("Deleting history... %1%").arg(deleted * 100 / total));
+        return;
+    }
 
-    QString sizeAfter = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
+    disconnect(mApp->history(), &History::historyDeletionProgress, this, &ClearPrivateData::historyDeletionProgress);
 
-    mApp->restoreOverrideCursor();
+    ui->clear->setText(tr("Done"));
+    QTimer::singleShot(1000, this, &QWidget::close);
+}
 
-    QMessageBox::information(this, tr("Database Optimized"), tr("Database successfully optimized.<br/><br/><b>Database Size Before: </b>%1<br/><b>Database Size After: </b>%2").arg(sizeBefore, sizeAfter));
+void ClearPrivateData::optimizeDb()
+{
+    const QString dbPath = DataPaths::currentProfilePath() + QL1S("/browsedata.db");
+    const QString sizeBefore = QzTools::fileSizeToString(QFileInfo(dbPath).size());
+
+    // Runs in background, dialog may be closed in meantime
+    ui->optimizeDb->setEnabled(false);
+
+    auto maintenance = new DatabaseMaintenance(this);
+    maintenance->setFullVacuumAllowed(true);
+    connect(maintenance, &DatabaseMaintenance::historyExpired, mApp->history(), &History::resetHistory);
+    connect(maintenance, &DatabaseMaintenance::finished, this, [=]() {
+        maintenance->deleteLater();
+        ui->optimizeDb->setEnabled(true);
+
+        const QString sizeAfter = QzTools::fileSizeToString(QFileInfo(dbPath).size());
+        QMessageBox::information(this, tr("Database Optimized"), tr("Database successfully optimized.<br/><br/><b>Database Size Before: </b>%1<br/><b>Database Size After: </b>%2").arg(sizeBefore, sizeAfter));
+    });
+    maintenance->start();
 }
 
 void ClearPrivateData::showCookieManager()
@@ -40,6 +40,7 @@ public:
 private Q_SLOTS:
     void historyClicked(bool state);
     void dialogAccepted();
+    void historyDeletionProgress(int deleted, int total);
     void optimizeDb();
     void showCookieManager();
 
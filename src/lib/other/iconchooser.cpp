@@ -21,6 +21,7 @@
 #include "proxystyle.h"
 #include "qztools.h"
 #include "sqldatabase.h"
+#include "iconprovider.h"
 
 #include <QFileDialog>
 
@@ -65,8 +66,20 @@ void IconChooser::searchIcon(const QString &string)
     ui->iconList->clear();
 
     QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QSL("SELECT icon FROM icons WHERE url GLOB ? LIMIT 20"));
-    query.addBindValue(QString(QL1S("*%1*")).arg(QzTools::escapeSqlGlobString(string)));
+    if (IconProvider::isLegacySchema()) {
+        query.prepare(QSL("SELECT icon FROM icons WHERE url GLOB ? LIMIT 20"));
+        query.addBindValue(QString(QL1S("*%1*")).arg(QzTools::escapeSqlGlobString(string)));
+    } else {
+        // Hosts starting with the searched one, as range on host index
+        const QString host = IconProvider::normalizedHost(QUrl::fromUserInput(string));
+        if (host.isEmpty()) {
+            return;
+        }
+        query.prepare(QSL("SELECT icon FROM icon_data WHERE id IN "
+                          "(SELECT DISTINCT data_id FROM icons WHERE host >= ? AND host < ? LIMIT 20)"));
+        query.addBindValue(host);
+        query.addBindValue(host + QChar(0xffff));
+    }
     query.exec();
 
     while (query.next()) {
@@ -82,10 +82,7 @@ void QmlHistory::deleteRange(const QVariantMap &map)
     const qlonglong startTime = map.value(QSL("startTime")).toLongLong();
     const qlonglong endTime = map.value(QSL("endTime")).toLongLong();
 
-    const QList<int> entries = mApp->history()->indexesFromTimeRange(startTime, endTime);
-    for (int index : entries) {
-        mApp->history()->deleteHistoryEntry(index);
-    }
+    mApp->history()->deleteHistoryRange(startTime, endTime);
 }
 
 void QmlHistory::deleteAll()
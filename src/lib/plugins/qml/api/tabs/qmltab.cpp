@@ -322,7 +322,7 @@ bool QmlTab::loading() const
         return false;
     }
 
-    return m_webTab->webView()->isLoading();
+    return m_webTab->isLoading();
 }
 
 int QmlTab::loadingProgress() const
@@ -331,6 +331,10 @@ int QmlTab::loadingProgress() const
         return -1;
     }
 
+    if (!m_webTab->hasWebView()) {
+        return 0;
+    }
+
     return m_webTab->webView()->loadingProgress();
 }
 
@@ -340,12 +344,12 @@ bool QmlTab::backgroundActivity() const
         return false;
     }
 
-    return m_webTab->webView()->backgroundActivity();
+    return m_webTab->backgroundActivity();
 }
 
 bool QmlTab::canGoBack() const
 {
-    if (!m_webTab) {
+    if (!m_webTab || !m_webTab->hasWebView()) {
         return false;
     }
 
@@ -354,7 +358,7 @@ bool QmlTab::canGoBack() const
 
 bool QmlTab::canGoForward() const
 {
-    if (!m_webTab) {
+    if (!m_webTab || !m_webTab->hasWebView()) {
         return false;
     }
 
@@ -408,8 +412,17 @@ void QmlTab::createConnections()
     });
     m_lambdaConnections.append(playingChangedConnection);
 
-    connect(m_webTab->webView(), &TabbedWebView::zoomLevelChanged, this, &QmlTab::zoomLevelChanged);
-    connect(m_webTab->webView(), &TabbedWebView::backgroundActivityChanged, this, &QmlTab::backgroundActivityChanged);
+    // Placeholder tabs create their view only when activated
+    auto connectWebView = [this]() {
+        connect(m_webTab->webView(), &TabbedWebView::zoomLevelChanged, this, &QmlTab::zoomLevelChanged);
+    };
+    if (m_webTab->hasWebView()) {
+        connectWebView();
+    }
+    auto webViewCreatedConnection = connect(m_webTab, &WebTab::webViewCreated, this, connectWebView);
+    m_lambdaConnections.append(webViewCreatedConnection);
+
+    connect(m_webTab, &WebTab::backgroundActivityChanged, this, &QmlTab::backgroundActivityChanged);
 
     if (m_webPage) {
         connect(m_webPage, &WebPage::navigationRequestAccepted, this, &QmlTab::navigationRequestAccepted);
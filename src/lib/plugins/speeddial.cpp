@@ -16,18 +16,21 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 * ============================================================ */
 #include "speeddial.h"
-#include "pagethumbnailer.h"
+#include "thumbnailservice.h"
 #include "settings.h"
 #include "datapaths.h"
 #include "qztools.h"
 #include "autosaver.h"
 
 #include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
 #include <QCryptographicHash>
 #include <QFileDialog>
 #include <QWebEnginePage>
 #include <QImage>
 #include <QJsonDocument>
+#include <QtWebEngineWidgetsVersion>
 
 #define ENSURE_LOADED if (!m_loaded) loadSettings();
 
@@ -38,6 +41,7 @@ SpeedDial::SpeedDial(QObject* parent)
     , m_sdcentered(false)
     , m_loaded(false)
     , m_regenerateScript(true)
+    , m_thumbnailService(nullptr)
 {
     m_autoSaver = new AutoSaver(this);
     connect(m_autoSaver, &AutoSaver::save, this, &SpeedDial::saveSettings);
@@ -203,17 +207,10 @@ QString SpeedDial::initialScript()
     QVariantList pages;
 
     for (const Page &page : qAsConst(m_pages)) {
-        QString imgSource = m_thumbnailsDir + QCryptographicHash::hash(page.url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+        QString imgSource = thumbnailUrl(page.url);
 
-        if (!QFile(imgSource).exists()) {
-            imgSource = "qrc:html/loading.gif";
-
-            if (!page.isValid()) {
-                imgSource.clear();
-            }
-        }
-        else {
-            imgSource = QzTools::pixmapToDataUrl(QPixmap(imgSource)).toString();
+        if (imgSource.isEmpty() && page.isValid()) {
+            imgSource = QSL("qrc:html/loading.gif");
         }
 
         QVariantMap map;
@@ -256,25 +253,72 @@ void SpeedDial::changed(const QString &allPages)
     emit pagesChanged();
 }
 
-void SpeedDial::loadThumbnail(const QString &url, bool loadTitle)
+void SpeedDial::loadThumbnail(const QString &url, bool loadTitle, bool highPriority)
 {
-    PageThumbnailer* thumbnailer = new PageThumbnailer(this);
-    thumbnailer->setUrl(QUrl::fromEncoded(url.toUtf8()));
-    thumbnailer->setLoadTitle(loadTitle);
-    connect(thumbnailer, &PageThumbnailer::thumbnailCreated, this, &SpeedDial::thumbnailCreated);
+    ENSURE_LOADED;
+
+    if (!m_thumbnailService) {
+        m_thumbnailService = new ThumbnailService(this);
+        connect(m_thumbnailService, &ThumbnailService::thumbnailCreated, this, &SpeedDial::thumbnailCreated);
+    }
+
+    const QUrl pageUrl = QUrl::fromEncoded(url.toUtf8());
+    if (loadTitle) {
+        m_loadTitleUrls.insert(pageUrl.toString());
+    }
 
-    thumbnailer->start();
+    // Thumbnails of dials visible on screen are rendered first
+    m_thumbnailService->requestThumbnail(pageUrl, thumbnailPath(thumbnailHash(pageUrl.toString())),
+                                         highPriority ? ThumbnailService::HighPriority : ThumbnailService::NormalPriority);
 }
 
 void SpeedDial::removeImageForUrl(const QString &url)
 {
-    QString fileName = m_thumbnailsDir + QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+    ENSURE_LOADED;
+
+    QString fileName = thumbnailPath(thumbnailHash(url));
 
     if (QFile(fileName).exists()) {
         QFile(fileName).remove();
     }
 }
 
+QString SpeedDial::thumbnailPath(const QString &hash)
+{
+    ENSURE_LOADED;
+
+    // Hash comes from request url
+    static const QRegularExpression hashRegExp(QSL("^[0-9a-f]{32}$"));
+    if (!hashRegExp.match(hash).hasMatch()) {
+        return QString();
+    }
+
+    return m_thumbnailsDir + hash + QSL(".png");
+}
+
+QString SpeedDial::thumbnailUrl(const QString &url)
+{
+    const QString hash = thumbnailHash(url);
+    const QFileInfo info(thumbnailPath(hash));
+    if (!info.exists()) {
+        return QString();
+    }
+
+#if QTWEBENGINEWIDGETS_VERSION < QT_VERSION_CHECK(5, 11, 0)
+    // Scheme handler can't check who requested the thumbnail
+    return QzTools::pixmapToDataUrl(QPixmap(info.filePath())).toString();
+#else
+    // New url for regenerated thumbnail, so the page doesn't show cached one
+    return QSL("falkon:speeddial-thumbnail?h=%1&v=%2").arg(hash, QString::number(info.lastModified().toMSecsSinceEpoch()));
+#endif
+}
+
+// static
+QString SpeedDial::thumbnailHash(const QString &url)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md4).toHex());
+}
+
 QStringList SpeedDial::getOpenFileName()
 {
     const QString fileTypes = QString("%3(*.png *.jpg *.jpeg *.bmp *.gif *.svg *.tiff)").arg(tr("Image files"));
@@ -319,36 +363,27 @@ void SpeedDial::setSdCentered(bool centered)
     m_autoSaver->changeOccurred();
 }
 
-void SpeedDial::thumbnailCreated(const QPixmap &pixmap)
+void SpeedDial::thumbnailCreated(const QUrl &pageUrl, bool success, const QString &pageTitle)
 {
-    PageThumbnailer* thumbnailer = qobject_cast<PageThumbnailer*>(sender());
-    if (!thumbnailer) {
-        return;
-    }
+    const QString url = pageUrl.toString();
+    QString title = pageTitle;
+    QString imgSource;
 
-    bool loadTitle = thumbnailer->loadTitle();
-    QString title = thumbnailer->title();
-    QString url = thumbnailer->url().toString();
-    QString fileName = m_thumbnailsDir + QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+    if (success) {
+        imgSource = thumbnailUrl(url);
+    }
 
-    if (pixmap.isNull()) {
-        fileName = ":/html/broken-page.svg";
+    if (imgSource.isEmpty()) {
+        imgSource = QSL("qrc:html/broken-page.svg");
         title = tr("Unable to load");
     }
-    else {
-        if (!pixmap.save(fileName, "PNG")) {
-            qWarning() << "SpeedDial::thumbnailCreated Cannot save thumbnail to " << fileName;
-        }
-        //fileName = QUrl::fromLocalFile(fileName).toString();
-    }
 
     m_regenerateScript = true;
-    thumbnailer->deleteLater();
 
-    if (loadTitle)
+    if (m_loadTitleUrls.remove(url))
         emit pageTitleLoaded(url, title);
 
-    emit thumbnailLoaded(url, QzTools::pixmapToDataUrl(QPixmap(fileName)).toString());
+    emit thumbnailLoaded(url, imgSource);
 }
 
 QString SpeedDial::escapeTitle(QString title) const
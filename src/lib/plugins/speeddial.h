@@ -20,15 +20,15 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 #include <QWebEnginePage>
 
 #include "qzcommon.h"
 
 class QUrl;
-class QPixmap;
 
 class AutoSaver;
-class PageThumbnailer;
+class ThumbnailService;
 
 class FALKON_EXPORT SpeedDial : public QObject
 {
@@ -69,6 +69,9 @@ public:
     QString initialScript();
     QList<Page> pages();
 
+    // Thumbnail file for hash from falkon:speeddial-thumbnail url, empty if hash is invalid
+    QString thumbnailPath(const QString &hash);
+
 Q_SIGNALS:
     void pagesChanged();
     void thumbnailLoaded(const QString &url, const QString &src);
@@ -76,7 +79,7 @@ Q_SIGNALS:
 
 public Q_SLOTS:
     void changed(const QString &allPages);
-    void loadThumbnail(const QString &url, bool loadTitle);
+    void loadThumbnail(const QString &url, bool loadTitle, bool highPriority);
     void removeImageForUrl(const QString &url);
 
     QStringList getOpenFileName();
@@ -88,7 +91,7 @@ public Q_SLOTS:
     void setSdCentered(bool centered);
 
 private Q_SLOTS:
-    void thumbnailCreated(const QPixmap &pixmap);
+    void thumbnailCreated(const QUrl &pageUrl, bool success, const QString &pageTitle);
     void saveSettings();
 
 private:
@@ -97,6 +100,9 @@ private:
 
     QString generateAllPages();
 
+    QString thumbnailUrl(const QString &url);
+    static QString thumbnailHash(const QString &url);
+
     QString m_initialScript;
     QString m_thumbnailsDir;
     QString m_backgroundImage;
@@ -111,6 +117,9 @@ private:
 
     bool m_loaded;
     bool m_regenerateScript;
+
+    ThumbnailService* m_thumbnailService;
+    QSet<QString> m_loadTitleUrls;
 };
 
 #endif // SPEEDDIAL_H
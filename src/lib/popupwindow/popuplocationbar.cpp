@@ -90,14 +90,22 @@ void PopupLocationBar::stopLoading()
 
     WebPage* page = qobject_cast<WebPage*>(m_view->page());
 
-    if (page && !page->autoFillUsernames().isEmpty()) {
-        m_autofillIcon->setUsernames(page->autoFillUsernames());
-        m_autofillIcon->show();
+    if (page) {
+        showAutoFillIcon(page->autoFillUsernames());
     }
 
     updateTextMargins();
 }
 
+void PopupLocationBar::showAutoFillIcon(const QStringList &usernames)
+{
+    if (!usernames.isEmpty()) {
+        m_autofillIcon->setUsernames(usernames);
+        m_autofillIcon->show();
+        updateTextMargins();
+    }
+}
+
 void PopupLocationBar::showUrl(const QUrl &url)
 {
     setText(QzTools::urlEncodeQueryString(url));
@@ -47,6 +47,7 @@ public Q_SLOTS:
     void showUrl(const QUrl &url);
     void showSiteIcon();
     void setPrivacyState(bool state);
+    void showAutoFillIcon(const QStringList &usernames);
 
 private:
     PopupWebView* m_view;
@@ -144,6 +144,7 @@ PopupWindow::PopupWindow(PopupWebView* view)
     connect(m_view, &WebView::loadProgress, this, &PopupWindow::loadProgress);
     connect(m_view, &WebView::loadFinished, this, &PopupWindow::loadFinished);
     connect(m_view, &WebView::privacyChanged, m_locationBar, &PopupLocationBar::setPrivacyState);
+    connect(m_view, &WebView::autoFillUsernamesChanged, m_locationBar, &PopupLocationBar::showAutoFillIcon);
 
     auto pageChanged = [this](WebPage *page) {
         connect(page, &WebPage::linkHovered, this, &PopupWindow::showStatusBarMessage);
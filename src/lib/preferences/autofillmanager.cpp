@@ -280,6 +280,8 @@ void AutoFillManager::removeExcept()
     query.addBindValue(id);
     query.exec();
 
+    mApp->autoFill()->reloadExceptions();
+
     delete curItem;
 }
 
@@ -288,6 +290,8 @@ void AutoFillManager::removeAllExcept()
     QSqlQuery query(SqlDatabase::instance()->database());
     query.exec("DELETE FROM autofill_exceptions");
 
+    mApp->autoFill()->reloadExceptions();
+
     ui->treeExcept->clear();
 }
 
@@ -18,6 +18,7 @@
 * ============================================================ */
 #include "restoremanager.h"
 #include "recoveryjsobject.h"
+#include "sessionjournal.h"
 #include "datapaths.h"
 
 #include <QFile>
@@ -41,6 +42,20 @@ void RestoreData::clear()
     closedWindows.clear();
 }
 
+void RestoreData::writeWithEncodedTabs(QDataStream &stream, const QVector<QVector<QByteArray>> &encodedTabs) const
+{
+    Q_ASSERT(windows.count() == encodedTabs.count());
+
+    stream << windows.count();
+    for (int i = 0; i < windows.count(); ++i) {
+        windows.at(i).writeWithEncodedTabs(stream, encodedTabs.at(i));
+    }
+
+    stream << restoreDataVersion;
+    stream << crashedSession;
+    stream << closedWindows;
+}
+
 QDataStream &operator<<(QDataStream &stream, const RestoreData &data)
 {
     stream << data.windows.count();
@@ -179,13 +194,15 @@ void RestoreManager::createFromFile(const QString &file, RestoreData &data)
         return;
     }
 
-    QDataStream stream(&recoveryFile);
+    const QByteArray sessionData = recoveryFile.readAll();
+    QDataStream stream(sessionData);
 
     int version;
     stream >> version;
 
     if (version == Qz::sessionVersion) {
         loadCurrentVersion(stream, data);
+        SessionJournal::replay(file, sessionData, data);
     } else if (version == 0x0003 || version == (0x0003 | 0x050000)) {
         loadVersion3(stream, data);
     } else {
@@ -34,6 +34,9 @@ struct FALKON_EXPORT RestoreData
     bool isValid() const;
     void clear();
 
+    // Writes data in format of operator<<, with tabs of each window already serialized
+    void writeWithEncodedTabs(QDataStream &stream, const QVector<QVector<QByteArray>> &encodedTabs) const;
+
     friend FALKON_EXPORT QDataStream &operator<<(QDataStream &stream, const RestoreData &data);
     friend FALKON_EXPORT QDataStream &operator>>(QDataStream &stream, RestoreData &data);
 };
@@ -0,0 +1,476 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "sessionjournal.h"
+#include "restoremanager.h"
+#include "mainapplication.h"
+#include "closedwindowsmanager.h"
+#include "tabwidget.h"
+#include "webtab.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QWebEngineHistory>
+#include <QCryptographicHash>
+#include <QtConcurrent/QtConcurrentRun>
+
+static const quint32 s_journalMagic = 0x464a4e4c;
+static const qint32 s_journalVersion = 1;
+
+// Journal is compacted into session file once it is bigger than session file, but not sooner than this
+static const qint64 s_minCompactSize = 512 * 1024;
+
+bool SessionJournal::TabSignature::operator==(const TabSignature &other) const
+{
+    return url == other.url &&
+           title == other.title &&
+           isRestored == other.isRestored &&
+           isPinned == other.isPinned &&
+           zoomLevel == other.zoomLevel &&
+           historyCount == other.historyCount &&
+           historyIndex == other.historyIndex &&
+           parentTab == other.parentTab &&
+           childTabs == other.childTabs &&
+           sessionData == other.sessionData;
+}
+
+SessionJournal::SessionJournal(QObject *parent)
+    : QObject(parent)
+    , m_lastTabId(0)
+    , m_hasBase(false)
+    , m_snapshotSize(0)
+    , m_journalSize(0)
+    , m_compacting(false)
+    , m_savePending(false)
+{
+    m_compaction = new QFutureWatcher<QPair<qint64, qint64>>(this);
+    connect(m_compaction, &QFutureWatcher<QPair<qint64, qint64>>::finished, this, &SessionJournal::compactionFinished);
+}
+
+SessionJournal::~SessionJournal()
+{
+    m_compaction->waitForFinished();
+}
+
+void SessionJournal::save(const QString &filePath)
+{
+    if (m_compacting) {
+        m_savePending = true;
+        return;
+    }
+
+    if (filePath != m_filePath) {
+        clearState();
+        m_filePath = filePath;
+    }
+
+    RestoreData data;
+    QVector<QVector<quint32>> tabIds;
+    QVector<QVector<QByteArray>> encodedTabs;
+    QHash<WebTab*, TabState> tabs;
+    QVector<QPair<quint32, QByteArray>> changedTabs;
+
+    const auto windows = mApp->windows();
+    for (BrowserWindow *window : windows) {
+        BrowserWindow::SavedWindow savedWindow(window, /*withTabs*/ false);
+        QVector<quint32> ids;
+        QVector<QByteArray> encoded;
+
+        // Same tabs as saved by BrowserWindow::SavedWindow
+        for (int i = 0; i < window->tabCount(); ++i) {
+            WebTab *webTab = window->tabWidget()->webTab(i);
+            if (!webTab) {
+                continue;
+            }
+
+            TabState state = m_tabs.take(webTab);
+            const TabSignature signature = tabSignature(webTab);
+            const bool changed = !state.tab || !(state.signature == signature);
+
+            if (changed) {
+                const WebTab::SavedTab tab(webTab);
+                if (!tab.isValid()) {
+                    continue;
+                }
+                if (!state.tab) {
+                    state.tab = webTab;
+                    state.id = ++m_lastTabId;
+                }
+                state.signature = signature;
+                state.data.clear();
+                QDataStream stream(&state.data, QIODevice::WriteOnly);
+                stream << tab;
+            }
+
+            if (webTab->isCurrentTab()) {
+                savedWindow.currentTab = ids.size();
+            }
+            if (changed) {
+                changedTabs.append(qMakePair(state.id, state.data));
+            }
+
+            ids.append(state.id);
+            encoded.append(state.data);
+            tabs.insert(webTab, state);
+        }
+
+        data.windows.append(savedWindow);
+        tabIds.append(ids);
+        encodedTabs.append(encoded);
+    }
+
+    m_tabs = tabs;
+
+    const QByteArray windowsRecord = encodeWindows(data.windows, tabIds);
+    data.closedWindows = mApp->closedWindowsManager()->saveState();
+
+    if (!m_hasBase || m_journalSize > qMax(m_snapshotSize, s_minCompactSize)) {
+        m_windows = windowsRecord;
+        m_closedWindows = data.closedWindows;
+        compact(data, encodedTabs);
+        return;
+    }
+
+    QByteArray records;
+    QDataStream stream(&records, QIODevice::WriteOnly);
+
+    for (const auto &tab : qAsConst(changedTabs)) {
+        QByteArray payload;
+        QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+        payloadStream << tab.first;
+        payloadStream.writeRawData(tab.second.constData(), tab.second.size());
+        writeRecord(stream, TabRecord, payload);
+    }
+
+    if (windowsRecord != m_windows) {
+        writeRecord(stream, WindowsRecord, windowsRecord);
+    }
+
+    if (data.closedWindows != m_closedWindows) {
+        writeRecord(stream, ClosedWindowsRecord, data.closedWindows);
+    }
+
+    if (records.isEmpty()) {
+        return;
+    }
+
+    QFile file(journalPath(m_filePath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(records) != records.size()) {
+        qWarning() << "SessionJournal: Cannot write" << file.fileName() << file.errorString();
+        // Whole session file will be written on next save
+        clearState();
+        return;
+    }
+
+    m_windows = windowsRecord;
+    m_closedWindows = data.closedWindows;
+    m_journalSize += records.size();
+}
+
+void SessionJournal::discard(const QString &filePath)
+{
+    waitForFinished();
+
+    QFile::remove(journalPath(filePath));
+
+    if (filePath == m_filePath) {
+        clearState();
+    }
+}
+
+void SessionJournal::waitForFinished()
+{
+    if (!m_compacting) {
+        return;
+    }
+
+    m_savePending = false;
+    m_compaction->waitForFinished();
+    compactionFinished();
+}
+
+// static
+QString SessionJournal::journalPath(const QString &filePath)
+{
+    return filePath + QL1S(".journal");
+}
+
+// static
+void SessionJournal::replay(const QString &filePath, const QByteArray &sessionData, RestoreData &data)
+{
+    QFile file(journalPath(filePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+
+    quint32 magic;
+    qint32 version;
+    stream >> magic >> version;
+
+    if (magic != s_journalMagic || version != s_journalVersion) {
+        return;
+    }
+
+    QVector<BrowserWindow::SavedWindow> windows;
+    QVector<QVector<quint32>> tabIds;
+    QHash<quint32, WebTab::SavedTab> tabs;
+    QByteArray closedWindows = data.closedWindows;
+    bool hasBase = false;
+
+    while (!stream.atEnd()) {
+        quint8 type;
+        QByteArray payload;
+        quint16 checksum;
+        stream >> type >> payload >> checksum;
+
+        // Last record may be incomplete after crash
+        if (stream.status() != QDataStream::Ok || checksum != qChecksum(payload.constData(), payload.size())) {
+            break;
+        }
+
+        QDataStream payloadStream(payload);
+
+        if (!hasBase) {
+            // Journal written for different session file, it was replaced after the journal
+            QByteArray hash;
+            payloadStream >> hash;
+            if (type != BaseRecord || hash != QCryptographicHash::hash(sessionData, QCryptographicHash::Sha1)) {
+                return;
+            }
+
+            if (!decodeWindows(payloadStream, windows, tabIds) || windows.count() != data.windows.count()) {
+                return;
+            }
+
+            for (int i = 0; i < data.windows.count(); ++i) {
+                const QVector<WebTab::SavedTab> &windowTabs = data.windows.at(i).tabs;
+                if (windowTabs.count() != tabIds.at(i).count()) {
+                    return;
+                }
+                for (int j = 0; j < windowTabs.count(); ++j) {
+                    tabs.insert(tabIds.at(i).at(j), windowTabs.at(j));
+                }
+            }
+
+            hasBase = true;
+            continue;
+        }
+
+        switch (type) {
+        case TabRecord: {
+            quint32 id;
+            WebTab::SavedTab tab;
+            payloadStream >> id >> tab;
+            tabs.insert(id, tab);
+            break;
+        }
+
+        case WindowsRecord: {
+            QVector<BrowserWindow::SavedWindow> newWindows;
+            QVector<QVector<quint32>> newTabIds;
+            if (decodeWindows(payloadStream, newWindows, newTabIds)) {
+                windows = newWindows;
+                tabIds = newTabIds;
+            }
+            break;
+        }
+
+        case ClosedWindowsRecord:
+            closedWindows = payload;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (!hasBase) {
+        return;
+    }
+
+    data.windows.clear();
+    for (int i = 0; i < windows.count(); ++i) {
+        BrowserWindow::SavedWindow window = windows.at(i);
+        for (quint32 id : tabIds.at(i)) {
+            auto it = tabs.constFind(id);
+            if (it != tabs.constEnd()) {
+                window.tabs.append(it.value());
+            }
+        }
+        window.currentTab = qMin(window.currentTab, window.tabs.count() - 1);
+        data.windows.append(window);
+    }
+    data.closedWindows = closedWindows;
+}
+
+void SessionJournal::clearState()
+{
+    m_tabs.clear();
+    m_windows.clear();
+    m_closedWindows.clear();
+    m_hasBase = false;
+    m_snapshotSize = 0;
+    m_journalSize = 0;
+}
+
+void SessionJournal::compact(const RestoreData &data, const QVector<QVector<QByteArray>> &encodedTabs)
+{
+    RestoreData snapshot = data;
+
+    RestoreManager *restoreManager = mApp->restoreManager();
+    if (restoreManager && restoreManager->isValid()) {
+        QDataStream stream(&snapshot.crashedSession, QIODevice::WriteOnly);
+        stream << restoreManager->restoreData();
+    }
+
+    const QString filePath = m_filePath;
+    const QByteArray windows = m_windows;
+
+    m_compacting = true;
+    m_compaction->setFuture(QtConcurrent::run([=]() {
+        return writeSnapshot(filePath, snapshot, encodedTabs, windows);
+    }));
+}
+
+void SessionJournal::compactionFinished()
+{
+    if (!m_compacting) {
+        return;
+    }
+
+    m_compacting = false;
+
+    const QPair<qint64, qint64> result = m_compaction->result();
+    if (result.first < 0) {
+        clearState();
+    } else {
+        m_hasBase = true;
+        m_snapshotSize = result.first;
+        m_journalSize = result.second;
+    }
+
+    if (m_savePending) {
+        m_savePending = false;
+        save(m_filePath);
+    }
+}
+
+// static
+SessionJournal::TabSignature SessionJournal::tabSignature(WebTab *tab)
+{
+    TabSignature signature;
+    signature.url = tab->url();
+    signature.title = tab->title();
+    signature.isRestored = tab->isRestored();
+    signature.isPinned = tab->isPinned();
+    signature.zoomLevel = tab->zoomLevel();
+    signature.parentTab = tab->parentTab() ? tab->parentTab()->tabIndex() : -1;
+    signature.sessionData = tab->sessionData();
+
+    if (signature.isRestored && tab->hasWebView()) {
+        signature.historyCount = tab->history()->count();
+        signature.historyIndex = tab->history()->currentItemIndex();
+    }
+
+    const auto children = tab->childTabs();
+    signature.childTabs.reserve(children.count());
+    for (WebTab *child : children) {
+        signature.childTabs.append(child->tabIndex());
+    }
+
+    return signature;
+}
+
+// static
+QByteArray SessionJournal::encodeWindows(const QVector<BrowserWindow::SavedWindow> &windows, const QVector<QVector<quint32>> &tabIds)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream << windows.count();
+    for (int i = 0; i < windows.count(); ++i) {
+        stream << windows.at(i);
+        stream << tabIds.at(i);
+    }
+
+    return data;
+}
+
+// static
+bool SessionJournal::decodeWindows(QDataStream &stream, QVector<BrowserWindow::SavedWindow> &windows, QVector<QVector<quint32>> &tabIds)
+{
+    int count = -1;
+    stream >> count;
+
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        BrowserWindow::SavedWindow window;
+        QVector<quint32> ids;
+        stream >> window >> ids;
+        windows.append(window);
+        tabIds.append(ids);
+    }
+
+    return count >= 0 && stream.status() == QDataStream::Ok;
+}
+
+// static
+void SessionJournal::writeRecord(QDataStream &stream, RecordType type, const QByteArray &payload)
+{
+    stream << quint8(type);
+    stream << payload;
+    stream << qChecksum(payload.constData(), payload.size());
+}
+
+// static
+QPair<qint64, qint64> SessionJournal::writeSnapshot(const QString &filePath, const RestoreData &data,
+                                                    const QVector<QVector<QByteArray>> &encodedTabs, const QByteArray &windows)
+{
+    // Same format as MainApplication::saveState()
+    QByteArray snapshot;
+    QDataStream stream(&snapshot, QIODevice::WriteOnly);
+    stream << Qz::sessionVersion;
+    data.writeWithEncodedTabs(stream, encodedTabs);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(snapshot) == -1 || !file.commit()) {
+        qWarning() << "SessionJournal: Cannot write" << filePath << file.errorString();
+        return qMakePair(qint64(-1), qint64(-1));
+    }
+
+    // Base record ties journal to this snapshot and assigns ids to its tabs
+    QByteArray base;
+    QDataStream baseStream(&base, QIODevice::WriteOnly);
+    baseStream << QCryptographicHash::hash(snapshot, QCryptographicHash::Sha1);
+    baseStream.writeRawData(windows.constData(), windows.size());
+
+    QByteArray journal;
+    QDataStream journalStream(&journal, QIODevice::WriteOnly);
+    journalStream << s_journalMagic << s_journalVersion;
+    writeRecord(journalStream, BaseRecord, base);
+
+    QSaveFile journalFile(journalPath(filePath));
+    if (!journalFile.open(QIODevice::WriteOnly) || journalFile.write(journal) == -1 || !journalFile.commit()) {
+        qWarning() << "SessionJournal: Cannot write" << journalFile.fileName() << journalFile.errorString();
+        return qMakePair(qint64(-1), qint64(-1));
+    }
+
+    return qMakePair(qint64(snapshot.size()), qint64(journal.size()));
+}
@@ -0,0 +1,118 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef SESSIONJOURNAL_H
+#define SESSIONJOURNAL_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QPointer>
+#include <QUrl>
+
+#include "qzcommon.h"
+#include "browserwindow.h"
+
+template<typename T>
+class QFutureWatcher;
+
+class WebTab;
+struct RestoreData;
+
+// Session file saved incrementally: the session file is base snapshot and changes
+// since it was written are appended to journal next to it. Only tabs that changed
+// are serialized on save, session file is rewritten in background once journal grows.
+class FALKON_EXPORT SessionJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionJournal(QObject *parent = nullptr);
+    ~SessionJournal();
+
+    void save(const QString &filePath);
+
+    // Forgets saved state and removes journal of session file
+    void discard(const QString &filePath);
+    void waitForFinished();
+
+    static QString journalPath(const QString &filePath);
+
+    // Applies journal on top of data loaded from session file with sessionData contents
+    static void replay(const QString &filePath, const QByteArray &sessionData, RestoreData &data);
+
+private:
+    enum RecordType {
+        BaseRecord = 1,
+        TabRecord = 2,
+        WindowsRecord = 3,
+        ClosedWindowsRecord = 4
+    };
+
+    // Cheap to compute state of tab, tab is serialized again only when it changes
+    struct TabSignature {
+        QUrl url;
+        QString title;
+        bool isRestored = false;
+        bool isPinned = false;
+        int zoomLevel = 0;
+        int historyCount = 0;
+        int historyIndex = 0;
+        int parentTab = -1;
+        QVector<int> childTabs;
+        QHash<QString, QVariant> sessionData;
+
+        bool operator==(const TabSignature &other) const;
+    };
+
+    struct TabState {
+        QPointer<WebTab> tab;
+        quint32 id = 0;
+        TabSignature signature;
+        QByteArray data;
+    };
+
+    void clearState();
+    void compact(const RestoreData &data, const QVector<QVector<QByteArray>> &encodedTabs);
+    void compactionFinished();
+
+    static TabSignature tabSignature(WebTab *tab);
+    static QByteArray encodeWindows(const QVector<BrowserWindow::SavedWindow> &windows, const QVector<QVector<quint32>> &tabIds);
+    static bool decodeWindows(QDataStream &stream, QVector<BrowserWindow::SavedWindow> &windows, QVector<QVector<quint32>> &tabIds);
+    static void writeRecord(QDataStream &stream, RecordType type, const QByteArray &payload);
+    static QPair<qint64, qint64> writeSnapshot(const QString &filePath, const RestoreData &data,
+                                               const QVector<QVector<QByteArray>> &encodedTabs, const QByteArray &windows);
+
+    QString m_filePath;
+    QHash<WebTab*, TabState> m_tabs;
+    quint32 m_lastTabId;
+
+    // Last written windows and closed windows records
+    QByteArray m_windows;
+    QByteArray m_closedWindows;
+
+    bool m_hasBase;
+    qint64 m_snapshotSize;
+    qint64 m_journalSize;
+
+    bool m_compacting;
+    bool m_savePending;
+    QFutureWatcher<QPair<qint64, qint64>> *m_compaction;
+};
+
+#endif // SESSIONJOURNAL_H
@@ -20,6 +20,7 @@
 #include "datapaths.h"
 #include "mainapplication.h"
 #include "restoremanager.h"
+#include "sessionjournal.h"
 #include "sessionmanager.h"
 #include "sessionmanagerdialog.h"
 #include "settings.h"
@@ -37,10 +38,32 @@
 #include <QVBoxLayout>
 #include <QSaveFile>
 
+// Session file is copied, moved and removed together with its journal
+static bool copySessionFile(const QString &from, const QString &to)
+{
+    QFile::remove(SessionJournal::journalPath(to));
+    QFile::copy(SessionJournal::journalPath(from), SessionJournal::journalPath(to));
+    return QFile::copy(from, to);
+}
+
+static bool moveSessionFile(const QString &from, const QString &to)
+{
+    QFile::remove(SessionJournal::journalPath(to));
+    QFile::rename(SessionJournal::journalPath(from), SessionJournal::journalPath(to));
+    return QFile::rename(from, to);
+}
+
+static void removeSessionFile(const QString &filePath)
+{
+    QFile::remove(SessionJournal::journalPath(filePath));
+    QFile::remove(filePath);
+}
+
 SessionManager::SessionManager(QObject* parent)
     : QObject(parent)
     , m_firstBackupSession(DataPaths::currentProfilePath() + QL1S("/session.dat.old"))
     , m_secondBackupSession(DataPaths::currentProfilePath() + QL1S("/session.dat.old1"))
+    , m_journal(new SessionJournal(this))
 {
     QFileSystemWatcher* sessionFilesWatcher = new QFileSystemWatcher({DataPaths::path(DataPaths::Sessions)}, this);
     connect(sessionFilesWatcher, &QFileSystemWatcher::directoryChanged, this, &SessionManager::sessionsDirectoryChanged);
@@ -138,13 +161,17 @@ void SessionManager::renameSession(QString sessionFilePath, SessionFlags flags)
         return;
     }
 
+    if (isActive(sessionFilePath)) {
+        m_journal->waitForFinished();
+    }
+
     if (flags.testFlag(CloneSession)) {
-        if (!QFile::copy(sessionFilePath, newSessionPath)) {
+        if (!copySessionFile(sessionFilePath, newSessionPath)) {
             QMessageBox::information(mApp->activeWindow(), tr("Error!"), tr("An error occurred when cloning session file."));
             return;
         }
     } else {
-        if (!QFile::rename(sessionFilePath, newSessionPath)) {
+        if (!moveSessionFile(sessionFilePath, newSessionPath)) {
             QMessageBox::information(mApp->activeWindow(), tr("Error!"), tr("An error occurred when renaming session file."));
             return;
         }
@@ -199,7 +226,7 @@ void SessionManager::deleteSession(const QString &filePath)
     QMessageBox::StandardButton result = QMessageBox::information(mApp->activeWindow(), tr("Delete Session"), tr("Are you sure you want to delete session '%1'?")
                                                                   .arg(QFileInfo(filePath).completeBaseName()), QMessageBox::Yes | QMessageBox::No);
     if (result == QMessageBox::Yes) {
-        QFile::remove(filePath);
+        removeSessionFile(filePath);
     }
 }
 
@@ -280,6 +307,9 @@ void SessionManager::fillSessionsMetaDataListIfNeeded()
     for (int i = 0; i < sessionFiles.size(); ++i) {
         const QFileInfo &fileInfo = sessionFiles.at(i);
 
+        if (fileInfo.fileName().endsWith(QL1S(".journal")))
+            continue;
+
         if (!RestoreManager::validateFile(fileInfo.absoluteFilePath()))
             continue;
 
@@ -351,22 +381,36 @@ void SessionManager::backupSavedSessions()
     }
 
     if (QFile::exists(m_firstBackupSession)) {
-        QFile::remove(m_secondBackupSession);
-        QFile::copy(m_firstBackupSession, m_secondBackupSession);
+        removeSessionFile(m_secondBackupSession);
+        copySessionFile(m_firstBackupSession, m_secondBackupSession);
     }
 
-    QFile::remove(m_firstBackupSession);
-    QFile::copy(m_lastActiveSessionPath, m_firstBackupSession);
+    removeSessionFile(m_firstBackupSession);
+    copySessionFile(m_lastActiveSessionPath, m_firstBackupSession);
 }
 
 void SessionManager::writeCurrentSession(const QString &filePath)
 {
+    m_journal->waitForFinished();
+
     QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly) || file.write(mApp->saveState()) == -1) {
         qWarning() << "Error! can not write the current session file: " << filePath << file.errorString();
         return;
     }
-    file.commit();
+    if (file.commit()) {
+        m_journal->discard(filePath);
+    }
+}
+
+void SessionManager::writeLastSession()
+{
+    if (mApp->isPrivate() || mApp->windowCount() == 0) {
+        return;
+    }
+
+    saveSettings();
+    writeCurrentSession(m_lastActiveSessionPath);
 }
 
 void SessionManager::openSessionManagerDialog()
@@ -382,7 +426,7 @@ void SessionManager::autoSaveLastSession()
     }
 
     saveSettings();
-    writeCurrentSession(m_lastActiveSessionPath);
+    m_journal->save(m_lastActiveSessionPath);
 }
 
 QString SessionManager::askSessionFromUser()
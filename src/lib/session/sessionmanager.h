@@ -24,6 +24,8 @@ class QAction;
 class QMenu;
 class QFileInfo;
 
+class SessionJournal;
+
 class FALKON_EXPORT SessionManager : public QObject
 {
     Q_OBJECT
@@ -56,6 +58,9 @@ public:
     void backupSavedSessions();
     void writeCurrentSession(const QString &filePath);
 
+    // Writes whole last session file, without journal
+    void writeLastSession();
+
 Q_SIGNALS:
     void sessionsMetaDataChanged();
 
@@ -89,6 +94,8 @@ private:
     QString m_secondBackupSession;
     QString m_lastActiveSessionPath;
 
+    SessionJournal *m_journal;
+
     friend class SessionManagerDialog;
 };
 
@@ -113,7 +113,7 @@ void TabContextMenu::init()
             return;
         }
 
-        if (m_window->weView(m_clickedTab)->isLoading()) {
+        if (webTab->isLoading()) {
             addAction(QIcon::fromTheme(QSL("process-stop")), tr("&Stop Tab"), this, SLOT(stopTab()));
         }
         else {
@@ -0,0 +1,234 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "tabdiscardmanager.h"
+#include "mainapplication.h"
+#include "browserwindow.h"
+#include "tabwidget.h"
+#include "tabbedwebview.h"
+#include "webtab.h"
+#include "webpage.h"
+#include "settings.h"
+
+#include <QFile>
+#include <QTimer>
+#include <QSet>
+#include <QtWebEngineWidgetsVersion>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// Interval between checks while tabs are still being discarded
+static const int s_pressureInterval = 2000;
+
+TabDiscardManager::TabDiscardManager(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &TabDiscardManager::checkMemory);
+
+    connect(mApp, &MainApplication::settingsReloaded, this, &TabDiscardManager::loadSettings);
+    loadSettings();
+}
+
+bool TabDiscardManager::isEnabled() const
+{
+    return m_enabled;
+}
+
+TabDiscardManager::Stats TabDiscardManager::stats() const
+{
+    return m_stats;
+}
+
+// static
+bool TabDiscardManager::isSupported()
+{
+    return processMemory(0) >= 0;
+}
+
+QVector<WebTab*> TabDiscardManager::discardableTabs() const
+{
+    const QDateTime inactiveSince = QDateTime::currentDateTimeUtc().addMSecs(-m_minInactiveTime);
+
+    QVector<WebTab*> tabs;
+    const auto windows = mApp->windows();
+    for (BrowserWindow *window : windows) {
+        const auto allTabs = window->tabWidget()->allTabs();
+        for (WebTab *tab : allTabs) {
+            if (!tab->hasWebView() || !tab->isRestored() || tab->isCurrentTab() || tab->isPinned()) {
+                continue;
+            }
+            if (tab->isPlaying() || tab->webView()->page()->isFormModified()) {
+                continue;
+            }
+            if (tab->lastActivated() > inactiveSince) {
+                continue;
+            }
+            tabs.append(tab);
+        }
+    }
+
+    std::sort(tabs.begin(), tabs.end(), [](WebTab *a, WebTab *b) {
+        return a->lastActivated() < b->lastActivated();
+    });
+
+    return tabs;
+}
+
+int TabDiscardManager::discardTabs(int count)
+{
+    const QVector<WebTab*> tabs = discardableTabs();
+
+    int discarded = 0;
+    for (WebTab *tab : tabs) {
+        if (discarded == count) {
+            break;
+        }
+        tab->unload();
+        ++discarded;
+    }
+
+    if (discarded > 0) {
+        m_stats.discardedTabs += discarded;
+        m_stats.lastDiscard = QDateTime::currentDateTime();
+    }
+
+    return discarded;
+}
+
+// static
+qint64 TabDiscardManager::processMemory(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    QFile file(pid > 0 ? QSL("/proc/%1/statm").arg(pid) : QSL("/proc/self/statm"));
+    if (!file.open(QFile::ReadOnly)) {
+        return -1;
+    }
+    // Second field is resident set size in pages
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    Q_UNUSED(pid)
+    return -1;
+#endif
+}
+
+// static
+qint64 TabDiscardManager::parseMemInfo(const QByteArray &meminfo, const char *key)
+{
+    const QByteArray prefix = QByteArray(key) + ':';
+    const QList<QByteArray> lines = meminfo.split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.startsWith(prefix)) {
+            continue;
+        }
+        // Values are in kB
+        const QList<QByteArray> fields = line.mid(prefix.size()).simplified().split(' ');
+        bool ok;
+        const qint64 value = fields.at(0).toLongLong(&ok);
+        return ok ? value * 1024 : -1;
+    }
+    return -1;
+}
+
+void TabDiscardManager::checkMemory()
+{
+    m_stats.lastCheck = QDateTime::currentDateTime();
+    m_stats.loadedTabs = 0;
+
+    QSet<qint64> pids;
+    const auto windows = mApp->windows();
+    for (BrowserWindow *window : windows) {
+        const auto allTabs = window->tabWidget()->allTabs();
+        for (WebTab *tab : allTabs) {
+            if (!tab->hasWebView()) {
+                continue;
+            }
+            m_stats.loadedTabs++;
+#if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+            pids.insert(tab->webView()->page()->renderProcessPid());
+#endif
+        }
+    }
+
+    // Renderer processes may be shared between tabs
+    m_stats.rss = processMemory(0);
+    for (qint64 pid : qAsConst(pids)) {
+        const qint64 rss = pid > 0 ? processMemory(pid) : -1;
+        if (rss > 0 && m_stats.rss >= 0) {
+            m_stats.rss += rss;
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    QFile file(QSL("/proc/meminfo"));
+    if (file.open(QFile::ReadOnly)) {
+        const QByteArray meminfo = file.readAll();
+        m_stats.availableMemory = parseMemInfo(meminfo, "MemAvailable");
+        m_stats.totalMemory = parseMemInfo(meminfo, "MemTotal");
+    }
+#endif
+
+    int interval = m_checkInterval;
+    if (m_enabled && isUnderPressure() && discardTabs(1) > 0) {
+        // Memory of discarded tab is not released immediately
+        interval = s_pressureInterval;
+    }
+
+    if (m_enabled) {
+        m_timer->start(interval);
+    }
+}
+
+void TabDiscardManager::loadSettings()
+{
+    Settings settings;
+    settings.beginGroup(QSL("TabDiscarding"));
+    m_enabled = settings.value(QSL("Enabled"), false).toBool() && isSupported();
+    m_checkInterval = qMax(1, settings.value(QSL("CheckInterval"), 30).toInt()) * 1000;
+    m_maxMemory = settings.value(QSL("MaxMemoryMB"), 0).toLongLong() * 1024 * 1024;
+    m_minAvailableMemory = settings.value(QSL("MinAvailableMemoryPercent"), 10).toInt();
+    m_minInactiveTime = settings.value(QSL("MinInactiveMinutes"), 5).toLongLong() * 60 * 1000;
+    settings.endGroup();
+
+    if (m_enabled) {
+        m_timer->start(m_checkInterval);
+    } else {
+        m_timer->stop();
+    }
+}
+
+bool TabDiscardManager::isUnderPressure() const
+{
+    if (m_maxMemory > 0 && m_stats.rss > m_maxMemory) {
+        return true;
+    }
+
+    if (m_minAvailableMemory > 0 && m_stats.availableMemory >= 0 && m_stats.totalMemory > 0) {
+        return m_stats.availableMemory * 100 < m_stats.totalMemory * m_minAvailableMemory;
+    }
+
+    return false;
+}
@@ -0,0 +1,83 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef TABDISCARDMANAGER_H
+#define TABDISCARDMANAGER_H
+
+#include <QObject>
+#include <QDateTime>
+
+#include "qzcommon.h"
+
+class QTimer;
+
+class WebTab;
+
+// Unloads least recently used background tabs when memory runs low
+class FALKON_EXPORT TabDiscardManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        qint64 rss = -1;
+        qint64 availableMemory = -1;
+        qint64 totalMemory = -1;
+        int loadedTabs = 0;
+        int discardedTabs = 0;
+        QDateTime lastCheck;
+        QDateTime lastDiscard;
+    };
+
+    explicit TabDiscardManager(QObject *parent = nullptr);
+
+    bool isEnabled() const;
+    Stats stats() const;
+
+    // Memory usage can only be measured where /proc is available
+    static bool isSupported();
+
+    // Tabs that may be discarded, least recently used first
+    QVector<WebTab*> discardableTabs() const;
+
+    // Discards up to count tabs, returns number of discarded tabs
+    int discardTabs(int count = 1);
+
+    // Memory sizes in bytes, -1 if unknown
+    static qint64 processMemory(qint64 pid);
+    static qint64 parseMemInfo(const QByteArray &meminfo, const char *key);
+
+public Q_SLOTS:
+    void checkMemory();
+
+private Q_SLOTS:
+    void loadSettings();
+
+private:
+    bool isUnderPressure() const;
+
+    QTimer *m_timer;
+    Stats m_stats;
+
+    bool m_enabled;
+    int m_checkInterval;
+    qint64 m_maxMemory;
+    int m_minAvailableMemory;
+    qint64 m_minInactiveTime;
+};
+
+#endif // TABDISCARDMANAGER_H
@@ -20,6 +20,7 @@
 #include "webpage.h"
 #include "iconprovider.h"
 #include "tabbedwebview.h"
+#include "tabloadinganimation.h"
 
 #include <QTimer>
 #include <QToolTip>
@@ -28,16 +29,11 @@
 TabIcon::TabIcon(QWidget* parent)
     : QWidget(parent)
     , m_tab(0)
-    , m_currentFrame(0)
     , m_animationRunning(false)
     , m_audioIconDisplayed(false)
 {
     setObjectName(QSL("tab-icon"));
 
-    m_updateTimer = new QTimer(this);
-    m_updateTimer->setInterval(data()->animationInterval);
-    connect(m_updateTimer, &QTimer::timeout, this, &TabIcon::updateAnimationFrame);
-
     m_hideTimer = new QTimer(this);
     m_hideTimer->setInterval(250);
     connect(m_hideTimer, &QTimer::timeout, this, &TabIcon::hide);
@@ -49,33 +45,43 @@ void TabIcon::setWebTab(WebTab* tab)
 {
     m_tab = tab;
 
-    connect(m_tab->webView(), &QWebEngineView::loadStarted, this, &TabIcon::showLoadingAnimation);
-    connect(m_tab->webView(), &QWebEngineView::loadFinished, this, &TabIcon::hideLoadingAnimation);
-    connect(m_tab->webView(), &WebView::iconChanged, this, &TabIcon::updateIcon);
-    connect(m_tab->webView(), &WebView::backgroundActivityChanged, this, [this]() { update(); });
+    if (m_tab->hasWebView()) {
+        connectWebView();
+    }
+    connect(m_tab, &WebTab::webViewCreated, this, &TabIcon::connectWebView);
+
+    updateIcon();
+}
+
+void TabIcon::connectWebView()
+{
+    TabbedWebView *view = m_tab->webView();
+
+    connect(view, &QWebEngineView::loadStarted, this, &TabIcon::showLoadingAnimation);
+    connect(view, &QWebEngineView::loadFinished, this, &TabIcon::hideLoadingAnimation);
+    connect(view, &WebView::iconChanged, this, &TabIcon::updateIcon);
+    connect(view, &WebView::backgroundActivityChanged, this, [this]() { update(); });
 
     auto pageChanged = [this](WebPage *page) {
         connect(page, &QWebEnginePage::recentlyAudibleChanged, this, &TabIcon::updateAudioIcon);
     };
-    pageChanged(m_tab->webView()->page());
-    connect(m_tab->webView(), &WebView::pageChanged, this, pageChanged);
-
-    updateIcon();
+    pageChanged(view->page());
+    connect(view, &WebView::pageChanged, this, pageChanged);
 }
 
 void TabIcon::showLoadingAnimation()
 {
-    m_currentFrame = 0;
+    m_animationRunning = true;
 
-    updateAnimationFrame();
     show();
+    update();
 }
 
 void TabIcon::hideLoadingAnimation()
 {
     m_animationRunning = false;
 
-    m_updateTimer->stop();
+    stopAnimationClock();
     updateIcon();
 }
 
@@ -103,6 +109,11 @@ TabIcon::Data *TabIcon::data()
         data->animationInterval = 70;
         data->animationPixmap = QIcon(QSL(":icons/other/loading.png")).pixmap(288, 16);
         data->framesCount = data->animationPixmap.width() / data->animationPixmap.height();
+        // Frames are sliced once, so painting doesn't need to copy them
+        const int frameSize = data->animationPixmap.height();
+        for (int i = 0; i < data->framesCount; ++i) {
+            data->animationFrames.append(data->animationPixmap.copy(i * frameSize, 0, frameSize, frameSize));
+        }
         data->audioPlayingPixmap = QIcon::fromTheme(QSL("audio-volume-high"), QIcon(QSL(":icons/other/audioplaying.svg"))).pixmap(16);
         data->audioMutedPixmap = QIcon::fromTheme(QSL("audio-volume-muted"), QIcon(QSL(":icons/other/audiomuted.svg"))).pixmap(16);
     }
@@ -111,13 +122,20 @@ TabIcon::Data *TabIcon::data()
 
 void TabIcon::updateAnimationFrame()
 {
-    if (!m_animationRunning) {
-        m_updateTimer->start();
-        m_animationRunning = true;
+    // Hidden icon is registered again once it gets painted
+    if (!m_animationRunning || !TabLoadingAnimation::isWidgetVisible(this)) {
+        stopAnimationClock();
+        return;
     }
 
     update();
-    m_currentFrame = (m_currentFrame + 1) % data()->framesCount;
+}
+
+void TabIcon::stopAnimationClock()
+{
+    TabLoadingAnimation *animation = TabLoadingAnimation::instance();
+    animation->removeClient(this);
+    disconnect(animation, &TabLoadingAnimation::frameChanged, this, &TabIcon::updateAnimationFrame);
 }
 
 void TabIcon::show()
@@ -195,7 +213,6 @@ void TabIcon::paintEvent(QPaintEvent* event)
     p.setRenderHint(QPainter::Antialiasing);
 
     const int size = 16;
-    const int pixmapSize = qRound(size * data()->animationPixmap.devicePixelRatioF());
 
     // Center the pixmap in rect
     QRect r = rect();
@@ -205,7 +222,10 @@ void TabIcon::paintEvent(QPaintEvent* event)
     r.setHeight(size);
 
     if (m_animationRunning) {
-        p.drawPixmap(r, data()->animationPixmap, QRect(m_currentFrame * pixmapSize, 0, pixmapSize, pixmapSize));
+        TabLoadingAnimation *animation = TabLoadingAnimation::instance();
+        connect(animation, &TabLoadingAnimation::frameChanged, this, &TabIcon::updateAnimationFrame, Qt::UniqueConnection);
+        animation->addClient(this);
+        p.drawPixmap(r, animation->currentPixmap());
     } else if (m_audioIconDisplayed && !m_tab->isPinned()) {
         m_audioIconRect = r;
         p.drawPixmap(r, m_tab->isMuted() ? data()->audioMutedPixmap : data()->audioPlayingPixmap);
@@ -229,7 +249,7 @@ void TabIcon::paintEvent(QPaintEvent* event)
     }
 
     // Draw background activity indicator
-    if (m_tab && m_tab->isPinned() && m_tab->webView()->backgroundActivity()) {
+    if (m_tab && m_tab->isPinned() && m_tab->backgroundActivity()) {
         const int s = 5;
         // Background
         const QRect r1(width() - s - 2, height() - s - 2, s + 2, s + 2);
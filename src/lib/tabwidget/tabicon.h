@@ -20,6 +20,7 @@
 
 #include <QWidget>
 #include <QImage>
+#include <QVector>
 
 #include "qzcommon.h"
 
@@ -36,6 +37,7 @@ public:
         int framesCount;
         int animationInterval;
         QPixmap animationPixmap;
+        QVector<QPixmap> animationFrames;
         QPixmap audioPlayingPixmap;
         QPixmap audioMutedPixmap;
     };
@@ -50,6 +52,7 @@ Q_SIGNALS:
     void resized();
 
 private Q_SLOTS:
+    void connectWebView();
     void showLoadingAnimation();
     void hideLoadingAnimation();
 
@@ -57,6 +60,8 @@ private Q_SLOTS:
     void updateAnimationFrame();
 
 private:
+    void stopAnimationClock();
+
     void show();
     void hide();
     bool shouldBeVisible() const;
@@ -66,10 +71,8 @@ private:
     void mousePressEvent(QMouseEvent* event) override;
 
     WebTab* m_tab;
-    QTimer* m_updateTimer;
     QTimer* m_hideTimer;
     QPixmap m_sitePixmap;
-    int m_currentFrame;
     bool m_animationRunning;
     bool m_audioIconDisplayed;
     QRect m_audioIconRect;
@@ -0,0 +1,100 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "tabloadinganimation.h"
+#include "tabicon.h"
+
+#include <QWidget>
+#include <QVariantAnimation>
+
+Q_GLOBAL_STATIC(TabLoadingAnimation, qz_tab_loading_animation)
+
+TabLoadingAnimation::TabLoadingAnimation(QObject *parent)
+    : QObject(parent)
+    , m_currentFrame(0)
+{
+    const TabIcon::Data *data = TabIcon::data();
+
+    // Driven by Qt's unified animation timer, so ticks are shared with
+    // all other animations and follow the screen refresh
+    m_animation = new QVariantAnimation(this);
+    m_animation->setStartValue(0);
+    m_animation->setEndValue(data->framesCount);
+    m_animation->setDuration(data->framesCount * data->animationInterval);
+    m_animation->setLoopCount(-1);
+    connect(m_animation, &QVariantAnimation::valueChanged, this, &TabLoadingAnimation::updateFrame);
+}
+
+int TabLoadingAnimation::currentFrame() const
+{
+    return m_currentFrame;
+}
+
+QPixmap TabLoadingAnimation::currentPixmap() const
+{
+    return TabIcon::data()->animationFrames.at(m_currentFrame);
+}
+
+void TabLoadingAnimation::addClient(QObject *client)
+{
+    if (m_clients.contains(client)) {
+        return;
+    }
+
+    m_clients.insert(client);
+    connect(client, &QObject::destroyed, this, &TabLoadingAnimation::removeClient);
+
+    if (m_animation->state() != QAbstractAnimation::Running) {
+        m_animation->start();
+    }
+}
+
+void TabLoadingAnimation::removeClient(QObject *client)
+{
+    if (!m_clients.remove(client)) {
+        return;
+    }
+
+    disconnect(client, &QObject::destroyed, this, &TabLoadingAnimation::removeClient);
+
+    if (m_clients.isEmpty()) {
+        m_animation->stop();
+    }
+}
+
+// static
+bool TabLoadingAnimation::isWidgetVisible(QWidget *widget)
+{
+    return widget->isVisible() && !widget->window()->isMinimized() && !widget->visibleRegion().isEmpty();
+}
+
+// static
+TabLoadingAnimation *TabLoadingAnimation::instance()
+{
+    return qz_tab_loading_animation();
+}
+
+void TabLoadingAnimation::updateFrame(const QVariant &value)
+{
+    const int frame = value.toInt() % TabIcon::data()->framesCount;
+    if (m_currentFrame == frame) {
+        return;
+    }
+
+    m_currentFrame = frame;
+    emit frameChanged(m_currentFrame);
+}
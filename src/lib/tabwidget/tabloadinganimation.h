@@ -0,0 +1,61 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef TABLOADINGANIMATION_H
+#define TABLOADINGANIMATION_H
+
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+
+#include "qzcommon.h"
+
+class QVariantAnimation;
+
+// Single clock driving loading animation of all tabs in all windows.
+// Clients register when painting a loading tab and are dropped once
+// they are no longer visible, the clock only runs while it has clients.
+class FALKON_EXPORT TabLoadingAnimation : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TabLoadingAnimation(QObject *parent = nullptr);
+
+    int currentFrame() const;
+    QPixmap currentPixmap() const;
+
+    void addClient(QObject *client);
+    void removeClient(QObject *client);
+
+    // Whether widget is shown in non-minimized window and not fully obscured
+    static bool isWidgetVisible(QWidget *widget);
+
+    static TabLoadingAnimation *instance();
+
+Q_SIGNALS:
+    void frameChanged(int frame);
+
+private:
+    void updateFrame(const QVariant &value);
+
+    QVariantAnimation *m_animation;
+    QSet<QObject*> m_clients;
+    int m_currentFrame;
+};
+
+#endif // TABLOADINGANIMATION_H
@@ -345,8 +345,12 @@ int TabWidget::addView(const LoadRequest &req, const QString &title, const Qz::N
 
     WebTab* webTab = new WebTab(m_window);
     webTab->setPinned(pinned);
-    webTab->locationBar()->showUrl(url);
-    m_locationBars->addWidget(webTab->locationBar());
+    connect(webTab, &WebTab::webViewCreated, this, &TabWidget::webViewCreated);
+
+    // Clean background tabs stay placeholders until activated
+    if (!url.isEmpty() || openFlags & Qz::NT_SelectedTab) {
+        webTab->locationBar()->showUrl(url);
+    }
 
     int index = insertTab(position == -1 ? count() : position, webTab, QString(), pinned);
     webTab->attach(m_window);
@@ -361,14 +365,6 @@ int TabWidget::addView(const LoadRequest &req, const QString &title, const Qz::N
         m_lastBackgroundTab = webTab;
     }
 
-    connect(webTab->webView(), &TabbedWebView::wantsCloseTab, this, &TabWidget::closeTab);
-    connect(webTab->webView(), &QWebEngineView::urlChanged, this, &TabWidget::changed);
-    connect(webTab->webView(), &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
-    connect(webTab->webView(), &WebView::urlChanged, this, [this](const QUrl &url) {
-        if (url != m_urlOnNewTab)
-            m_currentTabFresh = false;
-    });
-
     if (url.isValid() && url != req.url()) {
         LoadRequest r(req);
         r.setUrl(url);
@@ -400,7 +396,11 @@ int TabWidget::addView(WebTab *tab, const Qz::NewTabPositionFlags &openFlags)
 
 int TabWidget::insertView(int index, WebTab *tab, const Qz::NewTabPositionFlags &openFlags)
 {
-    m_locationBars->addWidget(tab->locationBar());
+    connect(tab, &WebTab::webViewCreated, this, &TabWidget::webViewCreated);
+    if (tab->hasWebView()) {
+        connectWebView(tab);
+    }
+
     int newIndex = insertTab(index, tab, QString(), tab->isPinned());
     tab->attach(m_window);
 
@@ -410,10 +410,6 @@ int TabWidget::insertView(int index, WebTab *tab, const Qz::NewTabPositionFlags
         m_lastBackgroundTab = tab;
     }
 
-    connect(tab->webView(), &TabbedWebView::wantsCloseTab, this, &TabWidget::closeTab);
-    connect(tab->webView(), &QWebEngineView::urlChanged, this, &TabWidget::changed);
-    connect(tab->webView(), &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
-
     // Make sure user notice opening new background tabs
     if (!(openFlags & Qz::NT_SelectedTab)) {
         m_tabBar->ensureVisible(index);
@@ -452,11 +448,7 @@ void TabWidget::closeTab(int index)
 
     m_closedTabsManager->saveTab(webTab);
 
-    TabbedWebView *webView = webTab->webView();
-    m_locationBars->removeWidget(webView->webTab()->locationBar());
-    disconnect(webView, &TabbedWebView::wantsCloseTab, this, &TabWidget::closeTab);
-    disconnect(webView, &QWebEngineView::urlChanged, this, &TabWidget::changed);
-    disconnect(webView, &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
+    disconnectWebView(webTab);
 
     m_lastBackgroundTab = nullptr;
 
@@ -478,6 +470,12 @@ void TabWidget::requestCloseTab(int index)
     if (!webTab || !validIndex(index))
         return;
 
+    // Placeholder has no page that could refuse closing
+    if (count() > 1 && !webTab->hasWebView()) {
+        closeTab(index);
+        return;
+    }
+
     TabbedWebView *webView = webTab->webView();
 
     // This would close last tab, so we close the window instead
@@ -689,10 +687,7 @@ void TabWidget::detachTab(WebTab* tab)
         return;
     }
 
-    m_locationBars->removeWidget(tab->locationBar());
-    disconnect(tab->webView(), &TabbedWebView::wantsCloseTab, this, &TabWidget::closeTab);
-    disconnect(tab->webView(), &QWebEngineView::urlChanged, this, &TabWidget::changed);
-    disconnect(tab->webView(), &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
+    disconnectWebView(tab);
 
     const int index = tab->tabIndex();
 
@@ -854,7 +849,8 @@ bool TabWidget::restoreState(const QVector<WebTab::SavedTab> &tabs, int currentT
 
     for (int i = 0; i < tabs.size(); ++i) {
         WebTab::SavedTab tab = tabs.at(i);
-        WebTab *webTab = weTab(addView(QUrl(), Qz::NT_CleanSelectedTab, false, tab.isPinned));
+        // Tabs are created as placeholders, only the current one gets its view
+        WebTab *webTab = weTab(addView(QUrl(), Qz::NT_CleanNotSelectedTab | Qz::NT_TabAtTheEnd, false, tab.isPinned));
         webTab->restoreTab(tab);
         if (!tab.childTabs.isEmpty()) {
             childTabs.append({webTab, tab.childTabs});
@@ -871,6 +867,7 @@ bool TabWidget::restoreState(const QVector<WebTab::SavedTab> &tabs, int currentT
         }
     }
 
+    m_lastBackgroundTab = nullptr;
     setCurrentIndex(currentTab);
     QTimer::singleShot(0, m_tabBar, SLOT(ensureVisible(int,int)));
 
@@ -879,6 +876,42 @@ bool TabWidget::restoreState(const QVector<WebTab::SavedTab> &tabs, int currentT
     return true;
 }
 
+void TabWidget::webViewCreated()
+{
+    WebTab *webTab = qobject_cast<WebTab*>(sender());
+    if (webTab) {
+        connectWebView(webTab);
+    }
+}
+
+void TabWidget::connectWebView(WebTab *tab)
+{
+    TabbedWebView *webView = tab->webView();
+    m_locationBars->addWidget(tab->locationBar());
+
+    connect(webView, &TabbedWebView::wantsCloseTab, this, &TabWidget::closeTab);
+    connect(webView, &QWebEngineView::urlChanged, this, &TabWidget::changed);
+    connect(webView, &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
+    connect(webView, &WebView::urlChanged, this, [this](const QUrl &url) {
+        if (url != m_urlOnNewTab)
+            m_currentTabFresh = false;
+    });
+}
+
+void TabWidget::disconnectWebView(WebTab *tab)
+{
+    disconnect(tab, &WebTab::webViewCreated, this, &TabWidget::webViewCreated);
+
+    if (!tab->hasWebView()) {
+        return;
+    }
+
+    TabbedWebView *webView = tab->webView();
+    m_locationBars->removeWidget(tab->locationBar());
+    disconnect(webView, nullptr, this, nullptr);
+    disconnect(webView, &TabbedWebView::ipChanged, m_window->ipLabel(), &QLabel::setText);
+}
+
 TabWidget::~TabWidget()
 {
     delete m_closedTabsManager;
@@ -146,6 +146,7 @@ private Q_SLOTS:
 
     void actionChangeIndex();
     void tabWasMoved(int before, int after);
+    void webViewCreated();
 
 private:
     WebTab* weTab() const;
@@ -155,6 +156,9 @@ private:
     bool validIndex(int index) const;
     void updateClosedTabsButton();
 
+    void connectWebView(WebTab *tab);
+    void disconnectWebView(WebTab *tab);
+
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
 
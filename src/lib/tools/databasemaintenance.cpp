@@ -0,0 +1,302 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "databasemaintenance.h"
+#include "sqldatabase.h"
+#include "settings.h"
+
+#include <QTimer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+// Each step runs for about this many ms, followed by pause
+static const int s_stepTime = 50;
+static const int s_stepInterval = 1000;
+
+// Rows removed or examined by single statement
+static const int s_batchSize = 200;
+static const int s_windowSize = 1000;
+
+// Pages freed by single incremental vacuum statement
+static const int s_vacuumPages = 256;
+
+DatabaseMaintenance::DatabaseMaintenance(QObject *parent)
+    : QObject(parent)
+    , m_fullVacuumAllowed(false)
+    , m_running(false)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(s_stepInterval);
+    connect(m_timer, &QTimer::timeout, this, &DatabaseMaintenance::runStep);
+}
+
+bool DatabaseMaintenance::isFullVacuumAllowed() const
+{
+    return m_fullVacuumAllowed;
+}
+
+void DatabaseMaintenance::setFullVacuumAllowed(bool allowed)
+{
+    m_fullVacuumAllowed = allowed;
+}
+
+bool DatabaseMaintenance::needsFullVacuum() const
+{
+    return m_state && m_state->needsFullVacuum;
+}
+
+bool DatabaseMaintenance::isRunning() const
+{
+    return m_running;
+}
+
+void DatabaseMaintenance::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    Settings settings;
+    settings.beginGroup(QSL("Web-Browser-Settings"));
+    const int historyExpirationDays = settings.value(QSL("HistoryExpirationDays"), 0).toInt();
+    settings.endGroup();
+
+    const QDateTime now = QDateTime::currentDateTime();
+
+    m_state = std::make_shared<State>();
+    m_state->historyCutoff = historyExpirationDays > 0 ? now.addDays(-historyExpirationDays).toMSecsSinceEpoch() : 0;
+    m_state->iconsCutoff = now.addMonths(-6).toMSecsSinceEpoch();
+    m_state->fullVacuumAllowed = m_fullVacuumAllowed;
+
+    m_running = true;
+    m_timer->start();
+}
+
+void DatabaseMaintenance::runStep()
+{
+    const std::shared_ptr<State> state = m_state;
+
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+        stepFinished();
+    });
+    watcher->setFuture(SqlDatabase::instance()->runWrite([=]() {
+        doStep(state.get());
+    }));
+}
+
+void DatabaseMaintenance::stepFinished()
+{
+    if (m_state->step != Finished) {
+        m_timer->start();
+        return;
+    }
+
+    m_running = false;
+
+    if (m_state->expiredHistory > 0) {
+        emit historyExpired();
+    }
+    emit finished(qMax(qint64(0), m_state->sizeBefore - m_state->sizeAfter));
+}
+
+// static
+void DatabaseMaintenance::doStep(State *state)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (state->sizeBefore < 0) {
+        state->sizeBefore = databaseSize();
+    }
+
+    while (state->step != Finished && timer.elapsed() < s_stepTime) {
+        bool done = true;
+
+        switch (state->step) {
+        case ExpireHistory:
+            done = expireHistory(state);
+            break;
+        case ClearOldIcons:
+            done = clearOldIcons(state);
+            break;
+        case ClearUnusedIcons:
+            done = clearUnusedIcons(state);
+            break;
+        case Analyze:
+            done = analyze(state);
+            break;
+        case Vacuum:
+            done = vacuum(state);
+            break;
+        default:
+            break;
+        }
+
+        if (done) {
+            state->step = static_cast<Step>(state->step + 1);
+            state->cursor = 0;
+        }
+    }
+
+    if (state->step == Finished) {
+        state->sizeAfter = databaseSize();
+    }
+}
+
+// static
+bool DatabaseMaintenance::expireHistory(State *state)
+{
+    if (state->historyCutoff <= 0) {
+        return true;
+    }
+
+    QSqlQuery query = SqlDatabase::instance()->preparedQuery(QSL("DELETE FROM history WHERE id IN "
+                                                                 "(SELECT id FROM history WHERE date < ? LIMIT ?)"));
+    query.addBindValue(state->historyCutoff);
+    query.addBindValue(s_batchSize);
+    query.exec();
+
+    const int removed = qMax(0, query.numRowsAffected());
+    state->expiredHistory += removed;
+    return removed < s_batchSize;
+}
+
+// static
+bool DatabaseMaintenance::clearOldIcons(State *state)
+{
+    // Icons for entries older than 6 months, looked up in windows of icon ids
+    QSqlQuery query = SqlDatabase::instance()->preparedQuery(QSL("SELECT max(id) FROM icons"));
+    query.exec();
+    const qint64 maxId = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+
+    if (state->cursor >= maxId) {
+        return true;
+    }
+
+    query = SqlDatabase::instance()->preparedQuery(QSL("DELETE FROM icons WHERE id > ? AND id <= ? AND EXISTS "
+                                                       "(SELECT 1 FROM history WHERE history.url = icons.url AND history.date < ?)"));
+    query.addBindValue(state->cursor);
+    query.addBindValue(state->cursor + s_windowSize);
+    query.addBindValue(state->iconsCutoff);
+    query.exec();
+
+    state->cursor += s_windowSize;
+    return false;
+}
+
+// static
+bool DatabaseMaintenance::clearUnusedIcons(State *state)
+{
+    QSqlQuery query = SqlDatabase::instance()->preparedQuery(QSL("SELECT max(id) FROM icon_data"));
+    query.exec();
+    const qint64 maxId = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+
+    if (state->cursor >= maxId) {
+        return true;
+    }
+
+    query = SqlDatabase::instance()->preparedQuery(QSL("DELETE FROM icon_data WHERE id > ? AND id <= ? AND NOT EXISTS "
+                                                       "(SELECT 1 FROM icons WHERE icons.data_id = icon_data.id)"));
+    query.addBindValue(state->cursor);
+    query.addBindValue(state->cursor + s_windowSize);
+    query.exec();
+
+    state->cursor += s_windowSize;
+    return false;
+}
+
+// static
+bool DatabaseMaintenance::analyze(State *state)
+{
+    Q_UNUSED(state)
+
+    // Sampling keeps ANALYZE short on large tables (ignored by SQLite older than 3.32)
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA analysis_limit=400"));
+    query.exec(QSL("ANALYZE"));
+    return true;
+}
+
+// static
+bool DatabaseMaintenance::vacuum(State *state)
+{
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA auto_vacuum"));
+    const int autoVacuum = query.next() ? query.value(0).toInt() : 0;
+    query.finish();
+
+    if (autoVacuum != 2) {
+        if (state->fullVacuumAllowed) {
+            fullVacuum();
+        } else {
+            state->needsFullVacuum = true;
+        }
+        return true;
+    }
+
+    if (incrementalVacuum(s_vacuumPages) < s_vacuumPages) {
+        query.exec(QSL("PRAGMA wal_checkpoint(TRUNCATE)"));
+        return true;
+    }
+    return false;
+}
+
+// static
+int DatabaseMaintenance::incrementalVacuum(int maxPages)
+{
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA incremental_vacuum(%1)").arg(maxPages));
+
+    // Statement frees one page per row, it has to be stepped through all of them
+    int pages = 0;
+    while (query.next()) {
+        pages++;
+    }
+    return pages;
+}
+
+// static
+void DatabaseMaintenance::fullVacuum()
+{
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA auto_vacuum"));
+    const int autoVacuum = query.next() ? query.value(0).toInt() : 0;
+    query.finish();
+
+    if (autoVacuum != 2) {
+        query.exec(QSL("PRAGMA auto_vacuum=INCREMENTAL"));
+    }
+    query.exec(QSL("VACUUM"));
+    query.exec(QSL("PRAGMA wal_checkpoint(TRUNCATE)"));
+}
+
+// static
+qint64 DatabaseMaintenance::databaseSize()
+{
+    QSqlQuery query(SqlDatabase::instance()->database());
+    query.exec(QSL("PRAGMA page_count"));
+    const qint64 pageCount = query.next() ? query.value(0).toLongLong() : 0;
+    query.exec(QSL("PRAGMA page_size"));
+    const qint64 pageSize = query.next() ? query.value(0).toLongLong() : 0;
+    return pageCount * pageSize;
+}
@@ -0,0 +1,98 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef DATABASEMAINTENANCE_H
+#define DATABASEMAINTENANCE_H
+
+#include <QObject>
+
+#include <memory>
+
+#include "qzcommon.h"
+
+class QTimer;
+
+// Cleans up and compacts browsedata.db in short steps on database writer thread,
+// with pauses between them so other database work is not held up
+class FALKON_EXPORT DatabaseMaintenance : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatabaseMaintenance(QObject *parent = nullptr);
+
+    // Full VACUUM blocks all database writes until it finishes, so it is only
+    // allowed when explicitly optimizing the database. It is needed once to
+    // switch databases created without incremental auto vacuum.
+    bool isFullVacuumAllowed() const;
+    void setFullVacuumAllowed(bool allowed);
+
+    // Database still needs full vacuum, valid after finished
+    bool needsFullVacuum() const;
+
+    bool isRunning() const;
+    void start();
+
+    // Frees at most maxPages pages in one statement, returns number of freed pages
+    static int incrementalVacuum(int maxPages);
+    // Switches database to incremental auto vacuum with full VACUUM if needed
+    static void fullVacuum();
+
+Q_SIGNALS:
+    void historyExpired();
+    void finished(qint64 reclaimedBytes);
+
+private:
+    enum Step {
+        ExpireHistory,
+        ClearOldIcons,
+        ClearUnusedIcons,
+        Analyze,
+        Vacuum,
+        Finished
+    };
+
+    struct State {
+        Step step = ExpireHistory;
+        qint64 cursor = 0;
+        qint64 historyCutoff = 0;
+        qint64 iconsCutoff = 0;
+        qint64 sizeBefore = -1;
+        qint64 sizeAfter = -1;
+        int expiredHistory = 0;
+        bool fullVacuumAllowed = false;
+        bool needsFullVacuum = false;
+    };
+
+    void runStep();
+    void stepFinished();
+
+    static void doStep(State *state);
+    static bool expireHistory(State *state);
+    static bool clearOldIcons(State *state);
+    static bool clearUnusedIcons(State *state);
+    static bool analyze(State *state);
+    static bool vacuum(State *state);
+    static qint64 databaseSize();
+
+    std::shared_ptr<State> m_state;
+    QTimer *m_timer;
+    bool m_fullVacuumAllowed;
+    bool m_running;
+};
+
+#endif // DATABASEMAINTENANCE_H
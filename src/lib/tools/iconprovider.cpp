@@ -25,11 +25,16 @@
 
 #include <QTimer>
 #include <QBuffer>
-#include <QFutureWatcher>
+#include <QSqlDatabase>
+#include <QCryptographicHash>
 #include <QtConcurrent/QtConcurrentRun>
+#include <QtConcurrent/QtConcurrentMap>
 
 Q_GLOBAL_STATIC(IconProvider, qz_icon_provider)
 
+static bool s_legacySchema = false;
+static bool s_needsFullVacuum = false;
+
 static QByteArray encodeUrl(const QUrl &url)
 {
     return url.toEncoded(QUrl::RemoveFragment | QUrl::StripTrailingSlash);
@@ -37,6 +42,7 @@ static QByteArray encodeUrl(const QUrl &url)
 
 IconProvider::IconProvider()
     : QWidget()
+    , m_hostImageCache(200)
 {
     m_autoSaver = new AutoSaver(this);
     connect(m_autoSaver, &AutoSaver::save, this, &IconProvider::saveIconsToDatabase);
@@ -67,19 +73,18 @@ void IconProvider::saveIcon(WebView* view)
         return;
     }
 
-    for (int i = 0; i < m_iconBuffer.size(); ++i) {
-        if (m_iconBuffer[i].first == view->url()) {
-            m_iconBuffer.removeAt(i);
-            break;
-        }
-    }
-
     BufferedIcon item;
     item.first = view->url();
     item.second = icon.pixmap(16).toImage();
 
+    QMutexLocker locker(&m_iconCacheMutex);
+
+    const QByteArray encodedUrl = encodeUrl(item.first);
+    m_urlImageCache.remove(encodedUrl);
+    m_hostImageCache.insert(normalizedHost(item.first), new QImage(item.second));
+
     m_autoSaver->changeOccurred();
-    m_iconBuffer.append(item);
+    m_iconBuffer.insert(encodedUrl, item);
 }
 
 QIcon IconProvider::bookmarkIcon() const
@@ -187,33 +192,48 @@ QImage IconProvider::imageForUrl(const QUrl &url, bool allowNull)
         return allowNull ? QImage() : IconProvider::emptyWebImage();
     }
 
-    QMutexLocker locker(&instance()->m_iconCacheMutex);
-
+    IconProvider *provider = instance();
     const QByteArray encodedUrl = encodeUrl(url);
 
-    if (QImage *img = instance()->m_urlImageCache.object(encodedUrl)) {
-        return img->isNull() && !allowNull ? IconProvider::emptyWebImage() : *img;
-    }
+    {
+        QMutexLocker locker(&provider->m_iconCacheMutex);
 
-    const auto iconBuffer = instance()->m_iconBuffer;
-    for (const BufferedIcon &ic : iconBuffer) {
-        if (encodeUrl(ic.first) == encodedUrl) {
-            return ic.second;
+        if (QImage *img = provider->m_urlImageCache.object(encodedUrl)) {
+            return img->isNull() && !allowNull ? IconProvider::emptyWebImage() : *img;
+        }
+
+        auto it = provider->m_iconBuffer.constFind(encodedUrl);
+        if (it != provider->m_iconBuffer.constEnd()) {
+            return it->second;
+        }
+
+        it = provider->m_savingIcons.constFind(encodedUrl);
+        if (it != provider->m_savingIcons.constEnd()) {
+            return it->second;
         }
     }
 
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QSL("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1"));
-    query.addBindValue(QString("%1*").arg(QzTools::escapeSqlGlobString(QString::fromUtf8(encodedUrl))));
+    // Urls starting with encodedUrl, as range on url index. Encoded urls are ascii only.
+    const QString prefix = QString::fromUtf8(encodedUrl);
+    QSqlQuery query = SqlDatabase::instance()->preparedQuery(s_legacySchema
+                                                             ? QSL("SELECT icon FROM icons WHERE url >= ? AND url < ? ORDER BY url LIMIT 1")
+                                                             : QSL("SELECT icon_data.icon FROM icons "
+                                                                   "JOIN icon_data ON icon_data.id = icons.data_id "
+                                                                   "WHERE icons.url >= ? AND icons.url < ? ORDER BY icons.url LIMIT 1"));
+    query.addBindValue(prefix);
+    query.addBindValue(prefix + QL1C('\x7f'));
     query.exec();
 
-    QImage *img = new QImage;
+    QImage image;
     if (query.next()) {
-        img->loadFromData(query.value(0).toByteArray());
+        image.loadFromData(query.value(0).toByteArray());
     }
-    instance()->m_urlImageCache.insert(encodedUrl, img);
+    query.finish();
+
+    QMutexLocker locker(&provider->m_iconCacheMutex);
+    provider->m_urlImageCache.insert(encodedUrl, new QImage(image));
 
-    return img->isNull() && !allowNull ? IconProvider::emptyWebImage() : *img;
+    return image.isNull() && !allowNull ? IconProvider::emptyWebImage() : image;
 }
 
 QIcon IconProvider::iconForDomain(const QUrl &url, bool allowNull)
@@ -227,25 +247,139 @@ QImage IconProvider::imageForDomain(const QUrl &url, bool allowNull)
         return allowNull ? QImage() : IconProvider::emptyWebImage();
     }
 
-    QMutexLocker locker(&instance()->m_iconCacheMutex);
+    IconProvider *provider = instance();
+    const QString host = normalizedHost(url);
 
-    const auto iconBuffer = instance()->m_iconBuffer;
-    for (const BufferedIcon &ic : iconBuffer) {
-        if (ic.first.host() == url.host()) {
-            return ic.second;
+    {
+        // Also has icons that are not saved yet
+        QMutexLocker locker(&provider->m_iconCacheMutex);
+
+        if (QImage *img = provider->m_hostImageCache.object(host)) {
+            return img->isNull() && !allowNull ? IconProvider::emptyWebImage() : *img;
         }
     }
 
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QSL("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1"));
-    query.addBindValue(QString("*%1*").arg(QzTools::escapeSqlGlobString(url.host())));
+    // Old table has no host column, host part of urls is matched instead
+    QSqlQuery query = SqlDatabase::instance()->preparedQuery(s_legacySchema
+                                                             ? QSL("SELECT icon FROM icons WHERE url GLOB ? OR url GLOB ? LIMIT 1")
+                                                             : QSL("SELECT icon_data.icon FROM icons "
+                                                                   "JOIN icon_data ON icon_data.id = icons.data_id "
+                                                                   "WHERE icons.host = ? LIMIT 1"));
+    if (s_legacySchema) {
+        query.addBindValue(QSL("*://%1/*").arg(QzTools::escapeSqlGlobString(host)));
+        query.addBindValue(QSL("*://www.%1/*").arg(QzTools::escapeSqlGlobString(host)));
+    } else {
+        query.addBindValue(host);
+    }
     query.exec();
 
+    QImage image;
     if (query.next()) {
-        return QImage::fromData(query.value(0).toByteArray());
+        image.loadFromData(query.value(0).toByteArray());
+    }
+    query.finish();
+
+    QMutexLocker locker(&provider->m_iconCacheMutex);
+    if (!provider->m_hostImageCache.contains(host)) {
+        provider->m_hostImageCache.insert(host, new QImage(image));
+    }
+
+    return image.isNull() && !allowNull ? IconProvider::emptyWebImage() : image;
+}
+
+// static
+void IconProvider::setupDatabase(QSqlDatabase db)
+{
+    s_legacySchema = false;
+    s_needsFullVacuum = false;
+
+    if (db.record(QSL("icons")).contains(QSL("data_id"))) {
+        // Used for finding unused icon data
+        if (!mApp->isPrivate()) {
+            QSqlQuery query(db);
+            query.exec(QSL("CREATE INDEX IF NOT EXISTS icons_dataindex ON icons (data_id)"));
+        }
+        return;
+    }
+
+    // Database is opened read-only in private mode
+    if (mApp->isPrivate()) {
+        s_legacySchema = true;
+        return;
+    }
+
+    const QStringList statements = {
+        QSL("CREATE TABLE icon_data (id INTEGER PRIMARY KEY, hash BLOB NOT NULL, icon BLOB NOT NULL)"),
+        QSL("CREATE UNIQUE INDEX icon_data_hashuniqueindex ON icon_data (hash)"),
+        QSL("DROP INDEX IF EXISTS icons_urluniqueindex"),
+        QSL("ALTER TABLE icons RENAME TO icons_old"),
+        QSL("CREATE TABLE icons (id INTEGER PRIMARY KEY, url TEXT NOT NULL, host TEXT NOT NULL, data_id INTEGER NOT NULL)"),
+        QSL("CREATE UNIQUE INDEX icons_urluniqueindex ON icons (url)"),
+        QSL("CREATE INDEX icons_hostindex ON icons (host)"),
+        QSL("CREATE INDEX icons_dataindex ON icons (data_id)")
+    };
+
+    QSqlQuery query(db);
+    db.transaction();
+
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "IconProvider: Cannot convert icons table:" << query.lastError().text();
+            db.rollback();
+            s_legacySchema = true;
+            return;
+        }
     }
 
-    return allowNull ? QImage() : IconProvider::emptyWebImage();
+    QHash<QByteArray, qint64> dataIds;
+    QSqlQuery dataQuery(db);
+    dataQuery.prepare(QSL("INSERT INTO icon_data (hash, icon) VALUES (?,?)"));
+    QSqlQuery iconQuery(db);
+    iconQuery.prepare(QSL("INSERT OR IGNORE INTO icons (url, host, data_id) VALUES (?,?,?)"));
+
+    query.exec(QSL("SELECT url, icon FROM icons_old"));
+    while (query.next()) {
+        const QString url = query.value(0).toString();
+        const QByteArray icon = query.value(1).toByteArray();
+        if (icon.isEmpty()) {
+            continue;
+        }
+
+        const QByteArray hash = QCryptographicHash::hash(icon, QCryptographicHash::Sha1);
+        auto it = dataIds.find(hash);
+        if (it == dataIds.end()) {
+            dataQuery.addBindValue(hash);
+            dataQuery.addBindValue(icon);
+            dataQuery.exec();
+            it = dataIds.insert(hash, dataQuery.lastInsertId().toLongLong());
+        }
+
+        iconQuery.addBindValue(url);
+        iconQuery.addBindValue(normalizedHost(QUrl::fromEncoded(url.toUtf8())));
+        iconQuery.addBindValue(it.value());
+        iconQuery.exec();
+    }
+
+    query.exec(QSL("DROP TABLE icons_old"));
+    db.commit();
+
+    // Freed pages are reclaimed by incremental steps of DatabaseMaintenance,
+    // full VACUUM here would block profile loading
+    query.exec(QSL("PRAGMA auto_vacuum"));
+    s_needsFullVacuum = !query.next() || query.value(0).toInt() != 2;
+    query.finish();
+}
+
+// static
+bool IconProvider::isLegacySchema()
+{
+    return s_legacySchema;
+}
+
+// static
+bool IconProvider::needsFullVacuum()
+{
+    return s_needsFullVacuum;
 }
 
 IconProvider* IconProvider::instance()
@@ -255,41 +389,124 @@ IconProvider* IconProvider::instance()
 
 void IconProvider::saveIconsToDatabase()
 {
-    QMutexLocker locker(&instance()->m_iconCacheMutex);
+    QVector<BufferedIcon> icons;
 
-    for (const BufferedIcon &ic : qAsConst(m_iconBuffer)) {
-        QByteArray ba;
-        QBuffer buffer(&ba);
-        buffer.open(QIODevice::WriteOnly);
-        ic.second.save(&buffer, "PNG");
+    {
+        QMutexLocker locker(&m_iconCacheMutex);
 
-        const QByteArray encodedUrl = encodeUrl(ic.first);
-        m_urlImageCache.remove(encodedUrl);
+        if (m_iconBuffer.isEmpty()) {
+            return;
+        }
 
-        auto job = new SqlQueryJob(QSL("INSERT OR REPLACE INTO icons (icon, url) VALUES (?,?)"), this);
-        job->addBindValue(buffer.data());
-        job->addBindValue(QString::fromUtf8(encodedUrl));
-        job->start();
+        // Icons stay available for lookups until they are written
+        for (auto it = m_iconBuffer.constBegin(); it != m_iconBuffer.constEnd(); ++it) {
+            m_savingIcons.insert(it.key(), it.value());
+            icons.append(it.value());
+        }
+        m_iconBuffer.clear();
     }
 
-    m_iconBuffer.clear();
+    // Icons are encoded in parallel and then written in single transaction
+    QtConcurrent::run([=]() {
+        const QVector<EncodedIcon> encodedIcons = QtConcurrent::blockingMapped<QVector<EncodedIcon>>(icons, &IconProvider::encodeIcon);
+
+        SqlDatabase::instance()->runWrite([=]() {
+            if (s_legacySchema) {
+                writeLegacyIcons(encodedIcons);
+            } else {
+                writeIcons(encodedIcons);
+            }
+
+            QMutexLocker locker(&m_iconCacheMutex);
+            for (const EncodedIcon &icon : encodedIcons) {
+                const auto it = m_savingIcons.constFind(icon.encodedUrl);
+                if (it != m_savingIcons.constEnd() && it->second.cacheKey() == icon.imageKey) {
+                    m_savingIcons.erase(it);
+                }
+            }
+        });
+    });
 }
 
-void IconProvider::clearOldIconsInDatabase()
+// static
+IconProvider::EncodedIcon IconProvider::encodeIcon(const BufferedIcon &icon)
 {
-    // Delete icons for entries older than 6 months
-    const QDateTime date = QDateTime::currentDateTime().addMonths(-6);
+    QByteArray ba;
+    QBuffer buffer(&ba);
+    buffer.open(QIODevice::WriteOnly);
+    icon.second.save(&buffer, "PNG");
+
+    EncodedIcon encoded;
+    encoded.encodedUrl = encodeUrl(icon.first);
+    encoded.host = normalizedHost(icon.first);
+    encoded.data = ba;
+    encoded.hash = QCryptographicHash::hash(ba, QCryptographicHash::Sha1);
+    encoded.imageKey = icon.second.cacheKey();
+    return encoded;
+}
 
-    QSqlQuery query(SqlDatabase::instance()->database());
-    query.prepare(QSL("DELETE FROM icons WHERE url IN (SELECT url FROM history WHERE date < ?)"));
-    query.addBindValue(date.toMSecsSinceEpoch());
-    query.exec();
+// static
+void IconProvider::writeIcons(const QVector<EncodedIcon> &icons)
+{
+    SqlDatabase *database = SqlDatabase::instance();
+    QSqlDatabase db = database->database();
+    db.transaction();
+
+    QSqlQuery dataQuery = database->preparedQuery(QSL("INSERT OR IGNORE INTO icon_data (hash, icon) VALUES (?,?)"));
+    QSqlQuery idQuery = database->preparedQuery(QSL("SELECT id FROM icon_data WHERE hash = ?"));
+    QSqlQuery iconQuery = database->preparedQuery(QSL("INSERT OR REPLACE INTO icons (url, host, data_id) VALUES (?,?,?)"));
+
+    for (const EncodedIcon &icon : icons) {
+        dataQuery.addBindValue(icon.hash);
+        dataQuery.addBindValue(icon.data);
+        dataQuery.exec();
+
+        idQuery.addBindValue(icon.hash);
+        idQuery.exec();
+        if (!idQuery.next()) {
+            continue;
+        }
+        const QVariant dataId = idQuery.value(0);
+        idQuery.finish();
+
+        iconQuery.addBindValue(QString::fromUtf8(icon.encodedUrl));
+        iconQuery.addBindValue(icon.host);
+        iconQuery.addBindValue(dataId);
+        iconQuery.exec();
+    }
+
+    db.commit();
+}
+
+// static
+void IconProvider::writeLegacyIcons(const QVector<EncodedIcon> &icons)
+{
+    SqlDatabase *database = SqlDatabase::instance();
+    QSqlDatabase db = database->database();
+    db.transaction();
+
+    QSqlQuery query = database->preparedQuery(QSL("INSERT OR REPLACE INTO icons (url, icon) VALUES (?,?)"));
+
+    for (const EncodedIcon &icon : icons) {
+        query.addBindValue(QString::fromUtf8(icon.encodedUrl));
+        query.addBindValue(icon.data);
+        query.exec();
+    }
 
-    query.clear();
-    query.exec(QSL("VACUUM"));
+    db.commit();
 }
 
 QIcon IconProvider::iconFromImage(const QImage &image)
 {
     return QIcon(QPixmap::fromImage(image));
 }
+
+// static
+QString IconProvider::normalizedHost(const QUrl &url)
+{
+    QString host = url.host().toLower();
+    if (host.startsWith(QL1S("www."))) {
+        host = host.mid(4);
+    }
+    return host;
+}
@@ -24,12 +24,14 @@
 #include <QUrl>
 #include <QCache>
 #include <QMutex>
+#include <QHash>
 
 #include <functional>
 
 #include "qzcommon.h"
 
 class QIcon;
+class QSqlDatabase;
 
 class WebView;
 class AutoSaver;
@@ -68,21 +70,48 @@ public:
     static QIcon iconForDomain(const QUrl &url, bool allowNull = false);
     static QImage imageForDomain(const QUrl &url, bool allowNull = false);
 
+    // Icons are stored once per content hash (icon_data) and referenced
+    // by page url and normalized host (icons), converts old schema
+    static void setupDatabase(QSqlDatabase db);
+
+    // Database couldn't be converted (read-only profile in private mode),
+    // icons are looked up in old icons table with url and icon columns
+    static bool isLegacySchema();
+
+    // Icons table was converted, but database can't reclaim the freed space incrementally
+    static bool needsFullVacuum();
+
+    // Host as stored in icons table, lowercase without "www."
+    static QString normalizedHost(const QUrl &url);
+
     static IconProvider* instance();
 
 public Q_SLOTS:
     void saveIconsToDatabase();
-    void clearOldIconsInDatabase();
 
 private:
     typedef QPair<QUrl, QImage> BufferedIcon;
 
+    struct EncodedIcon {
+        QByteArray encodedUrl;
+        QString host;
+        QByteArray hash;
+        QByteArray data;
+        qint64 imageKey = 0;
+    };
+
     QIcon iconFromImage(const QImage &image);
 
+    static EncodedIcon encodeIcon(const BufferedIcon &icon);
+    static void writeIcons(const QVector<EncodedIcon> &icons);
+    static void writeLegacyIcons(const QVector<EncodedIcon> &icons);
+
     QImage m_emptyWebImage;
     QIcon m_bookmarkIcon;
-    QVector<BufferedIcon> m_iconBuffer;
+    QHash<QByteArray, BufferedIcon> m_iconBuffer;
+    QHash<QByteArray, BufferedIcon> m_savingIcons;
     QCache<QByteArray, QImage> m_urlImageCache;
+    QCache<QString, QImage> m_hostImageCache;
     QMutex m_iconCacheMutex;
 
     AutoSaver* m_autoSaver;
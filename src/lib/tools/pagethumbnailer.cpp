@@ -1,6 +1,6 @@
 /* ============================================================
 * Falkon - Qt web browser
-* Copyright (C) 2010-2017 David Rosca <nowrep@gmail.com>
+* Copyright (C) 2010-2014  David Rosca <nowrep@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -25,49 +25,49 @@
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QQuickWidget>
+#include <QQuickWindow>
+
+// Page that doesn't finish loading is given up
+static const int s_loadTimeout = 30 * 1000;
+// Static pages may have been painted already before load finished
+static const int s_paintTimeout = 250;
+// Blank page that doesn't finish loading doesn't block the view forever
+static const int s_releaseTimeout = 5 * 1000;
 
 PageThumbnailer::PageThumbnailer(QObject* parent)
     : QObject(parent)
     , m_view(new QQuickWidget())
-    , m_size(QSize(450, 253) * qApp->devicePixelRatio())
-    , m_loadTitle(false)
+    , m_loadTimer(new QTimer(this))
+    , m_paintTimer(new QTimer(this))
+    , m_requestId(0)
+    , m_busy(false)
+    , m_releasing(false)
 {
     m_view->setAttribute(Qt::WA_DontShowOnScreen);
     m_view->setSource(QUrl(QSL("qrc:data/thumbnailer.qml")));
     m_view->rootContext()->setContextProperty(QSL("thumbnailer"), this);
     m_view->show();
-}
 
-void PageThumbnailer::setSize(const QSize &size)
-{
-    if (size.isValid()) {
-        m_size = size;
-    }
-}
+    m_loadTimer->setSingleShot(true);
+    connect(m_loadTimer, &QTimer::timeout, this, [this]() {
+        if (m_releasing) {
+            release();
+        } else {
+            finish(QImage());
+        }
+    });
 
-void PageThumbnailer::setUrl(const QUrl &url)
-{
-    if (url.isValid()) {
-        m_url = url;
-    }
+    m_paintTimer->setSingleShot(true);
+    m_paintTimer->setInterval(s_paintTimeout);
+    connect(m_paintTimer, &QTimer::timeout, this, &PageThumbnailer::grabThumbnail);
 }
 
-QUrl PageThumbnailer::url()
+QUrl PageThumbnailer::url() const
 {
     return m_url;
 }
 
-bool PageThumbnailer::loadTitle()
-{
-    return m_loadTitle;
-}
-
-void PageThumbnailer::setLoadTitle(bool load)
-{
-    m_loadTitle = load;
-}
-
-QString PageThumbnailer::title()
+QString PageThumbnailer::title() const
 {
     QString title = m_title.isEmpty() ? m_url.host() : m_title;
     if (title.isEmpty()) {
@@ -76,15 +76,32 @@ QString PageThumbnailer::title()
     return title;
 }
 
-void PageThumbnailer::start()
+bool PageThumbnailer::isBusy() const
+{
+    return m_busy;
+}
+
+void PageThumbnailer::start(const QUrl &url)
 {
-    if (m_view->rootObject() && WebView::isUrlValid(m_url)) {
-        m_view->rootObject()->setProperty("url", m_url);
-    } else {
-        QTimer::singleShot(500, this, [this]() {
-            emit thumbnailCreated(QPixmap());
+    Q_ASSERT(!m_busy && !m_releasing);
+
+    m_url = url;
+    m_title.clear();
+
+    if (!m_view->rootObject() || !WebView::isUrlValid(m_url)) {
+        QTimer::singleShot(0, this, [this]() {
+            emit thumbnailCreated(QImage());
+            emit released();
         });
+        return;
     }
+
+    // Events carrying older request id belong to previous pages and are ignored
+    m_requestId++;
+    m_busy = true;
+    m_loadTimer->start(s_loadTimeout);
+    m_view->rootObject()->setProperty("requestId", m_requestId);
+    m_view->rootObject()->setProperty("url", m_url);
 }
 
 QString PageThumbnailer::afterLoadScript() const
@@ -92,17 +109,65 @@ QString PageThumbnailer::afterLoadScript() const
     return Scripts::setCss(QSL("::-webkit-scrollbar{display:none;}"));
 }
 
-void PageThumbnailer::createThumbnail(bool status)
+void PageThumbnailer::createThumbnail(bool status, const QUrl &url, int requestId)
 {
+    // Blank page is loaded after finishing to release the previous one
+    if (url == QUrl(QSL("about:blank"))) {
+        if (m_releasing && status) {
+            release();
+        }
+        return;
+    }
+
+    if (!m_busy || requestId != m_requestId) {
+        return;
+    }
+
     if (!status) {
-        emit thumbnailCreated(QPixmap());
+        finish(QImage());
         return;
     }
 
-    QTimer::singleShot(1000, this, [this]() {
-        m_title = m_view->rootObject()->property("title").toString().trimmed();
-        emit thumbnailCreated(QPixmap::fromImage(m_view->grabFramebuffer().scaled(m_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
-    });
+    // Grab the first frame rendered after the page finished loading
+    disconnect(m_renderConnection);
+    m_renderConnection = connect(m_view->quickWindow(), &QQuickWindow::afterRendering, this, &PageThumbnailer::grabThumbnail, Qt::QueuedConnection);
+    m_paintTimer->start();
+}
+
+void PageThumbnailer::grabThumbnail()
+{
+    if (!m_busy) {
+        return;
+    }
+
+    disconnect(m_renderConnection);
+    m_paintTimer->stop();
+
+    m_title = m_view->rootObject()->property("title").toString().trimmed();
+    finish(m_view->grabFramebuffer());
+}
+
+void PageThumbnailer::finish(const QImage &image)
+{
+    disconnect(m_renderConnection);
+    m_paintTimer->stop();
+    m_busy = false;
+
+    // View is reused only after the page is unloaded, so that its late
+    // load events can't be mistaken for events of the next request
+    m_releasing = true;
+    m_loadTimer->start(s_releaseTimeout);
+    m_view->rootObject()->setProperty("url", QUrl(QSL("about:blank")));
+
+    emit thumbnailCreated(image);
+}
+
+void PageThumbnailer::release()
+{
+    m_loadTimer->stop();
+    m_releasing = false;
+
+    emit released();
 }
 
 PageThumbnailer::~PageThumbnailer()
@@ -19,14 +19,15 @@
 #define PAGETHUMBNAILER_H
 
 #include <QObject>
-#include <QSize>
+#include <QImage>
 #include <QUrl>
 
 #include "qzcommon.h"
 
 class QQuickWidget;
-class QPixmap;
+class QTimer;
 
+// Offscreen view rendering pages, can be reused for multiple urls
 class FALKON_EXPORT PageThumbnailer : public QObject
 {
     Q_OBJECT
@@ -35,31 +36,39 @@ public:
     explicit PageThumbnailer(QObject* parent = 0);
     ~PageThumbnailer();
 
-    void setSize(const QSize &size);
+    QUrl url() const;
+    QString title() const;
+    bool isBusy() const;
 
-    void setUrl(const QUrl &url);
-    QUrl url();
-
-    bool loadTitle();
-    void setLoadTitle(bool load);
-    QString title();
-
-    void start();
+    // Loads url, thumbnailCreated is emitted once the page is painted.
+    // View can only be started again after released is emitted.
+    void start(const QUrl &url);
 
 Q_SIGNALS:
-    void thumbnailCreated(const QPixmap &);
+    // Unscaled frame of the page, null image on failure
+    void thumbnailCreated(const QImage &image);
+    // Previous page was unloaded and view can be started again
+    void released();
 
 public Q_SLOTS:
     QString afterLoadScript() const;
-    void createThumbnail(bool status);
+    void createThumbnail(bool status, const QUrl &url, int requestId);
 
 private:
+    void grabThumbnail();
+    void finish(const QImage &image);
+    void release();
+
     QQuickWidget *m_view;
+    QTimer *m_loadTimer;
+    QTimer *m_paintTimer;
+    QMetaObject::Connection m_renderConnection;
 
-    QSize m_size;
     QUrl m_url;
     QString m_title;
-    bool m_loadTitle;
+    int m_requestId;
+    bool m_busy;
+    bool m_releasing;
 };
 
 #endif // PAGETHUMBNAILER_H
@@ -21,6 +21,8 @@
 #include "webpage.h"
 
 #include <QUrlQuery>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QtWebEngineWidgetsVersion>
 
 QString Scripts::setupWebChannel()
@@ -130,6 +132,14 @@ QString Scripts::setupFormObserver()
                           "});"
                           "observer.observe(document.documentElement, { childList: true, subtree: true });"
                           ""
+                          "var modified = false;"
+                          "document.addEventListener('input', function(e) {"
+                          "    if (modified || !e.isTrusted)"
+                          "        return;"
+                          "    modified = true;"
+                          "    external.autoFill.formModified();"
+                          "}, true);"
+                          ""
                           "})()");
 
     return source;
@@ -165,6 +175,56 @@ QString Scripts::setupSpeedDial()
     return source;
 }
 
+QString Scripts::setupMagicWandTheme()
+{
+    return QzTools::readAllFileContents(QSL(":html/magicwand.js"));
+}
+
+QString Scripts::setupMagicWandCache(const QString &css, const QStringList &selectors, const QStringList &transSelectors)
+{
+    QString source = QL1S("(function() {"
+                          "var css = %1;"
+                          "window._falkon_magicwand_cache = {"
+                          "    selectors: new Set(%2),"
+                          "    trans: new Set(%3)"
+                          "};"
+                          ""
+                          "if (window.CSSStyleSheet && CSSStyleSheet.prototype.replaceSync && document.adoptedStyleSheets) {"
+                          "    var sheet = new CSSStyleSheet();"
+                          "    sheet.replaceSync(css);"
+                          "    document.adoptedStyleSheets = document.adoptedStyleSheets.concat([sheet]);"
+                          "    return;"
+                          "}"
+                          ""
+                          "var style = document.createElement('style');"
+                          "style.textContent = css;"
+                          "function insert() {"
+                          "    if (!document.documentElement)"
+                          "        return false;"
+                          "    document.documentElement.appendChild(style);"
+                          "    return true;"
+                          "}"
+                          "if (!insert()) {"
+                          "    var observer = new MutationObserver(function() {"
+                          "        if (insert())"
+                          "            observer.disconnect();"
+                          "    });"
+                          "    observer.observe(document, { childList: true });"
+                          "}"
+                          ""
+                          "})()");
+
+    auto toJson = [](const QJsonValue &value) {
+        // Wrap in array to get valid JSON for single value
+        const QByteArray json = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+        return QString::fromUtf8(json.mid(1, json.size() - 2));
+    };
+
+    return source.arg(toJson(css),
+                      toJson(QJsonArray::fromStringList(selectors)),
+                      toJson(QJsonArray::fromStringList(transSelectors)));
+}
+
 QString Scripts::setCss(const QString &css)
 {
     QString source = QL1S("(function() {"
@@ -19,7 +19,7 @@
 #ifndef SCRIPTS_H
 #define SCRIPTS_H
 
-#include <QString>
+#include <QStringList>
 
 #include "qzcommon.h"
 
@@ -32,6 +32,8 @@ public:
     static QString setupFormObserver();
     static QString setupWindowObject();
     static QString setupSpeedDial();
+    static QString setupMagicWandTheme();
+    static QString setupMagicWandCache(const QString &css, const QStringList &selectors, const QStringList &transSelectors);
 
     static QString setCss(const QString &css);
     static QString sendPostData(const QUrl &url, const QByteArray &data);
@@ -18,22 +18,66 @@
 #include "sqldatabase.h"
 
 #include <QApplication>
+#include <QCache>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QThreadStorage>
 #include <QFutureWatcher>
-#include <QtConcurrent/QtConcurrentRun>
+#include <QFutureInterface>
 
-QThreadStorage<QSqlDatabase> s_databases;
+#include <memory>
+
+// Connection of one thread with its prepared statements
+struct SqlConnection {
+    QString databaseName;
+    QSqlDatabase database;
+    QCache<QString, QSqlQuery> statements{32};
+};
+
+QThreadStorage<SqlConnection*> s_connections;
 
 Q_GLOBAL_STATIC(SqlDatabase, qz_sql_database)
 
+class SqlRunnable : public QRunnable
+{
+public:
+    explicit SqlRunnable(const std::function<void()> &function)
+        : m_function(function)
+    {
+        m_interface.reportStarted();
+    }
+
+    QFuture<void> future()
+    {
+        return m_interface.future();
+    }
+
+    void run() override
+    {
+        m_function();
+        m_interface.reportFinished();
+    }
+
+private:
+    std::function<void()> m_function;
+    QFutureInterface<void> m_interface;
+};
+
+static bool isReadQuery(const QString &query)
+{
+    return query.trimmed().startsWith(QL1S("SELECT"), Qt::CaseInsensitive);
+}
+
 // SqlQueryJob
 SqlQueryJob::SqlQueryJob(QObject *parent)
     : QObject(parent)
+    , m_priority(SqlDatabase::NormalPriority)
 {
 }
 
 SqlQueryJob::SqlQueryJob(const QString &query, QObject *parent)
     : QObject(parent)
+    , m_priority(SqlDatabase::NormalPriority)
 {
     setQuery(query);
 }
@@ -48,6 +92,11 @@ void SqlQueryJob::addBindValue(const QVariant &value)
     m_boundValues.append(value);
 }
 
+void SqlQueryJob::setPriority(SqlDatabase::Priority priority)
+{
+    m_priority = priority;
+}
+
 QSqlError SqlQueryJob::error() const
 {
     return m_error;
@@ -76,41 +125,55 @@ void SqlQueryJob::start()
     const QVector<QVariant> boundValues = m_boundValues;
     m_boundValues.clear();
 
-    auto watcher = new QFutureWatcher<Result>(this);
-    connect(watcher, &QFutureWatcher<Result>::finished, this, [=]() {
+    auto result = std::make_shared<Result>();
+
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
         deleteLater();
-        const auto result = watcher->result();
-        m_error = result.error;
-        m_lastInsertId = result.lastInsertId;
-        m_records = result.records;
+        m_error = result->error;
+        m_lastInsertId = result->lastInsertId;
+        m_records = result->records;
         emit finished(this);
     });
 
-    watcher->setFuture(QtConcurrent::run([=]() {
-        QSqlQuery q(SqlDatabase::instance()->database());
-        q.prepare(query);
+    auto run = [=]() {
+        QSqlQuery q = SqlDatabase::instance()->preparedQuery(query);
         for (const QVariant &value : boundValues) {
             q.addBindValue(value);
         }
         q.exec();
-        Result res;
-        res.error = q.lastError();
-        res.lastInsertId = q.lastInsertId();
+        result->error = q.lastError();
+        result->lastInsertId = q.lastInsertId();
         while (q.next()) {
-            res.records.append(q.record());
+            result->records.append(q.record());
         }
-        return res;
-    }));
+        q.finish();
+    };
+
+    if (isReadQuery(query)) {
+        watcher->setFuture(SqlDatabase::instance()->runRead(run, m_priority));
+    } else {
+        watcher->setFuture(SqlDatabase::instance()->runWrite(run));
+    }
 }
 
 // SqlDatabase
 SqlDatabase::SqlDatabase(QObject* parent)
     : QObject(parent)
 {
+    // Threads never expire, so number of open connections stays bounded
+    m_readPool = new QThreadPool(this);
+    m_readPool->setMaxThreadCount(2);
+    m_readPool->setExpiryTimeout(-1);
+
+    m_writePool = new QThreadPool(this);
+    m_writePool->setMaxThreadCount(1);
+    m_writePool->setExpiryTimeout(-1);
 }
 
 SqlDatabase::~SqlDatabase()
 {
+    waitForDone();
 }
 
 QSqlDatabase SqlDatabase::database()
@@ -119,23 +182,96 @@ QSqlDatabase SqlDatabase::database()
         return QSqlDatabase::database();
     }
 
-    if (!s_databases.hasLocalData()) {
-        const QString threadStr = QStringLiteral("Falkon/%1").arg((quintptr) QThread::currentThread());
-        QSqlDatabase::removeDatabase(threadStr);
-        QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"), threadStr);
-        db.setDatabaseName(m_databaseName);
-        db.setConnectOptions(m_connectOptions);
-        db.open();
-        s_databases.setLocalData(db);
+    if (!s_connections.hasLocalData()) {
+        s_connections.setLocalData(new SqlConnection);
+    }
+
+    // Database may have been changed since connection was opened
+    SqlConnection *connection = s_connections.localData();
+    if (connection->databaseName == m_databaseName && connection->database.isValid()) {
+        return connection->database;
+    }
+
+    connection->statements.clear();
+    connection->databaseName = m_databaseName;
+
+    const QString threadStr = QStringLiteral("Falkon/%1").arg((quintptr) QThread::currentThread());
+    connection->database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(threadStr);
+    QSqlDatabase db = QSqlDatabase::addDatabase(QSL("QSQLITE"), threadStr);
+    db.setDatabaseName(m_databaseName);
+    db.setConnectOptions(m_connectOptions);
+    db.open();
+    setupConnection(db);
+    connection->database = db;
+
+    return connection->database;
+}
+
+QSqlQuery SqlDatabase::preparedQuery(const QString &sql)
+{
+    const QSqlDatabase db = database();
+
+    // Statements are only cached for connections of worker threads
+    SqlConnection *connection = s_connections.hasLocalData() ? s_connections.localData() : nullptr;
+    if (connection) {
+        if (QSqlQuery *query = connection->statements.object(sql)) {
+            query->finish();
+            return *query;
+        }
     }
 
-    return s_databases.localData();
+    QSqlQuery query(db);
+    if (query.prepare(sql) && connection) {
+        connection->statements.insert(sql, new QSqlQuery(query));
+    }
+    return query;
 }
 
 void SqlDatabase::setDatabase(const QSqlDatabase &database)
 {
     m_databaseName = database.databaseName();
     m_connectOptions = database.connectOptions();
+
+    if (!m_connectOptions.contains(QL1S("QSQLITE_OPEN_READONLY"))) {
+        // Readers don't block the writer and the other way around
+        QSqlQuery query(database);
+        query.exec(QSL("PRAGMA journal_mode=WAL"));
+    }
+
+    setupConnection(database);
+}
+
+QFuture<void> SqlDatabase::runRead(const std::function<void()> &function, Priority priority)
+{
+    auto runnable = new SqlRunnable(function);
+    const QFuture<void> future = runnable->future();
+    m_readPool->start(runnable, priority);
+    return future;
+}
+
+QFuture<void> SqlDatabase::runWrite(const std::function<void()> &function)
+{
+    auto runnable = new SqlRunnable(function);
+    const QFuture<void> future = runnable->future();
+    m_writePool->start(runnable);
+    return future;
+}
+
+void SqlDatabase::waitForDone()
+{
+    m_readPool->waitForDone();
+    m_writePool->waitForDone();
+}
+
+// static
+void SqlDatabase::setupConnection(QSqlDatabase db)
+{
+    // Syncing on checkpoints only is safe with WAL, page cache is per connection
+    QSqlQuery query(db);
+    query.exec(QSL("PRAGMA synchronous=NORMAL"));
+    query.exec(QSL("PRAGMA cache_size=-8000"));
+    query.exec(QSL("PRAGMA mmap_size=67108864"));
 }
 
 // instance
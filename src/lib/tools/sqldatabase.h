@@ -21,9 +21,57 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
+#include <QFuture>
+
+#include <functional>
 
 #include "qzcommon.h"
 
+class QThreadPool;
+
+class FALKON_EXPORT SqlDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        LowPriority = 0,
+        NormalPriority = 1,
+        HighPriority = 2
+    };
+
+    explicit SqlDatabase(QObject* parent = 0);
+    ~SqlDatabase();
+
+    // Returns database connection for current thread
+    QSqlDatabase database();
+
+    // Returns query with sql prepared on connection for current thread.
+    // Prepared statements are reused, don't use two queries with the same sql at once.
+    QSqlQuery preparedQuery(const QString &sql);
+
+    // Sets database to be created for other threads
+    void setDatabase(const QSqlDatabase &database);
+
+    // Writes are serialized on single thread in the order they were queued, reads run
+    // on small pool of threads next to them. Each of these threads keeps its own connection.
+    QFuture<void> runRead(const std::function<void()> &function, Priority priority = NormalPriority);
+    QFuture<void> runWrite(const std::function<void()> &function);
+
+    // Waits for all reads and writes to finish
+    void waitForDone();
+
+    static SqlDatabase* instance();
+
+private:
+    static void setupConnection(QSqlDatabase db);
+
+    QString m_databaseName;
+    QString m_connectOptions;
+    QThreadPool *m_readPool;
+    QThreadPool *m_writePool;
+};
+
 class FALKON_EXPORT SqlQueryJob : public QObject
 {
     Q_OBJECT
@@ -35,6 +83,10 @@ public:
     void setQuery(const QString &query);
     void addBindValue(const QVariant &value);
 
+    // SELECT queries are executed as reads, everything else as writes.
+    // Priority only applies to reads, writes always run in order.
+    void setPriority(SqlDatabase::Priority priority);
+
     QSqlError error() const;
     QVariant lastInsertId() const;
     QVector<QSqlRecord> records() const;
@@ -47,30 +99,10 @@ Q_SIGNALS:
 private:
     QString m_query;
     QVector<QVariant> m_boundValues;
+    SqlDatabase::Priority m_priority;
     QSqlError m_error;
     QVariant m_lastInsertId;
     QVector<QSqlRecord> m_records;
 };
 
-class FALKON_EXPORT SqlDatabase : public QObject
-{
-    Q_OBJECT
-
-public:
-    explicit SqlDatabase(QObject* parent = 0);
-    ~SqlDatabase();
-
-    // Returns database connection for current thread
-    QSqlDatabase database();
-
-    // Sets database to be created for other threads
-    void setDatabase(const QSqlDatabase &database);
-
-    static SqlDatabase* instance();
-
-private:
-    QString m_databaseName;
-    QString m_connectOptions;
-};
-
 #endif // SQLDATABASE_H
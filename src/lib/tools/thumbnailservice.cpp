@@ -0,0 +1,183 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "thumbnailservice.h"
+#include "pagethumbnailer.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <QImage>
+#include <QSaveFile>
+#include <QApplication>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+// Idle views are destroyed when no thumbnail was requested for a while
+static const int s_idleTimeout = 30 * 1000;
+
+ThumbnailService::ThumbnailService(QObject *parent)
+    : QObject(parent)
+    , m_size(QSize(450, 253) * qApp->devicePixelRatio())
+    , m_maximumViews(2)
+    , m_idleTimer(new QTimer(this))
+{
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(s_idleTimeout);
+    connect(m_idleTimer, &QTimer::timeout, this, &ThumbnailService::releaseIdleViews);
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    qDeleteAll(m_views);
+}
+
+QSize ThumbnailService::thumbnailSize() const
+{
+    return m_size;
+}
+
+void ThumbnailService::setThumbnailSize(const QSize &size)
+{
+    if (size.isValid()) {
+        m_size = size;
+    }
+}
+
+int ThumbnailService::maximumViews() const
+{
+    return m_maximumViews;
+}
+
+void ThumbnailService::setMaximumViews(int count)
+{
+    m_maximumViews = qMax(1, count);
+}
+
+int ThumbnailService::viewsCount() const
+{
+    return m_views.count();
+}
+
+void ThumbnailService::requestThumbnail(const QUrl &url, const QString &fileName, Priority priority)
+{
+    for (const Request &running : qAsConst(m_running)) {
+        if (running.url == url) {
+            return;
+        }
+    }
+
+    for (int p = HighPriority; p >= NormalPriority; --p) {
+        QVector<Request> &queue = m_queue[p];
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue.at(i).url != url) {
+                continue;
+            }
+            // Never lower the priority of already queued request
+            if (priority > p) {
+                m_queue[priority].append(queue.takeAt(i));
+            }
+            return;
+        }
+    }
+
+    Request request;
+    request.url = url;
+    request.fileName = fileName;
+    m_queue[priority].append(request);
+
+    processQueue();
+}
+
+// static
+bool ThumbnailService::saveThumbnail(const QImage &image, const QSize &size, const QString &fileName)
+{
+    const QImage thumbnail = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    QSaveFile file(fileName);
+    if (!file.open(QFile::WriteOnly) || !thumbnail.save(&file, "PNG")) {
+        qWarning() << "ThumbnailService: Cannot save thumbnail to" << fileName;
+        return false;
+    }
+    return file.commit();
+}
+
+void ThumbnailService::processQueue()
+{
+    while (m_queue[HighPriority].size() + m_queue[NormalPriority].size() > 0) {
+        PageThumbnailer *thumbnailer = nullptr;
+
+        // Views still unloading previous page are counted too
+        if (!m_idle.isEmpty()) {
+            thumbnailer = m_idle.takeLast();
+        } else if (m_views.count() < m_maximumViews) {
+            thumbnailer = new PageThumbnailer(this);
+            connect(thumbnailer, &PageThumbnailer::thumbnailCreated, this, [this, thumbnailer](const QImage &image) {
+                thumbnailerFinished(thumbnailer, image);
+            });
+            connect(thumbnailer, &PageThumbnailer::released, this, [this, thumbnailer]() {
+                thumbnailerReleased(thumbnailer);
+            });
+            m_views.append(thumbnailer);
+        } else {
+            return;
+        }
+
+        QVector<Request> &queue = m_queue[HighPriority].isEmpty() ? m_queue[NormalPriority] : m_queue[HighPriority];
+        const Request request = queue.takeFirst();
+        m_running.insert(thumbnailer, request);
+        thumbnailer->start(request.url);
+    }
+
+    if (m_running.isEmpty() && !m_idle.isEmpty()) {
+        m_idleTimer->start();
+    }
+}
+
+void ThumbnailService::thumbnailerFinished(PageThumbnailer *thumbnailer, const QImage &image)
+{
+    const Request request = m_running.take(thumbnailer);
+    const QString title = thumbnailer->title();
+
+    if (image.isNull()) {
+        emit thumbnailCreated(request.url, false, title);
+        return;
+    }
+
+    // Scaling and PNG encoding are too slow for UI thread
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [=]() {
+        emit thumbnailCreated(request.url, watcher->result(), title);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&ThumbnailService::saveThumbnail, image, m_size, request.fileName));
+}
+
+void ThumbnailService::thumbnailerReleased(PageThumbnailer *thumbnailer)
+{
+    m_idleTimer->stop();
+    m_idle.append(thumbnailer);
+    processQueue();
+}
+
+void ThumbnailService::releaseIdleViews()
+{
+    for (PageThumbnailer *thumbnailer : qAsConst(m_idle)) {
+        m_views.removeOne(thumbnailer);
+    }
+    qDeleteAll(m_idle);
+    m_idle.clear();
+}
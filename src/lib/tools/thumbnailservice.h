@@ -0,0 +1,87 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QSize>
+#include <QUrl>
+
+#include "qzcommon.h"
+
+class QTimer;
+
+class PageThumbnailer;
+
+// Renders thumbnails of pages with a bounded pool of reused offscreen views
+class FALKON_EXPORT ThumbnailService : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        NormalPriority = 0,
+        HighPriority
+    };
+
+    explicit ThumbnailService(QObject *parent = nullptr);
+    ~ThumbnailService();
+
+    QSize thumbnailSize() const;
+    void setThumbnailSize(const QSize &size);
+
+    int maximumViews() const;
+    void setMaximumViews(int count);
+
+    // Number of currently existing views, never more than maximumViews
+    int viewsCount() const;
+
+    // Renders url and saves the thumbnail as PNG to fileName.
+    // Repeated requests for queued or running url are merged,
+    // only raising the priority of the queued one.
+    void requestThumbnail(const QUrl &url, const QString &fileName, Priority priority = NormalPriority);
+
+    static bool saveThumbnail(const QImage &image, const QSize &size, const QString &fileName);
+
+Q_SIGNALS:
+    void thumbnailCreated(const QUrl &url, bool success, const QString &title);
+
+private:
+    struct Request {
+        QUrl url;
+        QString fileName;
+    };
+
+    void processQueue();
+    void thumbnailerFinished(PageThumbnailer *thumbnailer, const QImage &image);
+    void thumbnailerReleased(PageThumbnailer *thumbnailer);
+    void releaseIdleViews();
+
+    QSize m_size;
+    int m_maximumViews;
+
+    QVector<Request> m_queue[HighPriority + 1];
+    QHash<PageThumbnailer*, Request> m_running;
+    QVector<PageThumbnailer*> m_views;
+    QVector<PageThumbnailer*> m_idle;
+    QTimer *m_idleTimer;
+};
+
+#endif // THUMBNAILSERVICE_H
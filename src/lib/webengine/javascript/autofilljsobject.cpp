@@ -37,3 +37,8 @@ void AutoFillJsObject::formSubmitted(const QString &frameUrl, const QString &use
 
     mApp->autoFill()->saveForm(m_jsObject->page(), QUrl(frameUrl), formData);
 }
+
+void AutoFillJsObject::formModified()
+{
+    m_jsObject->page()->setFormModified(true);
+}
@@ -31,6 +31,7 @@ public:
 
 public Q_SLOTS:
     void formSubmitted(const QString &frameUrl, const QString &username, const QString &password, const QByteArray &data);
+    void formModified();
 
 private:
     ExternalJsObject *m_jsObject;
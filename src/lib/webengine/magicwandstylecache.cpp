@@ -0,0 +1,231 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "magicwandstylecache.h"
+#include "mainapplication.h"
+#include "datapaths.h"
+#include "qztools.h"
+#include "scripts.h"
+
+#include <QDir>
+#include <QUrl>
+#include <QFile>
+#include <QSaveFile>
+#include <QRegularExpression>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+
+// Bump when magicwand.js changes its decisions
+static const int s_cacheVersion = 1;
+static const int s_maxRulesPerOrigin = 5000;
+static const int s_maxCachedOrigins = 100;
+
+MagicWandStyleCache::MagicWandStyleCache(QObject *parent)
+    : QObject(parent)
+    , m_enabled(!mApp->isPrivate())
+    , m_path(DataPaths::currentProfilePath() + QL1S("/magicwand/"))
+    , m_entries(s_maxCachedOrigins)
+{
+}
+
+QString MagicWandStyleCache::cacheScript(const QUrl &url)
+{
+    Entry *e = entry(originForUrl(url));
+    if (!e || e->rules.isEmpty()) {
+        return QString();
+    }
+
+    if (e->script.isEmpty()) {
+        QString css;
+        QStringList selectors;
+        QStringList transSelectors;
+        for (auto it = e->rules.constBegin(); it != e->rules.constEnd(); ++it) {
+            if (it->conflict) {
+                continue;
+            }
+            selectors.append(it.key());
+            if (it->trans) {
+                transSelectors.append(it.key());
+            }
+            if (!it->style.isEmpty()) {
+                css.append(it.key() + QL1C('{') + it->style + QL1C('}'));
+            }
+        }
+        e->script = Scripts::setupMagicWandCache(css, selectors, transSelectors);
+    }
+
+    return e->script;
+}
+
+void MagicWandStyleCache::addDecisions(const QUrl &url, const QVariantList &decisions)
+{
+    const QString origin = originForUrl(url);
+    Entry *e = entry(origin);
+    if (!e) {
+        return;
+    }
+
+    bool changed = false;
+
+    for (const QVariant &decision : decisions) {
+        const QVariantMap map = decision.toMap();
+        const QString selector = map.value(QSL("selector")).toString();
+        if (selector.isEmpty()) {
+            continue;
+        }
+
+        Rule rule;
+        rule.style = map.value(QSL("style")).toString();
+        rule.trans = map.value(QSL("trans")).toBool();
+        rule.conflict = map.value(QSL("conflict")).toBool();
+
+        if (!isValidRule(selector, rule)) {
+            continue;
+        }
+
+        auto it = e->rules.find(selector);
+        if (it == e->rules.end()) {
+            if (e->rules.count() >= s_maxRulesPerOrigin) {
+                continue;
+            }
+            e->rules.insert(selector, rule);
+            changed = true;
+        } else if (!it->conflict && (rule.conflict || it->style != rule.style || it->trans != rule.trans)) {
+            // Same selector themed differently in other context
+            it->conflict = true;
+            it->style.clear();
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        e->script.clear();
+        save(origin, e);
+    }
+}
+
+void MagicWandStyleCache::clear()
+{
+    m_entries.clear();
+    QzTools::removeRecursively(m_path);
+}
+
+// static
+QString MagicWandStyleCache::originForUrl(const QUrl &url)
+{
+    if (url.scheme() != QL1S("http") && url.scheme() != QL1S("https")) {
+        return QString();
+    }
+    return url.scheme() + QL1S("://") + url.host() + QL1C(':') + QString::number(url.port(url.scheme() == QL1S("https") ? 443 : 80));
+}
+
+// static
+bool MagicWandStyleCache::isValidRule(const QString &selector, const Rule &rule)
+{
+    // Values come from the page world, don't let them escape the rule.
+    // Selector must have exactly the form created by selectorFor() in magicwand.js,
+    // with braces, semicolons and quotes only allowed as CSS escapes.
+    static const QString escape = QSL("\\\\(?:[0-9a-fA-F]{1,6} ?|[^\\n\\r\\f0-9a-fA-F])");
+    static const QRegularExpression selectorRx(QSL("^[a-zA-Z][-_a-zA-Z0-9]*"
+                                                   "(?:#(?:%1|[-_a-zA-Z0-9]|[^\\x{00}-\\x{7F}])+)?"
+                                                   "(?:\\[class=\"(?:%1|[^\"\\\\\\n\\r\\f{};])*\"\\]|:not\\(\\[class\\]\\))$").arg(escape));
+
+    if (!selectorRx.match(selector).hasMatch()) {
+        return false;
+    }
+
+    return !rule.style.contains(QL1C('{')) && !rule.style.contains(QL1C('}')) && !rule.style.contains(QL1S("/*"));
+}
+
+QString MagicWandStyleCache::filePath(const QString &origin) const
+{
+    return m_path + QString::fromLatin1(QCryptographicHash::hash(origin.toUtf8(), QCryptographicHash::Md4).toHex()) + QL1S(".json");
+}
+
+MagicWandStyleCache::Entry *MagicWandStyleCache::entry(const QString &origin)
+{
+    if (!m_enabled || origin.isEmpty()) {
+        return nullptr;
+    }
+
+    Entry *e = m_entries.object(origin);
+    if (!e) {
+        e = load(origin);
+        m_entries.insert(origin, e);
+    }
+    return e;
+}
+
+MagicWandStyleCache::Entry *MagicWandStyleCache::load(const QString &origin) const
+{
+    Entry *e = new Entry;
+
+    QFile file(filePath(origin));
+    if (!file.open(QFile::ReadOnly)) {
+        return e;
+    }
+
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (json.value(QSL("version")).toInt() != s_cacheVersion || json.value(QSL("origin")).toString() != origin) {
+        return e;
+    }
+
+    const QJsonObject rules = json.value(QSL("rules")).toObject();
+    for (auto it = rules.constBegin(); it != rules.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        Rule rule;
+        rule.style = obj.value(QSL("style")).toString();
+        rule.trans = obj.value(QSL("trans")).toBool();
+        rule.conflict = obj.value(QSL("conflict")).toBool();
+        if (isValidRule(it.key(), rule)) {
+            e->rules.insert(it.key(), rule);
+        }
+    }
+
+    return e;
+}
+
+void MagicWandStyleCache::save(const QString &origin, const Entry *entry) const
+{
+    QJsonObject rules;
+    for (auto it = entry->rules.constBegin(); it != entry->rules.constEnd(); ++it) {
+        QJsonObject obj;
+        if (it->conflict) {
+            obj.insert(QSL("conflict"), true);
+        } else {
+            obj.insert(QSL("style"), it->style);
+            obj.insert(QSL("trans"), it->trans);
+        }
+        rules.insert(it.key(), obj);
+    }
+
+    QJsonObject json;
+    json.insert(QSL("version"), s_cacheVersion);
+    json.insert(QSL("origin"), origin);
+    json.insert(QSL("rules"), rules);
+
+    QDir().mkpath(m_path);
+
+    QSaveFile file(filePath(origin));
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "MagicWandStyleCache: Cannot write" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    file.commit();
+}
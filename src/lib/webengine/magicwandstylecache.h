@@ -0,0 +1,71 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef MAGICWANDSTYLECACHE_H
+#define MAGICWANDSTYLECACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QVariant>
+
+#include "qzcommon.h"
+
+class QUrl;
+
+// Per-origin stylesheets generated from decisions of the theming engine (magicwand.js)
+class FALKON_EXPORT MagicWandStyleCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MagicWandStyleCache(QObject *parent = nullptr);
+
+    // Returns DocumentCreation script applying cached stylesheet, empty if nothing is cached
+    QString cacheScript(const QUrl &url);
+
+    // Merges decisions recorded by theming engine on page with url
+    void addDecisions(const QUrl &url, const QVariantList &decisions);
+
+    void clear();
+
+private:
+    struct Rule {
+        QString style;
+        bool trans = false;
+        bool conflict = false;
+    };
+
+    struct Entry {
+        QHash<QString, Rule> rules;
+        QString script;
+    };
+
+    static QString originForUrl(const QUrl &url);
+    static bool isValidRule(const QString &selector, const Rule &rule);
+    QString filePath(const QString &origin) const;
+
+    Entry *entry(const QString &origin);
+    Entry *load(const QString &origin) const;
+    void save(const QString &origin, const Entry *entry) const;
+
+    bool m_enabled;
+    QString m_path;
+    QCache<QString, Entry> m_entries;
+};
+
+#endif // MAGICWANDSTYLECACHE_H
@@ -43,6 +43,7 @@
 #include "passwordmanager.h"
 #include "scripts.h"
 #include "ocssupport.h"
+#include "magicwandstylecache.h"
 
 #include <iostream>
 
@@ -51,6 +52,7 @@
 #include <QWebChannel>
 #include <QWebEngineHistory>
 #include <QWebEngineSettings>
+#include <QWebEngineScriptCollection>
 #include <QTimer>
 #include <QDesktopServices>
 #include <QMessageBox>
@@ -84,6 +86,9 @@ WebPage::WebPage(QObject* parent)
     ExternalJsObject::setupWebChannel(channel, this);
     setWebChannel(channel, SafeJsWorld);
 
+    connect(this, &QWebEnginePage::loadStarted, this, [this]() {
+        m_loadCount++;
+    });
     connect(this, &QWebEnginePage::loadProgress, this, &WebPage::progress);
     connect(this, &QWebEnginePage::loadFinished, this, &WebPage::finished);
     connect(this, &QWebEnginePage::urlChanged, this, &WebPage::urlChanged);
@@ -218,6 +223,21 @@ bool WebPage::isLoading() const
     return m_loadProgress < 100;
 }
 
+int WebPage::loadCount() const
+{
+    return m_loadCount;
+}
+
+bool WebPage::isFormModified() const
+{
+    return m_formModified;
+}
+
+void WebPage::setFormModified(bool modified)
+{
+    m_formModified = modified;
+}
+
 // static
 QStringList WebPage::internalSchemes()
 {
@@ -263,6 +283,7 @@ void WebPage::urlChanged(const QUrl &url)
 
     if (isLoading()) {
         m_blockAlerts = false;
+        m_formModified = false;
     }
 }
 
@@ -303,157 +324,47 @@ void WebPage::finished()
     }
 
     // AutoFill
-    m_autoFillUsernames = mApp->autoFill()->completePage(this, url());
+    m_autoFillUsernames.clear();
+    mApp->autoFill()->completePage(this, url());
     this->setBackgroundColor(Qt::transparent);
-    const char * transparencyScript = R"V(
-    (function () {
-    var v = document.createElement("style");
-    v.innerHTML = "body,html,.darkmode-background,.darkmode-layer,html,.trans:not(.quaz),html[dark]{background:transparent !important;}::-webkit-scrollbar {    background-color:#ffffff00;    width:8px;height:8px;}::-webkit-scrollbar-track {    background-color:#ffffff00;width:16px;height:16px;}::-webkit-scrollbar-thumb {    background-color:#babac080;    border-radius:8px;    border:4px solid transparent}::-webkit-scrollbar-button {display:none} .bblur{background:rgba(49, 49, 58,0.2) !important;}";
-    document.body.append(v);
-
-    function getBkColor(el) {
-        var c = window.getComputedStyle(el, null).getPropertyValue("background-color");
-        var mt = /\d+/g;
-        if (c.match(mt)) {
-            var q = c.match(mt).map(parseFloat);
-            return q.length < 4 ? q.concat([1]) : q;
-        }
-        return [0, 0, 0, 0];
-    }
 
-    function bkInfluence(e) {
-        if (!e.parentElement) {
-            return 0;
+    // Transparency theming, script guards itself against repeated injection
+    runJavaScript(Scripts::setupMagicWandTheme());
+
+    // Collect decisions for per-origin stylesheet once the initial pass is done
+    const QUrl pageUrl = url();
+    QTimer::singleShot(2000, this, [=]() {
+        if (url() != pageUrl) {
+            return;
         }
-        var a = getBkColor(e);
-        var b = getBkColor(e.parentElement);
-        var diff = [Math.abs(a[0] - b[0]) / 255, Math.abs(a[1] - b[1]) / 255, Math.abs(a[2] - b[2]) / 255];
-        return (diff[0] + diff[2] + diff[2]) * a[3] / 3;
-    }
-
-    function shouldT(e) {
-        var c = window.getComputedStyle(e, null).getPropertyValue("background-color");
-        var mt = /\d+/g;
-        if (c.match(mt)) {
-            var cc = c.match(mt).map(parseFloat);
-            var tcond = (!(cc.length > 3 && cc[3] < 0.25) || e.classList.contains("trans"));
-            if (cc[0] + cc[1] + cc[2] > 127 * 3 || tcond) {
-                if (tcond && e.parentElement) {
-                    return !shouldT(e.parentElement);
-                }
-                return true;
+        runJavaScript(QSL("window._falkon_magicwand ? window._falkon_magicwand.decisions() : null"), [=](const QVariant &res) {
+            if (res.type() == QVariant::List) {
+                mApp->magicWandStyleCache()->addDecisions(pageUrl, res.toList());
             }
-        }
-        return false;
+        });
+    });
+}
+
+void WebPage::setupMagicWandCache(const QUrl &url)
+{
+    const QString name = QSL("_falkon_magicwand_cache");
+
+    QWebEngineScript oldScript = scripts().findScript(name);
+    if (!oldScript.isNull()) {
+        scripts().remove(oldScript);
     }
 
-    function colorWild(color) {
-        var ave = (color[0] + color[1] + color[2]) / 255 / 3;
-        var st = (color.slice(0, 3).map(x => (x / 255 - ave) ** 2).reduce((a, b) => a + b) / 2) ** 0.5;
-        return st;
-    }
-    var tim = 0;
-
-    function magicWandTheme() {
-        tim += 1;
-        var all = document.querySelectorAll(tim % 10 === 0 ? "*" : "*:not(.dark-checked)");
-        for (var i = 0; i < all.length; i++) {
-            var e = all[i];
-            e.classList.add("dark-checked");
-            var c = window.getComputedStyle(e, null).getPropertyValue("background-color");
-            var bi = window.getComputedStyle(e, null).getPropertyValue("background-image");
-            var cd = window.getComputedStyle(e, null).getPropertyValue("position");
-            var mt = /\d+/g;
-            if (c.match(mt)) {
-                var cc = c.match(mt).map(parseFloat);
-                if (cc[0] + cc[1] + cc[2] < 127 * 3 / 4) {
-                    e.style.backgroundColor = "rgba(0,0,0,0)";
-                    if (!(cc.length > 3 && cc[3] < 0.25)) {
-                        e.classList.add("trans")
-                    }
-                }
-                if (e.classList.contains("docos-avatar")) {
-                    e.style.zIndex = 1; //fix google doc avatar
-                }
-                if (shouldT(e) || (bkInfluence(e) < 1 / 3 || cc[0] + cc[1] + cc[2] > 127 * 3 || (e.style.backgroundImage.substring(0, "linear-gradient".length) == "linear-gradient"))) { //||(cc.length>3&&cc[3]<0.25)){
-                    //e.style.backgroundColor="rgba(0,0,0,0)";
-                    e.style.backgroundColor = "rgba(" + cc[0] + "," + cc[1] + "," + cc[2] + "," + Math.max(colorWild(cc), 0) + ")";
-                    if (cc.length < 4 && colorWild(cc) > 0.125) {
-                        e.classList.add("quaz")
-                    }
-                    if (!(cc.length > 3 && cc[3] < 0.25)) {
-                        e.classList.add("trans")
-                    }
-                    if (!(bi.length > 3 && (bi.substring(0, 3) === "non"))) { //||bi.substring(0,3)==="url"))){
-                        // console.log(e.style.backgroundImage.substring(0,3));
-                        if (bi.match("gradient") || e.webkitMatchesSelector(".vectorTabs li")) { //}.substring(0,"linear-gradient".length)=="linear-gradient"||e.webkitMatchesSelector(".vectorTabs li")  ){
-                            e.style.backgroundImage = "none";
-                        }
-                    }
-
-                    var tcond = (!(cc.length > 3 && cc[3] < 0.25) || e.classList.contains("trans"));
-                    //console.log(tcond);
-                    if (tcond || e.tagName.toLowerCase() !== "span" || true && !(e.webkitMatchesSelector("pre code span"))) e.style.color = "rgba(255,255,255,1)";
-                    var nt = bkInfluence(e) > 1 / 2 || e.style.boxShadow != "none";
-                    if (tcond && ((cd === "absolute" || cd === "fixed" || cd === "sticky" || !(e.parentElement && shouldT(e.parentElement))) || (nt && !(e.parentElement && shouldT(e.parentElement))))) {
-                        if ((!(e.parentElement && e.parentElement.innerText && e.parentElement.innerText.length < e.innerText.length + 2) || nt) &&
-                            (!e.webkitMatchesSelector("ytd-app,ytd-watch-flexy"))) {
-                            //console.log(e.style);
-                            e.style.backdropFilter = "blur(5px) opacity(0.8)";
-                            //if(cc[0]+cc[1]+cc[2]<255*3/2){
-                                e.classList.add("bblur");
-                            e.style.backdropFilter = "opacity(" + (1 - Math.abs((cc[0] + cc[1] + cc[2]) / 255 / 3 - 0.5) / 5 * 2) + ") blur(5px)";
-                            //}
-                            if (cc.length < 4) {
-                                e.style.backgroundColor = "rgba(" + cc[0] + "," + cc[1] + "," + cc[2] + "," + Math.max(colorWild(cc), 0) + ")";
-                                if (colorWild(cc) > 0.125) e.classList.add("quaz")
-                            }
-                            e.style.boxShadow = "none";
-                        }
-                    }
-                }
-            }
-            var c = window.getComputedStyle(e, null).getPropertyValue("border-left-color");
-            var mt = /\d+/g;
-            if (c.match(mt)) {
-                var cc = c.match(mt).map(parseFloat);
-                if (cc[0] + cc[1] + cc[2] > 127 * 3 && (cc.length < 4 || cc[3] > 0.25)) {
-                    e.style.borderLeftColor = "rgb(255,255,255)";
-                }
-            }
-            var c = window.getComputedStyle(e, null).getPropertyValue("border-right-color");
-            var mt = /\d+/g;
-            if (c.match(mt)) {
-                var cc = c.match(mt).map(parseFloat);
-                if (cc[0] + cc[1] + cc[2] > 127 * 3 && (cc.length < 4 || cc[3] > 0.25)) {
-                    e.style.borderRightColor = "rgb(255,255,255)";
-                }
-            }
-            var c = window.getComputedStyle(e, null).getPropertyValue("border-top-color");
-            var mt = /\d+/g;
-            if (c.match(mt)) {
-                var cc = c.match(mt).map(parseFloat);
-                if (cc[0] + cc[1] + cc[2] > 127 * 3 && (cc.length < 4 || cc[3] > 0.25)) {
-                    e.style.borderTopColor = "rgb(255,255,255)";
-                }
-            }
-            var c = window.getComputedStyle(e, null).getPropertyValue("border-bottom-color");
-            var mt = /\d+/g;
-            if (c.match(mt)) {
-                var cc = c.match(mt).map(parseFloat);
-                if (cc[0] + cc[1] + cc[2] > 127 * 3 && (cc.length < 4 || cc[3] > 0.25)) {
-                    e.style.borderBottomColor = "rgb(255,255,255)";
-                }
-            }
-        }
+    const QString source = mApp->magicWandStyleCache()->cacheScript(url);
+    if (source.isEmpty()) {
+        return;
     }
-    window.setInterval(magicWandTheme, 10);
-    //var v2=document.createElement("script");
-    //v2.src="https://cdn.jsdelivr.net/npm/darkmode-js@1.5.3/lib/darkmode-js.min.js";
-    //document.body.append(v2);
-    //window.setTimeout(()=>{window.dark=new Darkmode();if(!window.dark.isActivated()){window.dark.toggle();}},1000);
-})();)V";
-    this->runJavaScript(QString::fromUtf8(transparencyScript));
+
+    QWebEngineScript script;
+    script.setName(name);
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(WebPage::UnsafeJsWorld);
+    script.setSourceCode(source);
+    scripts().insert(script);
 }
 
 void WebPage::watchedFileChanged(const QString &file)
@@ -615,6 +526,7 @@ bool WebPage::acceptNavigationRequest(const QUrl &url, QWebEnginePage::Navigatio
             const bool isWeb = url.scheme() == QL1S("http") || url.scheme() == QL1S("https") || url.scheme() == QL1S("file");
             const bool globalJsEnabled = mApp->webSettings()->testAttribute(QWebEngineSettings::JavascriptEnabled);
             settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, isWeb ? globalJsEnabled : true);
+            setupMagicWandCache(url);
         }
         emit navigationRequestAccepted(url, type, isMainFrame);
     }
@@ -661,6 +573,12 @@ QStringList WebPage::autoFillUsernames() const
     return m_autoFillUsernames;
 }
 
+void WebPage::setAutoFillUsernames(const QStringList &usernames)
+{
+    m_autoFillUsernames = usernames;
+    emit autoFillUsernamesChanged(m_autoFillUsernames);
+}
+
 QUrl WebPage::registerProtocolHandlerRequestUrl() const
 {
 #if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 11, 0)
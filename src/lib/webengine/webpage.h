@@ -63,6 +63,7 @@ public:
     void javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString &message, int lineNumber, const QString &sourceID) override;
 
     QStringList autoFillUsernames() const;
+    void setAutoFillUsernames(const QStringList &usernames);
 
     QUrl registerProtocolHandlerRequestUrl() const;
     QString registerProtocolHandlerRequestScheme() const;
@@ -71,6 +72,14 @@ public:
 
     bool isLoading() const;
 
+    // Increased with every started load, results of asynchronous work
+    // started for previous load can be recognized with it
+    int loadCount() const;
+
+    // User edited a form field in current document
+    bool isFormModified() const;
+    void setFormModified(bool modified);
+
     static QStringList internalSchemes();
     static QStringList supportedSchemes();
     static void addSupportedScheme(const QString &scheme);
@@ -79,6 +88,7 @@ public:
 Q_SIGNALS:
     void privacyChanged(bool status);
     void printRequested();
+    void autoFillUsernamesChanged(const QStringList &usernames);
     void navigationRequestAccepted(const QUrl &url, NavigationType type, bool isMainFrame);
 
 protected Q_SLOTS:
@@ -101,6 +111,7 @@ private:
 
     void handleUnknownProtocol(const QUrl &url);
     void desktopServicesOpen(const QUrl &url);
+    void setupMagicWandCache(const QUrl &url);
 
     static QString s_lastUploadLocation;
     static QUrl s_lastUnsupportedUrl;
@@ -113,8 +124,10 @@ private:
     QWebEngineRegisterProtocolHandlerRequest *m_registerProtocolHandlerRequest = nullptr;
 
     int m_loadProgress;
+    int m_loadCount = 0;
     bool m_blockAlerts;
     bool m_secureStatus;
+    bool m_formModified = false;
 
     QMetaObject::Connection m_contentsResizedConnection;
 
@@ -81,8 +81,8 @@ WebView::WebView(QWidget* parent)
     // webEngineView->setStyleSheet("background:transparent");
     webEngineView->setStyleSheet("background:transparent");
 
-    // webEngineView->page()->setBackgroundColor(Qt::red);
-    webEngineView->page()->setBackgroundColor(Qt::transparent);
+    // Background color is set on the page in setPage(), calling page() here
+    // would create a default QWebEnginePage only to replace it right away
     // auto openGLWidget =webEngineView->findChild<QOpenGLWidget *>();
     // openGLWidget->setAttribute(Qt::WA_AlwaysStackOnTop, false);
     connect(this, &QWebEngineView::loadStarted, this, &WebView::slotLoadStarted);
@@ -175,6 +175,7 @@ void WebView::setPage(WebPage *page)
     }
 
     page->setParent(this);
+    page->setBackgroundColor(Qt::transparent);
     QWebEngineView::setPage(page);
     delete m_page;
     m_page = page;
@@ -186,6 +187,7 @@ void WebView::setPage(WebPage *page)
 
     connect(m_page, &WebPage::privacyChanged, this, &WebView::privacyChanged);
     connect(m_page, &WebPage::printRequested, this, &WebView::printPage);
+    connect(m_page, &WebPage::autoFillUsernamesChanged, this, &WebView::autoFillUsernamesChanged);
 
     // Set default zoom level
     zoomReset();
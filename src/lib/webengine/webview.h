@@ -78,6 +78,7 @@ Q_SIGNALS:
     void viewportResized(QSize);
     void showNotification(QWidget*);
     void privacyChanged(bool);
+    void autoFillUsernamesChanged(const QStringList &usernames);
     void zoomLevelChanged(int);
     void backgroundActivityChanged(bool);
 
@@ -36,10 +36,11 @@
 #include <QTimer>
 #include <QSplitter>
 
-static const int savedTabVersion = 6;
+static const int savedTabVersion = 7;
 
 WebTab::SavedTab::SavedTab()
-    : isPinned(false)
+    : iconInDatabase(true)
+    , isPinned(false)
     , zoomLevel(qzSettings->defaultZoomLevel)
     , parentTab(-1)
 {
@@ -50,6 +51,7 @@ WebTab::SavedTab::SavedTab(WebTab* webTab)
     title = webTab->title();
     url = webTab->url();
     icon = webTab->icon(true);
+    iconInDatabase = icon.isNull() || !IconProvider::imageForUrl(url, /*allowNull*/ true).isNull();
     history = webTab->historyData();
     isPinned = webTab->isPinned();
     zoomLevel = webTab->zoomLevel();
@@ -74,6 +76,7 @@ void WebTab::SavedTab::clear()
     title.clear();
     url.clear();
     icon = QIcon();
+    iconInDatabase = true;
     history.clear();
     isPinned = false;
     zoomLevel = qzSettings->defaultZoomLevel;
@@ -87,7 +90,12 @@ QDataStream &operator <<(QDataStream &stream, const WebTab::SavedTab &tab)
     stream << savedTabVersion;
     stream << tab.title;
     stream << tab.url;
-    stream << tab.icon.pixmap(16);
+
+    stream << tab.iconInDatabase;
+    if (!tab.iconInDatabase) {
+        stream << tab.icon.pixmap(16);
+    }
+
     stream << tab.history;
     stream << tab.isPinned;
     stream << tab.zoomLevel;
@@ -109,7 +117,14 @@ QDataStream &operator >>(QDataStream &stream, WebTab::SavedTab &tab)
     QPixmap pixmap;
     stream >> tab.title;
     stream >> tab.url;
-    stream >> pixmap;
+
+    bool iconInDatabase = false;
+    if (version >= 7)
+        stream >> iconInDatabase;
+
+    if (!iconInDatabase)
+        stream >> pixmap;
+
     stream >> tab.history;
 
     if (version >= 2)
@@ -128,32 +143,24 @@ QDataStream &operator >>(QDataStream &stream, WebTab::SavedTab &tab)
         stream >> tab.sessionData;
 
     tab.icon = QIcon(pixmap);
+    tab.iconInDatabase = pixmap.isNull();
 
     return stream;
 }
 
 WebTab::WebTab(QWidget *parent)
     : QWidget(parent)
+    , m_lastActivated(QDateTime::currentDateTimeUtc())
 {
     setObjectName(QSL("webtab"));
 
-    m_webView = new TabbedWebView(this);
-    m_webView->setPage(new WebPage);
-    m_webView->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
-    setFocusProxy(m_webView);
-
-    m_locationBar = new LocationBar(this);
-    m_locationBar->setWebView(m_webView);
-
+    // WebView and LocationBar are created in createWebView() on first use
     m_tabIcon = new TabIcon(this);
     m_tabIcon->setWebTab(this);
 
     m_layout = new QVBoxLayout(this);
     m_layout->setContentsMargins(0, 0, 0, 0);
     m_layout->setSpacing(0);
-    m_layout->addWidget(m_webView);
-
-    
 
     QWidget *viewWidget = new QWidget(this);
     viewWidget->setLayout(m_layout);
@@ -187,22 +194,6 @@ WebTab::WebTab(QWidget *parent)
     nlayout->setContentsMargins(0, 0, 0, 0);
     nlayout->setSpacing(1);
 
-    connect(m_webView, &WebView::showNotification, this, &WebTab::showNotification);
-    connect(m_webView, &QWebEngineView::loadFinished, this, &WebTab::loadFinished);
-    connect(m_webView, &TabbedWebView::titleChanged, this, &WebTab::titleWasChanged);
-    connect(m_webView, &TabbedWebView::titleChanged, this, &WebTab::titleChanged);
-    connect(m_webView, &TabbedWebView::iconChanged, this, &WebTab::iconChanged);
-    connect(m_webView, &TabbedWebView::backgroundActivityChanged, this, &WebTab::backgroundActivityChanged);
-    connect(m_webView, &TabbedWebView::loadStarted, this, std::bind(&WebTab::loadingChanged, this, true));
-    connect(m_webView, &TabbedWebView::loadFinished, this, std::bind(&WebTab::loadingChanged, this, false));
-
-    auto pageChanged = [this](WebPage *page) {
-        connect(page, &WebPage::audioMutedChanged, this, &WebTab::playingChanged);
-        connect(page, &WebPage::recentlyAudibleChanged, this, &WebTab::mutedChanged);
-    };
-    pageChanged(m_webView->page());
-    connect(m_webView, &TabbedWebView::pageChanged, this, pageChanged);
-
     // Workaround QTabBar not immediately noticing resizing of tab buttons
     connect(m_tabIcon, &TabIcon::resized, this, [this]() {
         if (m_tabBar) {
@@ -217,6 +208,14 @@ BrowserWindow *WebTab::browserWindow() const
 }
 
 TabbedWebView* WebTab::webView() const
+{
+    if (!m_webView) {
+        const_cast<WebTab*>(this)->createWebView();
+    }
+    return m_webView;
+}
+
+bool WebTab::hasWebView() const
 {
     return m_webView;
 }
@@ -232,7 +231,7 @@ void WebTab::showWebInspector(bool inspectElement)
         return;
 
     WebInspector *inspector = new WebInspector(this);
-    inspector->setView(m_webView);
+    inspector->setView(webView());
     if (inspectElement)
         inspector->inspectElement();
 
@@ -254,9 +253,10 @@ void WebTab::showSearchToolBar(const QString &searchText)
     const int index = 1;
 
     SearchToolBar *toolBar = nullptr;
+    TabbedWebView *view = webView();
 
     if (m_layout->count() == 1) {
-        toolBar = new SearchToolBar(m_webView, this);
+        toolBar = new SearchToolBar(view, this);
         m_layout->insertWidget(index, toolBar);
     } else if (m_layout->count() == 2) {
         Q_ASSERT(qobject_cast<SearchToolBar*>(m_layout->itemAt(index)->widget()));
@@ -272,7 +272,7 @@ void WebTab::showSearchToolBar(const QString &searchText)
 
 QUrl WebTab::url() const
 {
-    if (isRestored()) {
+    if (isRestored() && m_webView) {
         if (m_webView->url().isEmpty() && m_webView->isLoading()) {
             return m_webView->page()->requestedUrl();
         }
@@ -286,6 +286,10 @@ QUrl WebTab::url() const
 QString WebTab::title(bool allowEmpty) const
 {
     if (isRestored()) {
+        if (!m_webView) {
+            // Blank placeholder tab
+            return allowEmpty ? QString() : WebView::tr("Empty Page");
+        }
         return m_webView->title(allowEmpty);
     }
     else {
@@ -295,30 +299,33 @@ QString WebTab::title(bool allowEmpty) const
 
 QIcon WebTab::icon(bool allowNull) const
 {
-    if (isRestored()) {
+    if (isRestored() && m_webView) {
         return m_webView->icon(allowNull);
     }
 
-    if (allowNull || !m_savedTab.icon.isNull()) {
+    if (!m_savedTab.icon.isNull()) {
         return m_savedTab.icon;
     }
 
-    return IconProvider::emptyWebIcon();
+    return IconProvider::iconForUrl(m_savedTab.url, allowNull);
 }
 
 QWebEngineHistory* WebTab::history() const
 {
-    return m_webView->history();
+    return webView()->history();
 }
 
 int WebTab::zoomLevel() const
 {
+    if (!m_webView) {
+        return m_savedTab.zoomLevel;
+    }
     return m_webView->zoomLevel();
 }
 
 void WebTab::setZoomLevel(int level)
 {
-    m_webView->setZoomLevel(level);
+    webView()->setZoomLevel(level);
 }
 
 void WebTab::detach()
@@ -336,10 +343,12 @@ void WebTab::detach()
     // Remove the tab from tabbar
     m_window->tabWidget()->removeTab(tabIndex());
     setParent(nullptr);
-    // Remove the locationbar from window
-    m_locationBar->setParent(this);
-    // Detach TabbedWebView
-    m_webView->setBrowserWindow(nullptr);
+    if (m_webView) {
+        // Remove the locationbar from window
+        m_locationBar->setParent(this);
+        // Detach TabbedWebView
+        m_webView->setBrowserWindow(nullptr);
+    }
 
     if (m_isCurrentTab) {
         m_isCurrentTab = false;
@@ -357,8 +366,10 @@ void WebTab::attach(BrowserWindow* window)
     m_window = window;
     m_tabBar = m_window->tabWidget()->tabBar();
 
-    m_webView->setBrowserWindow(m_window);
-    m_locationBar->setBrowserWindow(m_window);
+    if (m_webView) {
+        m_webView->setBrowserWindow(m_window);
+        m_locationBar->setBrowserWindow(m_window);
+    }
     m_tabBar->setTabText(tabIndex(), title());
     m_tabBar->setTabButton(tabIndex(), m_tabBar->iconButtonPosition(), m_tabIcon);
     QTimer::singleShot(0, m_tabIcon, &TabIcon::updateIcon);
@@ -367,6 +378,7 @@ void WebTab::attach(BrowserWindow* window)
         const bool wasCurrent = m_isCurrentTab;
         m_isCurrentTab = index == tabIndex();
         if (wasCurrent != m_isCurrentTab) {
+            m_lastActivated = QDateTime::currentDateTimeUtc();
             emit currentTabChanged(m_isCurrentTab);
         }
     };
@@ -377,7 +389,7 @@ void WebTab::attach(BrowserWindow* window)
 
 QByteArray WebTab::historyData() const
 {
-    if (isRestored()) {
+    if (isRestored() && m_webView) {
         QByteArray historyArray;
         QDataStream historyStream(&historyArray, QIODevice::WriteOnly);
         historyStream << *m_webView->history();
@@ -390,12 +402,16 @@ QByteArray WebTab::historyData() const
 
 void WebTab::stop()
 {
-    m_webView->stop();
+    if (m_webView) {
+        m_webView->stop();
+    }
 }
 
 void WebTab::reload()
 {
-    m_webView->reload();
+    if (m_webView) {
+        m_webView->reload();
+    }
 }
 
 void WebTab::load(const LoadRequest &request)
@@ -404,7 +420,7 @@ void WebTab::load(const LoadRequest &request)
         tabActivated();
         QTimer::singleShot(0, this, std::bind(&WebTab::load, this, request));
     } else {
-        m_webView->load(request);
+        webView()->load(request);
     }
 }
 
@@ -412,13 +428,23 @@ void WebTab::unload()
 {
     m_savedTab = SavedTab(this);
     emit restoredChanged(isRestored());
-    m_webView->setPage(new WebPage);
-    m_webView->setFocus();
+
+    if (!m_webView) {
+        return;
+    }
+
+    // Current tab needs a view to show, background tabs become placeholders again
+    if (m_isCurrentTab) {
+        m_webView->setPage(new WebPage);
+        m_webView->setFocus();
+    } else {
+        destroyWebView();
+    }
 }
 
 bool WebTab::isLoading() const
 {
-    return m_webView->isLoading();
+    return m_webView && m_webView->isLoading();
 }
 
 bool WebTab::isPinned() const
@@ -442,17 +468,17 @@ void WebTab::setPinned(bool state)
 
 bool WebTab::isMuted() const
 {
-    return m_webView->page()->isAudioMuted();
+    return m_webView && m_webView->page()->isAudioMuted();
 }
 
 bool WebTab::isPlaying() const
 {
-    return m_webView->page()->recentlyAudible();
+    return m_webView && m_webView->page()->recentlyAudible();
 }
 
 void WebTab::setMuted(bool muted)
 {
-    m_webView->page()->setAudioMuted(muted);
+    webView()->page()->setAudioMuted(muted);
 }
 
 void WebTab::toggleMuted()
@@ -463,11 +489,14 @@ void WebTab::toggleMuted()
 
 bool WebTab::backgroundActivity() const
 {
-    return m_webView->backgroundActivity();
+    return m_webView && m_webView->backgroundActivity();
 }
 
 LocationBar* WebTab::locationBar() const
 {
+    if (!m_locationBar) {
+        const_cast<WebTab*>(this)->createWebView();
+    }
     return m_locationBar;
 }
 
@@ -573,7 +602,9 @@ void WebTab::restoreTab(const WebTab::SavedTab &tab)
         int index = tabIndex();
 
         m_tabBar->setTabText(index, tab.title);
-        m_locationBar->showUrl(tab.url);
+        if (m_locationBar) {
+            m_locationBar->showUrl(tab.url);
+        }
         m_tabIcon->updateIcon();
     }
     else {
@@ -587,7 +618,7 @@ void WebTab::restoreTab(const WebTab::SavedTab &tab)
 
 void WebTab::p_restoreTab(const QUrl &url, const QByteArray &history, int zoomLevel)
 {
-    m_webView->load(url);
+    webView()->load(url);
 
     // Restoring history of internal pages crashes QtWebEngine 5.8
     static const QStringList blacklistedSchemes = {
@@ -667,6 +698,75 @@ void WebTab::setAddChildBehavior(AddChildBehavior behavior)
     s_addChildBehavior = behavior;
 }
 
+void WebTab::createWebView()
+{
+    Q_ASSERT(!m_webView);
+
+    m_webView = new TabbedWebView(this);
+    m_webView->setPage(new WebPage);
+    m_webView->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
+    setFocusProxy(m_webView);
+    m_layout->insertWidget(0, m_webView);
+
+    m_locationBar = new LocationBar(this);
+    m_locationBar->setWebView(m_webView);
+
+    if (m_window) {
+        m_webView->setBrowserWindow(m_window);
+        m_locationBar->setBrowserWindow(m_window);
+    }
+
+    if (!isRestored()) {
+        m_locationBar->showUrl(m_savedTab.url);
+    }
+
+    connect(m_webView, &WebView::showNotification, this, &WebTab::showNotification);
+    connect(m_webView, &QWebEngineView::loadFinished, this, &WebTab::loadFinished);
+    connect(m_webView, &TabbedWebView::titleChanged, this, &WebTab::titleWasChanged);
+    connect(m_webView, &TabbedWebView::titleChanged, this, &WebTab::titleChanged);
+    connect(m_webView, &TabbedWebView::iconChanged, this, &WebTab::iconChanged);
+    connect(m_webView, &TabbedWebView::backgroundActivityChanged, this, &WebTab::backgroundActivityChanged);
+    connect(m_webView, &TabbedWebView::loadStarted, this, std::bind(&WebTab::loadingChanged, this, true));
+    connect(m_webView, &TabbedWebView::loadFinished, this, std::bind(&WebTab::loadingChanged, this, false));
+
+    auto pageChanged = [this](WebPage *page) {
+        connect(page, &WebPage::audioMutedChanged, this, &WebTab::playingChanged);
+        connect(page, &WebPage::recentlyAudibleChanged, this, &WebTab::mutedChanged);
+    };
+    pageChanged(m_webView->page());
+    connect(m_webView, &TabbedWebView::pageChanged, this, pageChanged);
+
+    emit webViewCreated();
+}
+
+void WebTab::destroyWebView()
+{
+    if (haveInspector()) {
+        delete m_splitter->widget(1);
+    }
+
+    // Search toolbar holds pointer to the view
+    while (m_layout->count() > 1) {
+        delete m_layout->itemAt(1)->widget();
+    }
+
+    // Let tab icon and listeners know the page is gone
+    WebPage *page = m_webView->page();
+    if (page->isLoading()) {
+        emit page->loadProgress(100);
+        emit page->loadFinished(true);
+    }
+    if (page->recentlyAudible()) {
+        emit page->recentlyAudibleChanged(false);
+    }
+
+    setFocusProxy(nullptr);
+    delete m_locationBar;
+    m_locationBar = nullptr;
+    delete m_webView;
+    m_webView = nullptr;
+}
+
 void WebTab::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
@@ -696,6 +796,11 @@ bool WebTab::isCurrentTab() const
     return m_isCurrentTab;
 }
 
+QDateTime WebTab::lastActivated() const
+{
+    return m_isCurrentTab ? QDateTime::currentDateTimeUtc() : m_lastActivated;
+}
+
 void WebTab::makeCurrentTab()
 {
     if (m_tabBar) {
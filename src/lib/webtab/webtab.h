@@ -21,6 +21,7 @@
 #include <QWidget>
 #include <QIcon>
 #include <QUrl>
+#include <QDateTime>
 
 #include "qzcommon.h"
 
@@ -44,6 +45,8 @@ public:
         QString title;
         QUrl url;
         QIcon icon;
+        // Icon is loaded from icon database on restore and not saved with tab
+        bool iconInDatabase;
         QByteArray history;
         bool isPinned;
         int zoomLevel;
@@ -69,8 +72,11 @@ public:
     explicit WebTab(QWidget *parent = nullptr);
 
     BrowserWindow *browserWindow() const;
+    // WebView and LocationBar are created on first access,
+    // unrestored tabs are only placeholders until then
     TabbedWebView* webView() const;
     LocationBar* locationBar() const;
+    bool hasWebView() const;
     TabIcon* tabIcon() const;
 
     WebTab *parentTab() const;
@@ -113,6 +119,8 @@ public:
     int tabIndex() const;
 
     bool isCurrentTab() const;
+    // Time the tab was last current, creation time for never activated tabs
+    QDateTime lastActivated() const;
     void makeCurrentTab();
     void closeTab();
     void moveTab(int to);
@@ -150,18 +158,21 @@ Q_SIGNALS:
     void parentTabChanged(WebTab *tab);
     void childTabAdded(WebTab *tab, int index);
     void childTabRemoved(WebTab *tab, int index);
+    void webViewCreated();
 
 private:
     void titleWasChanged(const QString &title);
     void resizeEvent(QResizeEvent *event) override;
     void removeFromTabTree();
+    void createWebView();
+    void destroyWebView();
 
     QVBoxLayout* m_layout;
     QSplitter* m_splitter;
 
-    TabbedWebView* m_webView;
+    TabbedWebView* m_webView = nullptr;
     WebInspector* m_inspector;
-    LocationBar* m_locationBar;
+    LocationBar* m_locationBar = nullptr;
     TabIcon* m_tabIcon;
     QWidget *m_notificationWidget;
     BrowserWindow* m_window = nullptr;
@@ -174,6 +185,7 @@ private:
     SavedTab m_savedTab;
     bool m_isPinned = false;
     bool m_isCurrentTab = false;
+    QDateTime m_lastActivated;
 };
 
 #endif // WEBTAB_H
@@ -644,7 +644,7 @@ QTreeWidgetItem* TabManagerWidget::groupByDomainName(bool useHostName)
 
         for (int tab = 0; tab < tabs.count(); ++tab) {
             WebTab* webTab = tabs.at(tab);
-            if (webTab->webView() && m_webPage == webTab->webView()->page()) {
+            if (webTab->hasWebView() && m_webPage == webTab->webView()->page()) {
                 m_webPage = 0;
                 continue;
             }
@@ -710,7 +710,7 @@ QTreeWidgetItem* TabManagerWidget::groupByWindow()
 
         for (int tab = 0; tab < tabs.count(); ++tab) {
             WebTab* webTab = tabs.at(tab);
-            if (webTab->webView() && m_webPage == webTab->webView()->page()) {
+            if (webTab->hasWebView() && m_webPage == webTab->webView()->page()) {
                 m_webPage = 0;
                 continue;
             }
@@ -793,16 +793,12 @@ void TabItem::setWebTab(WebTab* webTab)
     else
         setIsSavedTab(true);
 
-    connect(m_webTab->webView(), &QWebEngineView::titleChanged, this, &TabItem::setTitle);
-    connect(m_webTab->webView(), &QWebEngineView::iconChanged, this, &TabItem::updateIcon);
-
-    auto pageChanged = [this](WebPage *page) {
-        connect(page, &WebPage::audioMutedChanged, this, &TabItem::updateIcon);
-        connect(page, &WebPage::loadFinished, this, &TabItem::updateIcon);
-        connect(page, &WebPage::loadStarted, this, &TabItem::updateIcon);
-    };
-    pageChanged(m_webTab->webView()->page());
-    connect(m_webTab->webView(), &WebView::pageChanged, this, pageChanged);
+    // WebTab signals don't require creating WebView of placeholder tabs
+    connect(m_webTab, &WebTab::titleChanged, this, &TabItem::setTitle);
+    connect(m_webTab, &WebTab::iconChanged, this, &TabItem::updateIcon);
+    connect(m_webTab, &WebTab::mutedChanged, this, &TabItem::updateIcon);
+    connect(m_webTab, &WebTab::playingChanged, this, &TabItem::updateIcon);
+    connect(m_webTab, &WebTab::loadingChanged, this, &TabItem::updateIcon);
 }
 
 void TabItem::updateIcon()
@@ -815,7 +811,7 @@ void TabItem::updateIcon()
             if (m_webTab->isMuted()) {
                 setIcon(0, QIcon::fromTheme(QSL("audio-volume-muted"), QIcon(QSL(":icons/other/audiomuted.svg"))));
             }
-            else if (!m_webTab->isMuted() && m_webTab->webView()->page()->recentlyAudible()) {
+            else if (!m_webTab->isMuted() && m_webTab->isPlaying()) {
                 setIcon(0, QIcon::fromTheme(QSL("audio-volume-high"), QIcon(QSL(":icons/other/audioplaying.svg"))));
             }
             else {
@@ -17,64 +17,58 @@
 * ============================================================ */
 #include "loadinganimator.h"
 
-#include "tabicon.h"
 #include "tabmodel.h"
+#include "tabloadinganimation.h"
 
-#include <QTimer>
+#include <QWidget>
 
-class LoadingAnimation : public QObject
-{
-public:
-    explicit LoadingAnimation(LoadingAnimator *animator)
-        : QObject(animator)
-        , m_animator(animator)
-    {
-        QTimer *timer = new QTimer(this);
-        timer->setInterval(TabIcon::data()->animationInterval);
-        connect(timer, &QTimer::timeout, this, [this]() {
-            m_currentFrame = (m_currentFrame + 1) % TabIcon::data()->framesCount;
-            m_animator->updatePixmap(this);
-        });
-        timer->start();
-    }
-
-    QPixmap pixmap() const
-    {
-        const QPixmap p = TabIcon::data()->animationPixmap;
-        const int size = 16;
-        const int pixmapSize = qRound(size * p.devicePixelRatioF());
-        return p.copy(m_currentFrame * pixmapSize, 0, pixmapSize, pixmapSize);
-    }
-
-private:
-    int m_currentFrame = 0;
-    LoadingAnimator *m_animator;
-};
-
-LoadingAnimator::LoadingAnimator(QObject *parent)
+LoadingAnimator::LoadingAnimator(QWidget *view, QObject *parent)
     : QObject(parent)
+    , m_view(view)
 {
 }
 
 QPixmap LoadingAnimator::pixmap(const QModelIndex &index)
 {
-    LoadingAnimation *animation = m_animations.value(index);
-    if (!animation) {
-        animation = new LoadingAnimation(this);
-        m_indexes[animation] = index;
-        m_animations[index] = animation;
+    TabLoadingAnimation *animation = TabLoadingAnimation::instance();
+
+    if (m_indexes.isEmpty()) {
+        connect(animation, &TabLoadingAnimation::frameChanged, this, &LoadingAnimator::updateIndexes);
+        animation->addClient(this);
     }
-    return animation->pixmap();
+    m_indexes.insert(index);
+
+    return animation->currentPixmap();
 }
 
-void LoadingAnimator::updatePixmap(LoadingAnimation *animation)
+void LoadingAnimator::updateIndexes()
 {
-    const QModelIndex index = m_indexes.value(animation);
-    if (!index.isValid() || !index.data(TabModel::LoadingRole).toBool()) {
-        animation->deleteLater();
-        m_indexes.remove(animation);
-        m_animations.remove(index);
-    } else {
-        emit updateIndex(index);
+    // Indexes are registered again once the view gets painted
+    if (!TabLoadingAnimation::isWidgetVisible(m_view)) {
+        stop();
+        return;
     }
+
+    auto it = m_indexes.begin();
+    while (it != m_indexes.end()) {
+        const QModelIndex index = *it;
+        if (!index.isValid() || !index.data(TabModel::LoadingRole).toBool()) {
+            it = m_indexes.erase(it);
+        } else {
+            emit updateIndex(index);
+            ++it;
+        }
+    }
+
+    if (m_indexes.isEmpty()) {
+        stop();
+    }
+}
+
+void LoadingAnimator::stop()
+{
+    TabLoadingAnimation *animation = TabLoadingAnimation::instance();
+    disconnect(animation, &TabLoadingAnimation::frameChanged, this, &LoadingAnimator::updateIndexes);
+    animation->removeClient(this);
+    m_indexes.clear();
 }
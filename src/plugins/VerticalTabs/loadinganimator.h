@@ -17,18 +17,18 @@
 * ============================================================ */
 #pragma once
 
-#include <QHash>
+#include <QSet>
 #include <QObject>
 #include <QPersistentModelIndex>
 
-class LoadingAnimation;
+class QWidget;
 
 class LoadingAnimator : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit LoadingAnimator(QObject *parent = nullptr);
+    explicit LoadingAnimator(QWidget *view, QObject *parent = nullptr);
 
     QPixmap pixmap(const QModelIndex &index);
 
@@ -36,10 +36,9 @@ Q_SIGNALS:
     void updateIndex(const QModelIndex &index);
 
 private:
-    void updatePixmap(LoadingAnimation *animation);
+    void updateIndexes();
+    void stop();
 
-    QHash<LoadingAnimation*, QPersistentModelIndex> m_indexes;
-    QHash<QPersistentModelIndex, LoadingAnimation*> m_animations;
-
-    friend class LoadingAnimation;
+    QWidget *m_view;
+    QSet<QPersistentModelIndex> m_indexes;
 };
@@ -30,7 +30,7 @@ TabListDelegate::TabListDelegate(TabListView *view)
 {
     m_padding = qMax(5, m_view->style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1);
 
-    m_loadingAnimator = new LoadingAnimator(this);
+    m_loadingAnimator = new LoadingAnimator(m_view, this);
     connect(m_loadingAnimator, &LoadingAnimator::updateIndex, m_view, &TabListView::updateIndex);
 }
 
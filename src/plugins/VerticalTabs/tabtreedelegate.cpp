@@ -91,7 +91,7 @@ TabTreeDelegate::TabTreeDelegate(TabTreeView *view)
     m_padding = qMax(5, m_view->style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1);
     m_indentation = 15;
 
-    m_loadingAnimator = new LoadingAnimator(this);
+    m_loadingAnimator = new LoadingAnimator(m_view, this);
     connect(m_loadingAnimator, &LoadingAnimator::updateIndex, m_view, &TabTreeView::updateIndex);
 
     // Needed to make it stylable the same way as real tabbar close button
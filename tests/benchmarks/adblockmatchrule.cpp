@@ -1,6 +1,6 @@
 /* ============================================================
 * Falkon - Qt web browser
-* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+* Copyright (C) 2014-2019 David Rosca <nowrep@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -15,58 +15,172 @@
 * You should have received a copy of the GNU General Public License
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 * ============================================================ */
-#include "adblockrule.h"
+#include "adblockmatcher.h"
+#include "adblockrequest.h"
 #include "adblocksubscription.h"
+#include "qztools.h"
 
 #include <QtTest/QtTest>
-#include <QNetworkRequest>
+
+#include <algorithm>
+
+struct TraceEntry
+{
+    AdBlockRequest request;
+    QString urlString;
+    QString urlDomain;
+};
 
 class AdBlockMatchRule : public QObject
 {
     Q_OBJECT
 
-private slots:
+private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
 
-    void networkMatch();
+    void buildMatcher();
+    void matchTrace();
+    void matchTraceLatency();
 
 private:
-    AdBlockSubscription* m_subscription;
+    AdBlockSubscription* m_subscription = nullptr;
+    AdBlockMatcher* m_matcher = nullptr;
+    QVector<TraceEntry> m_trace;
 };
 
+// Returns resident memory of this process in kB, or -1 if unknown
+static qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file(QSL("/proc/self/status"));
+    if (!file.open(QFile::ReadOnly)) {
+        return -1;
+    }
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+#endif
+    return -1;
+}
+
+static QWebEngineUrlRequestInfo::ResourceType resourceType(const QString &name)
+{
+    static const QHash<QString, QWebEngineUrlRequestInfo::ResourceType> types = {
+        {QSL("mainframe"), QWebEngineUrlRequestInfo::ResourceTypeMainFrame},
+        {QSL("subframe"), QWebEngineUrlRequestInfo::ResourceTypeSubFrame},
+        {QSL("stylesheet"), QWebEngineUrlRequestInfo::ResourceTypeStylesheet},
+        {QSL("script"), QWebEngineUrlRequestInfo::ResourceTypeScript},
+        {QSL("image"), QWebEngineUrlRequestInfo::ResourceTypeImage},
+        {QSL("font"), QWebEngineUrlRequestInfo::ResourceTypeFontResource},
+        {QSL("media"), QWebEngineUrlRequestInfo::ResourceTypeMedia},
+        {QSL("xhr"), QWebEngineUrlRequestInfo::ResourceTypeXhr},
+        {QSL("ping"), QWebEngineUrlRequestInfo::ResourceTypePing}
+    };
+    return types.value(name, QWebEngineUrlRequestInfo::ResourceTypeSubResource);
+}
 
 void AdBlockMatchRule::initTestCase()
 {
-    m_subscription = new AdBlockSubscription("EasyList", this);
-    m_subscription->setFilePath("../files/easylist.txt");
+    // Trace of page loads: resource type, first party url and request url separated by tabs
+    const QStringList lines = QzTools::readAllFileContents(QSL(":/files/adblocktrace.txt")).split(QL1C('\n'), QString::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QStringList fields = line.split(QL1C('\t'));
+        if (line.startsWith(QL1C('#')) || fields.size() != 3) {
+            continue;
+        }
+        const QUrl url = QUrl::fromEncoded(fields.at(2).toUtf8());
+        // Same as AdBlockManager::block
+        m_trace.append({AdBlockRequest(url, QUrl::fromEncoded(fields.at(1).toUtf8()), resourceType(fields.at(0))),
+                        QString::fromUtf8(url.toEncoded().toLower()), url.host().toLower()});
+    }
+    QVERIFY(m_trace.size() > 1000);
+
+    const qint64 memoryBefore = residentMemory();
+
+    m_subscription = new AdBlockSubscription(QSL("EasyList"), this);
+    m_subscription->setFilePath(QSL(":/files/easylist.txt"));
     m_subscription->loadSubscription(QStringList());
+    QVERIFY(!m_subscription->allRules().isEmpty());
+
+    m_matcher = new AdBlockMatcher(nullptr);
+    m_matcher->update({m_subscription});
+
+    const qint64 memoryAfter = residentMemory();
+    if (memoryBefore >= 0 && memoryAfter >= 0) {
+        qDebug() << "resident memory of subscription and matcher:" << (memoryAfter - memoryBefore) / 1024 << "MB";
+    }
 }
 
 void AdBlockMatchRule::cleanupTestCase()
 {
+    delete m_matcher;
     delete m_subscription;
 }
 
-void AdBlockMatchRule::networkMatch()
+void AdBlockMatchRule::buildMatcher()
 {
-    QList<QUrl> urls;
-    urls << QUrl("https://www.kde.org");
-    urls << QUrl("https://developers.google.com/feed/v1/reference?csw=1");
-    urls << QUrl("http://pagead2.googlesyndication.com/pagead/show_ads.js");
-    urls << QUrl("https://qt.gitorious.org/qt-labs/qwebchannel/source/d48ca4efa70624c3178c0b97441ff7499aa2be36:src/webchannel/qwebchannel.cpp");
-    urls << QUrl("https://www.google.com/search?q=qmake+add+-Werror&ie=utf-8&oe=utf-8&aq=t&rls=org.mozilla:en-US:unofficial&client=iceweasel-a&channel=fflb#channel=fflb&q=gcc+-Werror&rls=org.mozilla:en-US:unofficial&start=10");
-    urls << QUrl("https://googleads.g.doubleclick.net/pagead/viewthroughconversion/977354488/?random=1397378259090&cv=7&fst=1397378259090&num=1&fmt=1&guid=ON&u_h=1080&u_w=1920&u_ah=1080&u_aw=1862&u_cd=24&u_his=3&u_tz=120&u_java=true&u_nplug=3&u_nmime=70&frm=2&url=https%3A//2507573.fls.doubleclick.net/activityi%3Bsrc%3D2507573%3Btype%3Dother026%3Bcat%3Dgoogl875%3Bord%3D8821468765381.725%3F&ref=https%3A//developers.google.com/feed/v1/reference%3Fcsw%3D1");
-    urls << QUrl("http://www.google-analytics.com/__utm.gif?utmwv=1.4&utmn=52554097&utmcs=ISO-8859-1&utmsr=1920x1080&utmsc=24-bit&utmul=cs-cz&utmje=1&utmfl=11.2 r202&utmdt=HTTP Authentication example&utmhn=www.pagetutor.com&utmhid=423185901&utmr=-&utmp=/keeper/http_authentication/index.html&utmac=UA-1399726-1&utmcc=__utma%3D30852926.644467994.1395073137.1395611798.1397378358.18%3B%2B__utmz%3D30852926.1395073137.1.1.utmccn%3D(direct)%7Cutmcsr%3D(direct)%7Cutmcmd%3D(none)%3B%2B");
+    AdBlockMatcher matcher(nullptr);
 
     QBENCHMARK {
-        foreach (const QUrl &url, urls) {
-            QNetworkRequest req(url);
-            const AdBlockRule* rule = m_subscription->match(req, url.host(), url.toEncoded());
-            if (rule)
-                rule = 0;
+        // Without previous rules the update is synchronous
+        matcher.clear();
+        matcher.update({m_subscription});
+    }
+}
+
+void AdBlockMatchRule::matchTrace()
+{
+    QString ruleFilter;
+    QString ruleSubscription;
+    int blocked = 0;
+
+    QBENCHMARK {
+        blocked = 0;
+        for (const TraceEntry &entry : qAsConst(m_trace)) {
+            if (m_matcher->match(entry.request, entry.urlDomain, entry.urlString, ruleFilter, ruleSubscription)) {
+                ++blocked;
+            }
+        }
+    }
+
+    qDebug() << "blocked" << blocked << "of" << m_trace.size() << "requests";
+}
+
+void AdBlockMatchRule::matchTraceLatency()
+{
+    const int rounds = 5;
+
+    QString ruleFilter;
+    QString ruleSubscription;
+    QVector<qint64> times;
+    times.reserve(m_trace.size() * rounds);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < rounds; ++i) {
+        for (const TraceEntry &entry : qAsConst(m_trace)) {
+            timer.start();
+            m_matcher->match(entry.request, entry.urlDomain, entry.urlString, ruleFilter, ruleSubscription);
+            times.append(timer.nsecsElapsed());
         }
     }
+
+    qint64 total = 0;
+    for (qint64 time : qAsConst(times)) {
+        total += time;
+    }
+    std::sort(times.begin(), times.end());
+
+    const qint64 mean = total / times.size();
+    qDebug() << "ns/request:" << mean
+             << "p50:" << times.at(times.size() / 2)
+             << "p99:" << times.at(times.size() * 99 / 100)
+             << "max:" << times.last();
+
+    QTest::setBenchmarkResult(mean, QTest::WalltimeNanoseconds);
 }
 
 QTEST_MAIN(AdBlockMatchRule)
@@ -17,6 +17,7 @@
 * ============================================================ */
 #include "adblockrule.h"
 #include "adblocksubscription.h"
+#include "qztools.h"
 
 #include <QtTest/QtTest>
 
@@ -25,17 +26,60 @@ class AdBlockParseRule : public QObject
     Q_OBJECT
 
 private Q_SLOTS:
+    void initTestCase();
+
+    void parseEasyList_data();
     void parseEasyList();
+
+private:
+    QTemporaryDir m_tempDir;
+    QString m_filePath;
 };
 
+void AdBlockParseRule::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+
+    // Cache is written next to the subscription file, so it needs to be writable
+    m_filePath = m_tempDir.filePath(QSL("easylist.txt"));
+    QVERIFY(QFile::copy(QSL(":/files/easylist.txt"), m_filePath));
+}
+
+void AdBlockParseRule::parseEasyList_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("cached") << true;
+}
 
-#include "qztools.h"
 void AdBlockParseRule::parseEasyList()
 {
+    QFETCH(bool, cached);
+
+    AdBlockSubscription subscription(QSL("EasyList"));
+    subscription.setFilePath(m_filePath);
+
+    const QString cacheFilePath = subscription.cacheFilePath();
+    QFile::remove(cacheFilePath);
+
+    if (cached) {
+        subscription.loadSubscription(QStringList());
+        QVERIFY(QFile::exists(cacheFilePath));
+    } else {
+        // Directory in place of cache can be neither read nor written,
+        // so only parsing is measured as before the cache existed
+        QVERIFY(QDir().mkpath(cacheFilePath));
+    }
+
     QBENCHMARK {
-        AdBlockSubscription* subscription = new AdBlockSubscription(QSL("EasyList"), this);
-        subscription->setFilePath(QSL(":/files/easylist.txt"));
-        subscription->loadSubscription(QStringList());
+        subscription.loadSubscription(QStringList());
+    }
+
+    QVERIFY(!subscription.allRules().isEmpty());
+
+    if (!cached) {
+        QVERIFY(QDir().rmdir(cacheFilePath));
     }
 }
 
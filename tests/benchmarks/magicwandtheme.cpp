@@ -0,0 +1,134 @@
+/* ============================================================
+* Falkon - Qt web browser
+* Copyright (C) 2019 David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "mainapplication.h"
+#include "qztools.h"
+#include "webpage.h"
+#include "webview.h"
+
+#include <QtTest/QtTest>
+#include <QtWebEngineWidgetsVersion>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+class BenchmarkWebView : public WebView
+{
+public:
+    QWidget *overlayWidget() override { return this; }
+    void closeView() override { }
+    void loadInNewTab(const LoadRequest &, Qz::NewTabPositionFlags) override { }
+    bool isFullScreen() override { return false; }
+    void requestFullScreen(bool) override { }
+};
+
+class MagicWandTheme : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void rendererCpu_data();
+    void rendererCpu();
+};
+
+// Returns user + system CPU time of process in ms, or -1 if unknown
+static qint64 processCpuTime(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    QFile file(QSL("/proc/%1/stat").arg(pid));
+    if (!file.open(QFile::ReadOnly)) {
+        return -1;
+    }
+    const QByteArray stat = file.readAll();
+    // Fields following the command name start with state (3rd field), utime and stime are 14th and 15th
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13) {
+        return -1;
+    }
+    return (fields.at(11).toLongLong() + fields.at(12).toLongLong()) * 1000 / sysconf(_SC_CLK_TCK);
+#else
+    Q_UNUSED(pid)
+    return -1;
+#endif
+}
+
+void MagicWandTheme::rendererCpu_data()
+{
+    QTest::addColumn<QUrl>("url");
+
+    QTest::newRow("static") << QUrl(QSL("qrc:/files/magicwand.html?rows=400"));
+    QTest::newRow("static-large") << QUrl(QSL("qrc:/files/magicwand.html?rows=4000"));
+    QTest::newRow("mutating") << QUrl(QSL("qrc:/files/magicwand.html?rows=400&mutate=1"));
+}
+
+void MagicWandTheme::rendererCpu()
+{
+    QFETCH(QUrl, url);
+
+    const int sampleTime = 5000;
+
+    BenchmarkWebView view;
+    WebPage *page = new WebPage;
+    view.setPage(page);
+    view.resize(1024, 768);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QSignalSpy loadFinishedSpy(page, &QWebEnginePage::loadFinished);
+    view.load(url);
+    QTRY_VERIFY(loadFinishedSpy.count() > 0);
+
+    // Let the initial pass finish
+    QTRY_VERIFY(page->execJavaScript(QSL("window._falkon_magicwand && window._falkon_magicwand.stats().pending == 0")).toBool());
+
+    qint64 pid = 0;
+#if QTWEBENGINEWIDGETS_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    pid = page->renderProcessPid();
+#endif
+    const QVariantMap before = page->execJavaScript(QSL("window._falkon_magicwand.stats()")).toMap();
+    const qint64 cpuBefore = processCpuTime(pid);
+
+    QTest::qWait(sampleTime);
+
+    const QVariantMap after = page->execJavaScript(QSL("window._falkon_magicwand.stats()")).toMap();
+    const qint64 cpuAfter = processCpuTime(pid);
+
+    const double busy = after.value(QSL("busy")).toDouble() - before.value(QSL("busy")).toDouble();
+    qDebug() << "initial pass:" << before.value(QSL("busy")).toDouble() << "ms,"
+             << before.value(QSL("elements")).toInt() << "elements";
+    qDebug() << "steady state:" << busy << "ms theming per" << sampleTime << "ms,"
+             << after.value(QSL("passes")).toInt() - before.value(QSL("passes")).toInt() << "passes";
+
+    if (cpuBefore >= 0 && cpuAfter >= 0) {
+        qDebug() << "renderer cpu:" << cpuAfter - cpuBefore << "ms per" << sampleTime << "ms";
+        QTest::setBenchmarkResult(cpuAfter - cpuBefore, QTest::WalltimeMilliseconds);
+    } else {
+        QTest::setBenchmarkResult(busy, QTest::WalltimeMilliseconds);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    QzTools::removeRecursively(QDir::tempPath() + QSL("/Falkon-test"));
+    MainApplication::setTestModeEnabled(true);
+    MainApplication app(argc, argv);
+    MagicWandTheme test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "magicwandtheme.moc"